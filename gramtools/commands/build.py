@@ -57,6 +57,11 @@ def parse_args(common_parser, subparsers):
                         action='store_true',
                         required=False)
 
+    parser.add_argument('--strand-symmetric',
+                        help='',
+                        action='store_true',
+                        required=False)
+
     parser.add_argument('--max-threads',
                         help='',
                         type=int,
@@ -144,6 +149,9 @@ def _execute_gramtools_cpp_build(build_paths, report, args):
     if args.all_kmers:
         command.append('--all-kmers')
 
+    if args.strand_symmetric:
+        command.append('--strand-symmetric')
+
     if args.debug:
         command += ['--debug']
     command_str = ' '.join(command)
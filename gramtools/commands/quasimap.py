@@ -1,6 +1,7 @@
 import os
 import time
 import json
+import socket
 import logging
 import subprocess
 import collections
@@ -40,6 +41,60 @@ def parse_args(common_parser, subparsers):
                         default=1,
                         required=False)
 
+    parser.add_argument('--seed',
+                        help='seed for choosing between multiple mappings',
+                        type=int,
+                        default=0,
+                        required=False)
+
+    parser.add_argument('--max-search-states',
+                        help='abandon reads with more live search states (0: no limit)',
+                        type=int,
+                        default=0,
+                        required=False)
+    parser.add_argument('--max-sa-interval-width',
+                        help='abandon reads ending with a wider SA interval (0: no limit)',
+                        type=int,
+                        default=0,
+                        required=False)
+    parser.add_argument('--max-marker-crossings',
+                        help='abandon reads crossing more variant site markers (0: no limit)',
+                        type=int,
+                        default=0,
+                        required=False)
+    parser.add_argument('--read-cache-size',
+                        help='number of distinct reads whose search results are cached (0: no cache)',
+                        type=int,
+                        default=0,
+                        required=False)
+    parser.add_argument('--max-extended-seeds',
+                        help='number of read suffixes longer than a kmer whose search states are cached (0: no cache)',
+                        type=int,
+                        default=0,
+                        required=False)
+    parser.add_argument('--persist-extended-seeds',
+                        help='load cached read suffixes from the gram directory and store them back after mapping',
+                        action='store_true',
+                        required=False)
+    parser.add_argument('--sort-reads-batch',
+                        help='search reads sorted by suffix, sharing search steps between reads (bypasses the read caches)',
+                        action='store_true',
+                        required=False)
+    parser.add_argument('--numa',
+                        help='NUMA placement: none, interleave (spread index pages over nodes) or replicate (index copy per node)',
+                        choices=['none', 'interleave', 'replicate'],
+                        default='none',
+                        required=False)
+    parser.add_argument('--huge-pages',
+                        help='index huge pages: none, reserved (2 MB pages reserved by the system) or transparent',
+                        choices=['none', 'reserved', 'transparent'],
+                        default='none',
+                        required=False)
+    parser.add_argument('--server',
+                        help='socket of a running gram serve process holding the index, which maps the reads instead',
+                        type=str,
+                        required=False)
+
 
 def _execute_command(quasimap_paths, report, args):
     if report.get('return_value_is_0') is False:
@@ -48,6 +103,9 @@ def _execute_command(quasimap_paths, report, args):
         }
         return report
 
+    if args.server is not None:
+        return _execute_server_job(quasimap_paths, report, args)
+
     command = [
         common.gramtools_exec_fpath,
         'quasimap',
@@ -56,8 +114,21 @@ def _execute_command(quasimap_paths, report, args):
         '--kmer-size', str(args.kmer_size),
         '--run-directory', quasimap_paths['quasimap_run_dirpath'],
         '--max-threads', str(args.max_threads),
+        '--seed', str(args.seed),
+        '--max-search-states', str(args.max_search_states),
+        '--max-sa-interval-width', str(args.max_sa_interval_width),
+        '--max-marker-crossings', str(args.max_marker_crossings),
+        '--read-cache-size', str(args.read_cache_size),
+        '--max-extended-seeds', str(args.max_extended_seeds),
+        '--numa', args.numa,
+        '--huge-pages', args.huge_pages,
     ]
 
+    if args.persist_extended_seeds:
+        command.append('--persist-extended-seeds')
+    if args.sort_reads_batch:
+        command.append('--sort-reads-batch')
+
     command_str = ' '.join(command)
     log.debug('Executing command:\n\n%s\n', command_str)
 
@@ -81,6 +152,35 @@ def _execute_command(quasimap_paths, report, args):
     return report
 
 
+def _execute_server_job(quasimap_paths, report, args):
+    # search options are those the server was started with
+    fields = ['quasimap', quasimap_paths['quasimap_run_dirpath']] + quasimap_paths['reads']
+    request = '\t'.join(fields) + '\n'
+    log.debug('Sending server request:\n\n%s\n', request)
+
+    reply = b''
+    with socket.socket(socket.AF_UNIX, socket.SOCK_STREAM) as server_socket:
+        server_socket.connect(args.server)
+        server_socket.sendall(request.encode())
+        while True:
+            chunk = server_socket.recv(4096)
+            if not chunk:
+                break
+            reply += chunk
+
+    entire_stdout = reply.decode().splitlines()
+    command_result = bool(entire_stdout) and entire_stdout[-1] == 'ok'
+    log.info('Output run directory:\n%s', quasimap_paths['quasimap_run_dirpath'])
+
+    report['return_value_is_0'] = command_result
+    report['gramtools_cpp_quasimap'] = collections.OrderedDict([
+        ('server', args.server),
+        ('return_value_is_0', command_result),
+        ('stdout', entire_stdout),
+    ])
+    return report
+
+
 def _save_report(start_time,
                  reports,
                  command_paths,
@@ -0,0 +1,56 @@
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+
+#ifndef GRAMTOOLS_HUGE_PAGES_HPP
+#define GRAMTOOLS_HUGE_PAGES_HPP
+
+namespace gram {
+
+    namespace huge_pages {
+        constexpr uint64_t huge_page_size = uint64_t(2) << 20;
+
+        // backs later sdsl allocations (FM-index wavelet tree, bit vectors and their rank/select
+        // supports) with the system's free reserved 2 MB pages; false when none can be mapped
+        bool use_reserved_pages();
+
+        // [start, end) address ranges
+        using MemoryRange = std::pair<uint64_t, uint64_t>;
+        using MemoryRanges = std::vector<MemoryRange>;
+
+        // private anonymous read-write mappings, in address order
+        MemoryRanges anonymous_mappings();
+
+        // advises transparent huge pages over anonymous memory mapped since mappings_before
+        // was taken, so only what was allocated in between (the index) is advised; thread
+        // stacks are left out. Returns the bytes advised
+        uint64_t advise_transparent_pages(const MemoryRanges &mappings_before);
+
+        // the parts of range outside all of the (address ordered) ranges
+        MemoryRanges subtract_ranges(const MemoryRange &range, const MemoryRanges &ranges);
+    }
+
+    // counts the calling thread's data TLB load misses from construction on,
+    // unavailable where perf events are not permitted
+    class TlbMissCounter {
+    public:
+        TlbMissCounter();
+
+        ~TlbMissCounter();
+
+        TlbMissCounter(const TlbMissCounter &) = delete;
+
+        TlbMissCounter &operator=(const TlbMissCounter &) = delete;
+
+        bool available() const { return fd >= 0; }
+
+        uint64_t count_misses() const;
+
+    private:
+        int fd = -1;
+    };
+
+}
+
+#endif //GRAMTOOLS_HUGE_PAGES_HPP
@@ -0,0 +1,54 @@
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+
+#ifndef GRAMTOOLS_NUMA_HPP
+#define GRAMTOOLS_NUMA_HPP
+
+namespace gram {
+
+    namespace numa {
+        using CPUs = std::vector<uint64_t>;
+
+        // CPUs of each NUMA node with CPUs, from sysfs; empty when the topology is unknown
+        std::vector<CPUs> node_cpus();
+
+        std::vector<uint64_t> node_ids();
+
+        // a sysfs CPU list, such as "0-3,8,10-11"
+        CPUs parse_cpu_list(const std::string &cpu_list);
+
+        // both return false where not supported, leaving placement to the kernel
+        bool pin_thread(const CPUs &cpus);
+
+        // CPUs the calling thread may run on, empty where not supported
+        CPUs thread_cpus();
+
+        // runs task(node) for each node from first_node on, each on a new thread pinned to the
+        // node's CPUs; the calling thread's affinity is left as it was
+        void run_on_nodes(const std::vector<CPUs> &nodes_cpus,
+                          const uint64_t &first_node,
+                          const std::function<void(const uint64_t &)> &task);
+
+        // set_mempolicy is per thread: only the calling thread allocates interleaved,
+        // threads it creates afterwards inherit its policy
+        bool interleave_allocations(const std::vector<uint64_t> &node_ids);
+
+        void default_allocations();
+
+        struct MemoryPolicy {
+            int mode = 0;
+            std::vector<unsigned long> nodes_mask;
+        };
+
+        // the calling thread's memory policy, to carry it over to already running threads
+        MemoryPolicy current_policy();
+
+        bool apply_policy(const MemoryPolicy &memory_policy);
+    }
+
+}
+
+#endif //GRAMTOOLS_NUMA_HPP
@@ -9,7 +9,8 @@ namespace gram {
 
     enum class Commands {
         build,
-        quasimap
+        quasimap,
+        serve
     };
 
     struct Parameters {
@@ -19,6 +20,11 @@ namespace gram {
         std::string fm_index_fpath;
         std::string sites_mask_fpath;
         std::string allele_mask_fpath;
+        std::string site_table_fpath;
+        std::string sa_allele_runs_fpath;
+        std::string bwt_markers_fpath;
+        std::string kmer_presence_fpath;
+        std::string invariant_reach_fpath;
         std::string sdsl_memory_log_fpath;
 
         // kmer index file paths
@@ -27,10 +33,12 @@ namespace gram {
         std::string kmers_stats_fpath;
         std::string sa_intervals_fpath;
         std::string paths_fpath;
+        std::string extended_seeds_fpath;
 
         uint32_t kmers_size;
         uint32_t max_read_size;
         bool all_kmers_flag;
+        bool strand_symmetric_flag;
 
         // quasimap specific parameters
         std::vector<std::string> reads_fpaths;
@@ -40,6 +48,35 @@ namespace gram {
         std::string grouped_allele_counts_fpath;
 
         uint32_t maximum_threads;
+        uint64_t seed;
+
+        // per read search budget, zero means unlimited
+        uint64_t max_search_states;
+        uint64_t max_sa_interval_width;
+        uint64_t max_marker_crossings;
+
+        // number of distinct reads whose search states are cached, zero disables the cache
+        uint64_t read_cache_size;
+
+        // search states cached for frequent read suffixes beyond hot kmers, zero disables the cache
+        uint64_t max_extended_seeds;
+        bool persist_extended_seeds;
+
+        // search each reads batch in read suffix order, sharing search steps between reads
+        bool sort_reads_batch;
+
+        // "none", "interleave" (index pages spread over NUMA nodes) or "replicate" (an index
+        // copy per node); read search threads are pinned to nodes unless "none"
+        std::string numa_mode;
+
+        // "none", "reserved" (sdsl structures in reserved 2 MB pages) or "transparent"
+        // (transparent huge pages advised over the loaded index)
+        std::string huge_pages_mode;
+
+        // serve: quasimap jobs are accepted on this Unix domain socket, at most
+        // max_jobs at once, each with its share of maximum_threads
+        std::string socket_fpath;
+        uint32_t max_jobs;
     };
 
 }
@@ -0,0 +1,54 @@
+#include <cstdint>
+
+
+#ifndef GRAMTOOLS_RANDOM_HPP
+#define GRAMTOOLS_RANDOM_HPP
+
+namespace gram {
+
+    // SplitMix64: one word of state, so a generator per read costs nothing to seed
+    class SplitMix64 {
+    public:
+        explicit SplitMix64(const uint64_t &seed) : state(seed) {}
+
+        uint64_t operator()() {
+            state += golden_gamma;
+            return mix(state);
+        }
+
+        static uint64_t mix(uint64_t z) {
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EB;
+            return z ^ (z >> 31);
+        }
+
+        static constexpr uint64_t golden_gamma = 0x9E3779B97F4A7C15;
+
+    private:
+        uint64_t state;
+    };
+
+    // the read index-th output of the run seed's stream, whichever thread maps the read
+    inline uint64_t read_random_seed(const uint64_t &run_seed, const uint64_t &read_index) {
+        return SplitMix64::mix(run_seed + (read_index + 1) * SplitMix64::golden_gamma);
+    }
+
+    // unbiased uniform integer in [min, max], Lemire's multiply and reject
+    inline uint64_t uniform_int_inclusive(SplitMix64 &generator,
+                                          const uint64_t &min,
+                                          const uint64_t &max) {
+        uint64_t range = max - min + 1;
+        if (range == 0)
+            return generator();
+
+        uint64_t threshold = -range % range;
+        while (true) {
+            auto product = (unsigned __int128) generator() * range;
+            if ((uint64_t) product >= threshold)
+                return min + (uint64_t) (product >> 64);
+        }
+    }
+
+}
+
+#endif //GRAMTOOLS_RANDOM_HPP
@@ -36,8 +36,14 @@ namespace gram {
     using Pattern = std::vector<Base>;
     using Patterns = std::vector<Pattern>;
 
+    // variant site markers and allele IDs are 32 bit unless built with GRAMTOOLS_WIDE_VARIANT_IDS
+#ifdef GRAMTOOLS_WIDE_VARIANT_IDS
     using Marker = uint64_t;
     using AlleleId = uint64_t;
+#else
+    using Marker = uint32_t;
+    using AlleleId = uint32_t;
+#endif
 
     using VariantSite = std::pair<Marker, AlleleId>;
     using VariantSitePath = std::list<VariantSite>;
@@ -28,6 +28,9 @@ namespace gram {
         };
     };
 
+    // the kmer index is keyed on packed kmers
+    void exit_if_kmer_size_unpackable(const uint32_t &kmers_size);
+
     KmerIndex index_kmers(const Patterns &kmers, const int kmer_size, const PRG_Info &prg_info);
 
     namespace kmer_index {
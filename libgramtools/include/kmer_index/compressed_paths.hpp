@@ -0,0 +1,45 @@
+#include <sdsl/bit_vectors.hpp>
+#include <sdsl/vectors.hpp>
+
+#include "common/utils.hpp"
+
+
+#ifndef GRAMTOOLS_KMER_INDEX_COMPRESSED_PATHS_HPP
+#define GRAMTOOLS_KMER_INDEX_COMPRESSED_PATHS_HPP
+
+namespace gram {
+
+    // distinct kmer path lists, each stored once and referred to by kmers through a path list ID:
+    // markers are delta encoded from each list's first marker, allele IDs are bit compressed,
+    // and each list's first path element is found with an Elias-Fano (sd_vector) select;
+    // lists are shared on disk only, each loaded kmer's search states own their paths
+    struct CompressedPaths {
+        sdsl::int_vector<> kmer_path_list_ids;
+        sdsl::sd_vector<> path_list_starts;
+        sdsl::int_vector<> first_markers;
+        sdsl::int_vector<> marker_deltas;
+        sdsl::int_vector<> allele_ids;
+
+        uint64_t serialize(std::ostream &out,
+                           sdsl::structure_tree_node *v = nullptr,
+                           std::string name = "") const;
+
+        void load(std::istream &in);
+    };
+
+    CompressedPaths compress_paths(const sdsl::int_vector<> &paths,
+                                   const std::vector<uint64_t> &kmer_paths_offsets);
+
+    uint64_t count_compressed_kmers(const CompressedPaths &compressed_paths);
+
+    uint64_t count_distinct_path_lists(const CompressedPaths &compressed_paths);
+
+    std::pair<uint64_t, uint64_t> kmer_path_elements_range(const uint64_t &kmer_number,
+                                                           const CompressedPaths &compressed_paths);
+
+    std::vector<VariantSite> decompress_kmer_paths(const uint64_t &kmer_number,
+                                                   const CompressedPaths &compressed_paths);
+
+}
+
+#endif //GRAMTOOLS_KMER_INDEX_COMPRESSED_PATHS_HPP
@@ -1,4 +1,5 @@
 #include "kmer_index/build.hpp"
+#include "kmer_index/compressed_paths.hpp"
 
 
 #ifndef GRAMTOOLS_KMER_INDEX_DUMP_HPP
@@ -6,25 +7,30 @@
 
 namespace gram {
 
-    KmerIndexStats calculate_stats(const KmerIndex &kmer_index);
+    using KmerIndexEntry = KmerIndex::value_type;
+
+    // kmer index entries in serialization order, with each entry's prefix sum offset
+    // into the stats, SA intervals and paths arrays (plus a trailing total size element)
+    struct KmerIndexLayout {
+        std::vector<const KmerIndexEntry *> entries;
+        std::vector<uint64_t> stats_offsets;
+        std::vector<uint64_t> sa_intervals_offsets;
+        std::vector<uint64_t> paths_offsets;
+    };
 
-    sdsl::int_vector<3> dump_kmers(const KmerIndex &kmer_index,
-                                   const Parameters &parameters);
+    struct SerializedKmerIndex {
+        sdsl::int_vector<3> kmers;
+        sdsl::int_vector<> kmers_stats;
+        sdsl::int_vector<> sa_intervals;
+        CompressedPaths paths;
+    };
 
-    void dump_kmers_stats(const KmerIndexStats &stats,
-                          const sdsl::int_vector<3> &all_kmers,
-                          const KmerIndex &kmer_index,
-                          const Parameters &parameters);
+    KmerIndexStats calculate_stats(const KmerIndex &kmer_index);
 
-    void dump_sa_intervals(const KmerIndexStats &stats,
-                           const sdsl::int_vector<3> &all_kmers,
-                           const KmerIndex &kmer_index,
-                           const Parameters &parameters);
+    KmerIndexLayout calculate_layout(const KmerIndex &kmer_index);
 
-    void dump_paths(const KmerIndexStats &stats,
-                    const sdsl::int_vector<3> &all_kmers,
-                    const KmerIndex &kmer_index,
-                    const Parameters &parameters);
+    SerializedKmerIndex serialize_kmer_index(const KmerIndex &kmer_index,
+                                             const Parameters &parameters);
 
     namespace kmer_index {
         void dump(const KmerIndex &kmer_index, const Parameters &parameters);
@@ -0,0 +1,110 @@
+#include <mutex>
+#include <vector>
+
+#include <sdsl/int_vector.hpp>
+
+#include "common/utils.hpp"
+#include "common/parameters.hpp"
+#include "prg/prg.hpp"
+#include "search/search_types.hpp"
+
+
+#ifndef GRAMTOOLS_EXTENDED_SEED_CACHE_HPP
+#define GRAMTOOLS_EXTENDED_SEED_CACHE_HPP
+
+namespace gram {
+
+    // search states of a read suffix longer than a kmer, with the budget relevant
+    // figures of the states seen before each of the suffix's bases beyond the kmer
+    struct ExtendedSeed {
+        SearchStates search_states = {};
+        uint64_t marker_crossings = 0;
+        uint64_t max_count_search_states = 0;
+    };
+
+    struct ExtendedSeedLookup {
+        bool kmer_hot = false;
+        uint64_t count_extension_bases = 0;
+    };
+
+    // second level seed index, populated online: once a kmer has been looked up often
+    // enough, its most frequent read suffixes of kmer size plus a multiple of
+    // extension_step bases get their search states cached
+    class ExtendedSeedCache {
+    public:
+        explicit ExtendedSeedCache(const uint64_t &max_count_seeds);
+
+        bool enabled() const { return max_shard_count_seeds != 0; }
+
+        ExtendedSeedLookup lookup(const Pattern &read,
+                                  const uint64_t &kmer_size,
+                                  ExtendedSeed &extended_seed);
+
+        void record(const Pattern &read,
+                    const uint64_t &kmer_size,
+                    const uint64_t &count_extension_bases,
+                    const ExtendedSeed &extended_seed);
+
+        uint64_t count_seeds();
+
+        sdsl::int_vector<> serialize(const uint64_t &kmer_size,
+                                     const uint64_t &prg_size,
+                                     const uint64_t &prg_checksum);
+
+        // stops at the first truncated record, keeping the seeds before it
+        void deserialize(const sdsl::int_vector<> &serialized,
+                         const uint64_t &kmer_size,
+                         const uint64_t &prg_size,
+                         const uint64_t &prg_checksum);
+
+        static constexpr uint64_t extension_step = 4;
+        static constexpr uint64_t max_extension_bases = 16;
+        static constexpr uint64_t hot_kmer_min_count_lookups = 64;
+        static constexpr uint64_t seed_min_count_lookups = 8;
+
+    private:
+        struct HotKmer {
+            uint64_t count_lookups = 0;
+            uint64_t max_extension_bases = 0;
+        };
+
+        struct SeedEntry {
+            uint64_t count_lookups = 0;
+            bool cached = false;
+            ExtendedSeed extended_seed = {};
+        };
+
+        struct Shard {
+            std::mutex mutex;
+            SequenceHashMap<Pattern, HotKmer> kmers;
+            SequenceHashMap<Pattern, SeedEntry> seeds;
+            uint64_t count_cached_seeds = 0;
+        };
+
+        Shard &get_shard(const Pattern &kmer);
+
+        void cache_seed(Shard &shard,
+                        const Pattern &kmer,
+                        const Pattern &suffix,
+                        const ExtendedSeed &extended_seed);
+
+        static constexpr uint64_t count_shards = 64;
+        // lookup counters are bounded too, as a multiple of the cached seeds
+        static constexpr uint64_t counters_per_seed = 16;
+        uint64_t max_shard_count_seeds;
+        std::vector<Shard> shards;
+    };
+
+    namespace extended_seed_cache {
+        void dump(ExtendedSeedCache &seed_cache,
+                  const PRG_Info &prg_info,
+                  const Parameters &parameters);
+
+        void load(ExtendedSeedCache &seed_cache,
+                  const PRG_Info &prg_info,
+                  const Parameters &parameters);
+    }
+
+}
+
+#endif //GRAMTOOLS_EXTENDED_SEED_CACHE_HPP
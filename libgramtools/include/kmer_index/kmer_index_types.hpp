@@ -1,5 +1,6 @@
 #include "common/utils.hpp"
 #include "search/search_types.hpp"
+#include "kmer_index/packed_kmer.hpp"
 
 
 #ifndef GRAMTOOLS_KMER_INDEX_TYPES_HPP
@@ -12,7 +13,8 @@ namespace gram {
     };
     using KmerIndexCache = std::list<CacheElement>;
 
-    using KmerIndex = SequenceHashMap<Pattern, SearchStates>;
+    // kmers of at most max_packed_kmer_size bases, keyed by their packed form
+    using KmerIndex = std::unordered_map<PackedKmer, SearchStates, packed_kmer_hash>;
 }
 
 #endif //GRAMTOOLS_KMER_INDEX_TYPES_HPP
@@ -2,6 +2,7 @@
 #include "../common/parameters.hpp"
 
 #include "build.hpp"
+#include "compressed_paths.hpp"
 #include "kmer_index_types.hpp"
 
 
@@ -17,15 +18,32 @@ namespace gram {
     IndexedKmerStats deserialize_next_stats(const uint64_t &stats_index,
                                             const sdsl::int_vector<> &kmers_stats);
 
-    void parse_sa_intervals(KmerIndex &kmer_index,
-                            const sdsl::int_vector<3> &all_kmers,
-                            const sdsl::int_vector<> &kmers_stats,
-                            const Parameters &parameters);
-
-    void parse_paths(KmerIndex &kmer_index,
-                     const sdsl::int_vector<3> &all_kmers,
-                     const sdsl::int_vector<> &kmers_stats,
-                     const Parameters &parameters);
+    struct IndexedKmerOffsets {
+        uint64_t stats_index = 0;
+        uint64_t sa_intervals_index = 0;
+
+        bool operator==(const IndexedKmerOffsets &other) const {
+            return this->stats_index == other.stats_index
+                   and this->sa_intervals_index == other.sa_intervals_index;
+        };
+    };
+
+    std::vector<IndexedKmerOffsets> calculate_offsets(const uint64_t &count_kmers,
+                                                      const sdsl::int_vector<> &kmers_stats);
+
+    // decodes the kmer's compressed paths: the loaded index holds plain VariantSitePath lists,
+    // so path compression shrinks the paths file and its load, not resident memory
+    SearchStates deserialize_search_states(const uint64_t &kmer_number,
+                                           const IndexedKmerOffsets &offsets,
+                                           const sdsl::int_vector<> &kmers_stats,
+                                           const sdsl::int_vector<> &sa_intervals,
+                                           const CompressedPaths &paths);
+
+    KmerIndex parse_kmer_index(const sdsl::int_vector<3> &all_kmers,
+                               const sdsl::int_vector<> &kmers_stats,
+                               const sdsl::int_vector<> &sa_intervals,
+                               const CompressedPaths &paths,
+                               const Parameters &parameters);
 
     namespace kmer_index {
         KmerIndex load(const Parameters &parameters);
@@ -0,0 +1,83 @@
+#include <cassert>
+#include <utility>
+
+#include "common/utils.hpp"
+
+
+#ifndef GRAMTOOLS_KMER_INDEX_PACKED_KMER_HPP
+#define GRAMTOOLS_KMER_INDEX_PACKED_KMER_HPP
+
+namespace gram {
+
+    // kmer bases packed two bits each (A=0, C=1, G=2, T=3), first base most significant
+    using PackedKmer = uint64_t;
+    constexpr uint32_t max_packed_kmer_size = 32;
+
+    // one shift and or per base, expanded at compile time: no loop left to unroll
+    template<uint32_t... BASE_INDEXES>
+    PackedKmer pack_kmer_bases(const Base *bases, std::integer_sequence<uint32_t, BASE_INDEXES...>) {
+        PackedKmer packed_kmer = 0;
+        ((packed_kmer = (packed_kmer << 2) | ((bases[BASE_INDEXES] - 1) & 3)), ...);
+        return packed_kmer;
+    }
+
+    template<uint32_t KMER_SIZE>
+    PackedKmer pack_kmer(const Base *bases) {
+        static_assert(KMER_SIZE >= 1 and KMER_SIZE <= max_packed_kmer_size, "kmer size cannot be packed");
+        return pack_kmer_bases(bases, std::make_integer_sequence<uint32_t, KMER_SIZE>{});
+    }
+
+#define GRAMTOOLS_PACK_KMER_CASE(K) case (K): return pack_kmer<(K)>(bases);
+#define GRAMTOOLS_PACK_KMER_CASES_4(K) GRAMTOOLS_PACK_KMER_CASE(K) GRAMTOOLS_PACK_KMER_CASE((K) + 1) \
+                                       GRAMTOOLS_PACK_KMER_CASE((K) + 2) GRAMTOOLS_PACK_KMER_CASE((K) + 3)
+
+    // every packable kmer size dispatches to its expanded instantiation
+    inline PackedKmer pack_kmer(const Base *bases, const uint32_t &kmer_size) {
+        assert(kmer_size <= max_packed_kmer_size);
+        switch (kmer_size) {
+            GRAMTOOLS_PACK_KMER_CASES_4(1)
+            GRAMTOOLS_PACK_KMER_CASES_4(5)
+            GRAMTOOLS_PACK_KMER_CASES_4(9)
+            GRAMTOOLS_PACK_KMER_CASES_4(13)
+            GRAMTOOLS_PACK_KMER_CASES_4(17)
+            GRAMTOOLS_PACK_KMER_CASES_4(21)
+            GRAMTOOLS_PACK_KMER_CASES_4(25)
+            GRAMTOOLS_PACK_KMER_CASES_4(29)
+            default:
+                return 0;
+        }
+    }
+
+#undef GRAMTOOLS_PACK_KMER_CASES_4
+#undef GRAMTOOLS_PACK_KMER_CASE
+
+    inline PackedKmer pack_kmer(const Pattern &kmer) {
+        return pack_kmer(kmer.data(), (uint32_t) kmer.size());
+    }
+
+    // the read's seed kmer (its last kmer_size bases), packed in place
+    inline PackedKmer pack_read_kmer(const Pattern &read, const uint32_t &kmer_size) {
+        assert(read.size() >= kmer_size);
+        return pack_kmer(read.data() + read.size() - kmer_size, kmer_size);
+    }
+
+    inline Pattern unpack_kmer(const PackedKmer &packed_kmer, const uint32_t &kmer_size) {
+        Pattern kmer(kmer_size);
+        for (uint32_t i = 0; i < kmer_size; ++i)
+            kmer[i] = (Base) (((packed_kmer >> (2 * (kmer_size - 1 - i))) & 3) + 1);
+        return kmer;
+    }
+
+    // splitmix64 finalizer: the low bits of a packed kmer only reflect its last bases
+    struct packed_kmer_hash {
+        std::size_t operator()(const PackedKmer &packed_kmer) const {
+            uint64_t hash = packed_kmer;
+            hash = (hash ^ (hash >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            hash = (hash ^ (hash >> 27)) * 0x94d049bb133111ebULL;
+            return hash ^ (hash >> 31);
+        }
+    };
+
+}
+
+#endif //GRAMTOOLS_KMER_INDEX_PACKED_KMER_HPP
@@ -0,0 +1,48 @@
+#include <sdsl/vectors.hpp>
+#include <sdsl/rmq_support.hpp>
+
+#include "common/parameters.hpp"
+#include "common/utils.hpp"
+#include "fm_index.hpp"
+
+
+#ifndef GRAMTOOLS_INVARIANT_REACH_HPP
+#define GRAMTOOLS_INVARIANT_REACH_HPP
+
+namespace gram {
+
+    // per SA index: 0 when the kmer starting at the suffix touches a variant site or marker,
+    // otherwise one more than the count of non-variant bases left of the suffix (capped);
+    // empty when not generated
+    struct InvariantReach {
+        uint64_t kmer_size = 0;
+        sdsl::int_vector<8> sa_reach;
+
+        uint64_t serialize(std::ostream &out,
+                           sdsl::structure_tree_node *v = nullptr,
+                           std::string name = "") const;
+
+        void load(std::istream &in);
+    };
+
+    using InvariantReachRMQ = sdsl::rmq_succinct_sct<>;
+
+    constexpr uint64_t max_invariant_reach = 255;
+
+    InvariantReach generate_invariant_reach(const FM_Index &fm_index,
+                                            const sdsl::int_vector<> &encoded_prg,
+                                            const sdsl::int_vector<> &sites_mask,
+                                            const uint64_t &kmer_size);
+
+    InvariantReach load_invariant_reach(const Parameters &parameters);
+
+    // true if every suffix in the SA interval starts a non-variant kmer preceded by
+    // at least count_left_bases non-variant bases
+    bool sa_interval_invariant(const InvariantReach &invariant_reach,
+                               const InvariantReachRMQ &invariant_reach_rmq,
+                               const SA_Interval &sa_interval,
+                               const uint64_t &count_left_bases);
+
+}
+
+#endif //GRAMTOOLS_INVARIANT_REACH_HPP
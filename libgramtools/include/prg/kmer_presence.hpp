@@ -0,0 +1,38 @@
+#include <sdsl/vectors.hpp>
+
+#include "common/parameters.hpp"
+#include "common/utils.hpp"
+
+
+#ifndef GRAMTOOLS_KMER_PRESENCE_HPP
+#define GRAMTOOLS_KMER_PRESENCE_HPP
+
+namespace gram {
+
+    // a 4^kmer_size bits mask, with a set bit for every kmer along some path through the PRG
+    // (bases packed two bits each, first base most significant); empty when not generated
+    struct KmerPresence {
+        uint64_t kmer_size = 0;
+        sdsl::bit_vector kmers_mask;
+
+        uint64_t serialize(std::ostream &out,
+                           sdsl::structure_tree_node *v = nullptr,
+                           std::string name = "") const;
+
+        void load(std::istream &in);
+    };
+
+    constexpr uint64_t presence_kmer_size = 12;
+
+    KmerPresence generate_kmer_presence(const sdsl::int_vector<> &encoded_prg,
+                                        const uint64_t &kmer_size);
+
+    KmerPresence load_kmer_presence(const Parameters &parameters);
+
+    // false only if the read has an absent sampled kmer, and so cannot map exactly
+    bool sampled_kmers_present(const KmerPresence &kmer_presence,
+                               const Pattern &read);
+
+}
+
+#endif //GRAMTOOLS_KMER_PRESENCE_HPP
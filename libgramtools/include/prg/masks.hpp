@@ -22,9 +22,33 @@ namespace gram {
 
     sdsl::int_vector<> generate_sites_mask(const sdsl::int_vector<> &encoded_prg);
 
-    sdsl::bit_vector generate_prg_markers_mask(const sdsl::int_vector<> &encoded_prg);
+    // a strand symmetric PRG's strand separator is not a marker
+    sdsl::bit_vector generate_prg_markers_mask(const sdsl::int_vector<> &encoded_prg,
+                                               const uint64_t &strand_separator = 0);
 
-    sdsl::bit_vector generate_bwt_markers_mask(const FM_Index &fm_index);
+    sdsl::bit_vector generate_bwt_markers_mask(const FM_Index &fm_index,
+                                               const uint64_t &strand_separator = 0);
+
+    // BWT indexes and symbols of all markers in the BWT, indexed by marker rank
+    struct BWT_Markers {
+        sdsl::int_vector<> indexes;
+        sdsl::int_vector<> symbols;
+
+        uint64_t serialize(std::ostream &out,
+                           sdsl::structure_tree_node *v = nullptr,
+                           std::string name = "") const;
+
+        void load(std::istream &in);
+    };
+
+    BWT_Markers generate_bwt_markers(const FM_Index &fm_index,
+                                     const sdsl::bit_vector &bwt_markers_mask);
+
+    BWT_Markers load_bwt_markers(const Parameters &parameters);
+
+    // the mask rebuilt from the markers' BWT indexes, without scanning the BWT
+    sdsl::bit_vector generate_bwt_markers_mask(const BWT_Markers &bwt_markers,
+                                               const uint64_t &bwt_size);
 
 }
 
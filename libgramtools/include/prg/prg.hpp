@@ -7,6 +7,11 @@
 #include "common/utils.hpp"
 #include "dna_ranks.hpp"
 #include "fm_index.hpp"
+#include "masks.hpp"
+#include "site_table.hpp"
+#include "sa_allele_runs.hpp"
+#include "kmer_presence.hpp"
+#include "invariant_reach.hpp"
 
 
 #ifndef GRAMTOOLS_PRG_HPP
@@ -20,11 +25,22 @@ namespace gram {
 
         sdsl::int_vector<> sites_mask;
         sdsl::int_vector<> allele_mask;
+        SiteTable site_table;
+
+        SA_AlleleRuns sa_allele_runs;
+        sdsl::rank_support_v<1> sa_allele_runs_rank;
+        sdsl::select_support_mcl<1> sa_allele_runs_select;
+
+        KmerPresence kmer_presence;
+
+        InvariantReach invariant_reach;
+        InvariantReachRMQ invariant_reach_rmq;
 
         sdsl::bit_vector bwt_markers_mask;
         sdsl::rank_support_v<1> bwt_markers_rank;
         sdsl::select_support_mcl<1> bwt_markers_select;
         uint64_t markers_mask_count_set_bits;
+        BWT_Markers bwt_markers;
 
         sdsl::bit_vector prg_markers_mask;
         sdsl::rank_support_v<1> prg_markers_rank;
@@ -37,6 +53,9 @@ namespace gram {
         sdsl::rank_support_v<1> rank_bwt_t;
 
         uint64_t max_alphabet_num;
+
+        // sites per strand when the PRG is indexed with its reverse complement, otherwise 0
+        uint64_t strand_count_sites = 0;
     };
 
     uint64_t dna_bwt_rank(const uint64_t &upper_index,
@@ -45,6 +64,13 @@ namespace gram {
 
     uint64_t get_max_alphabet_num(const sdsl::int_vector<> &encoded_prg);
 
+    // hash of the encoded PRG's size and symbols, identifies the PRG files derived from it
+    uint64_t encoded_prg_checksum(const sdsl::int_vector<> &encoded_prg);
+
+    bool markers_fit_variant_ids(const uint64_t &max_alphabet_num);
+
+    void exit_if_markers_exceed_variant_ids(const uint64_t &max_alphabet_num);
+
     sdsl::int_vector<> generate_encoded_prg(const Parameters &parameters);
 
     sdsl::int_vector<> parse_raw_prg_file(const std::string &prg_fpath);
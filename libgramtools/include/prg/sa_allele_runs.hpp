@@ -0,0 +1,39 @@
+#include <sdsl/vectors.hpp>
+
+#include "common/parameters.hpp"
+#include "common/utils.hpp"
+#include "fm_index.hpp"
+
+
+#ifndef GRAMTOOLS_SA_ALLELE_RUNS_HPP
+#define GRAMTOOLS_SA_ALLELE_RUNS_HPP
+
+namespace gram {
+
+    // maximal runs of consecutive SA indexes whose suffixes start in the same allele,
+    // or outside of any variant site (site marker 0); runs are indexed by run rank
+    struct SA_AlleleRuns {
+        sdsl::bit_vector run_starts_mask;
+        sdsl::int_vector<> site_markers;
+        sdsl::int_vector<> allele_ids;
+
+        uint64_t serialize(std::ostream &out,
+                           sdsl::structure_tree_node *v = nullptr,
+                           std::string name = "") const;
+
+        void load(std::istream &in);
+    };
+
+    SA_AlleleRuns generate_sa_allele_runs(const FM_Index &fm_index,
+                                          const sdsl::int_vector<> &sites_mask,
+                                          const sdsl::int_vector<> &allele_mask);
+
+    SA_AlleleRuns load_sa_allele_runs(const Parameters &parameters);
+
+    inline uint64_t count_runs(const SA_AlleleRuns &sa_allele_runs) {
+        return sa_allele_runs.site_markers.size();
+    }
+
+}
+
+#endif //GRAMTOOLS_SA_ALLELE_RUNS_HPP
@@ -0,0 +1,54 @@
+#include <sdsl/vectors.hpp>
+
+#include "common/parameters.hpp"
+#include "common/utils.hpp"
+#include "fm_index.hpp"
+
+
+#ifndef GRAMTOOLS_SITE_TABLE_HPP
+#define GRAMTOOLS_SITE_TABLE_HPP
+
+namespace gram {
+
+    // per variant site geometry, indexed by site index ((boundary marker - 5) / 2);
+    // a site's alleles are found in the allele arrays from allele_offsets[site index]
+    struct SiteTable {
+        sdsl::int_vector<> start_prg_indexes;
+        sdsl::int_vector<> end_prg_indexes;
+        sdsl::int_vector<> start_sa_indexes;
+        sdsl::int_vector<> end_sa_indexes;
+
+        sdsl::int_vector<> allele_offsets;
+        sdsl::int_vector<> allele_start_prg_indexes;
+        sdsl::int_vector<> allele_lengths;
+
+        uint64_t serialize(std::ostream &out,
+                           sdsl::structure_tree_node *v = nullptr,
+                           std::string name = "") const;
+
+        void load(std::istream &in);
+    };
+
+    inline uint64_t site_index(const Marker &site_marker) {
+        return (site_marker - 5) / 2;
+    }
+
+    SiteTable generate_site_table(const sdsl::int_vector<> &encoded_prg,
+                                  const FM_Index &fm_index);
+
+    SiteTable load_site_table(const Parameters &parameters);
+
+    uint64_t count_sites(const SiteTable &site_table);
+
+    std::pair<uint64_t, uint64_t> site_prg_indexes(const Marker &site_marker,
+                                                   const SiteTable &site_table);
+
+    uint64_t allele_start_prg_index(const VariantSite &variant_site,
+                                    const SiteTable &site_table);
+
+    uint64_t allele_length(const VariantSite &variant_site,
+                           const SiteTable &site_table);
+
+}
+
+#endif //GRAMTOOLS_SITE_TABLE_HPP
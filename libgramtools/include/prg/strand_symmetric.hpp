@@ -0,0 +1,34 @@
+#include <sdsl/vectors.hpp>
+
+#include "common/utils.hpp"
+
+
+#ifndef GRAMTOOLS_STRAND_SYMMETRIC_HPP
+#define GRAMTOOLS_STRAND_SYMMETRIC_HPP
+
+namespace gram {
+
+    uint64_t count_variant_sites(const sdsl::int_vector<> &encoded_prg);
+
+    // the allele marker of the first site past both strands: no read base matches it and no
+    // site claims it, so a backward search cannot extend a match across the strands' junction;
+    // 0 (never a marker) when the PRG is not strand symmetric
+    uint64_t strand_separator(const uint64_t &strand_count_sites);
+
+    // both strands have the same length, the separator sits between them
+    uint64_t strand_separator_index(const uint64_t &symmetric_prg_size);
+
+    // the PRG, the strand separator, then the PRG's reverse complement; reverse complement site
+    // markers are offset by twice the site count and keep their allele order, so reverse
+    // complement site i + site count is site i with allele j reverse complemented
+    sdsl::int_vector<> generate_strand_symmetric_prg(const sdsl::int_vector<> &encoded_prg);
+
+    // an encoded PRG of n characters indexes as n + 1 SA entries (the sentinel), twice as many
+    // plus two (the separator and the sentinel) when the index was built from the strand
+    // symmetric PRG
+    bool index_is_strand_symmetric(const uint64_t &fm_index_size,
+                                   const uint64_t &encoded_prg_size);
+
+}
+
+#endif //GRAMTOOLS_STRAND_SYMMETRIC_HPP
@@ -10,6 +10,10 @@ namespace gram {
     namespace coverage {
         namespace generate {
             SitesAlleleBaseCoverage allele_base_structure(const PRG_Info &prg_info);
+
+            void allele_base_deltas(Coverage &coverage, const uint32_t &count_threads);
+
+            void allele_base_from_deltas(Coverage &coverage);
         }
 
         namespace record {
@@ -17,6 +21,12 @@ namespace gram {
                              const SearchStates &search_states,
                              const uint64_t &read_length,
                              const PRG_Info &prg_info);
+
+            void allele_base(Coverage &coverage,
+                             RecordScratch &scratch,
+                             const SelectedSearchStates &selected_search_states,
+                             const uint64_t &read_length,
+                             const PRG_Info &prg_info);
         }
 
         namespace dump {
@@ -27,12 +37,15 @@ namespace gram {
 
     std::string dump_allele_base_coverage(const SitesAlleleBaseCoverage &sites);
 
+    // a thread's buffered deltas are added to the shared deltas once this many are pending
+    constexpr uint64_t max_buffered_base_deltas = 1 << 16;
+
+    void flush_base_deltas(SitesAlleleBaseDeltas &allele_base_deltas, BaseDeltasBuffer &buffer);
+
     uint64_t inter_site_base_count(const uint64_t &first_site_marker,
                                    const uint64_t &second_site_marker,
                                    const PRG_Info &prg_info);
 
-    using SitesCoverageBoundaries = PairHashMap<VariantSite, uint64_t>;
-
     uint64_t set_site_base_coverage(Coverage &coverage,
                                     SitesCoverageBoundaries &sites_coverage_boundaries,
                                     const VariantSite &path_element,
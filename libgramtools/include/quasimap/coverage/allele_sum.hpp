@@ -13,6 +13,10 @@ namespace gram::coverage {
     namespace record {
         void allele_sum(Coverage &coverage,
                         const SearchStates &search_states);
+
+        void allele_sum(Coverage &coverage,
+                        RecordScratch &scratch,
+                        const SelectedSearchStates &selected_search_states);
     }
 
     namespace dump {
@@ -13,11 +13,14 @@ namespace gram {
                                const SearchStates &search_states,
                                const uint64_t &read_length,
                                const PRG_Info &prg_info,
-                               const uint32_t &random_seed = 0);
+                               const uint64_t &random_seed = 0);
         }
 
         namespace generate {
             Coverage empty_structure(const PRG_Info &prg_info);
+
+            // adds reverse complement site i + strand_count_sites coverage to site i, keeping the first strand's sites
+            void fold_strand_symmetric(Coverage &coverage, const uint64_t &strand_count_sites);
         }
 
         namespace dump {
@@ -47,6 +50,14 @@ namespace gram {
     SearchStates filter_for_path_sites(const PathSites &target_path_sites,
                                        const SearchStates &search_states);
 
+    SelectedSearchStates get_selected_search_states(const SearchStates &search_states);
+
+    void select_search_states(RecordScratch &scratch,
+                              const SearchStates &search_states,
+                              const uint64_t &read_length,
+                              const PRG_Info &prg_info,
+                              const uint64_t &random_seed);
+
 }
 
 #endif //GRAMTOOLS_COVERAGE_COMMON_HPP
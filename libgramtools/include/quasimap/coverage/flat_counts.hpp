@@ -0,0 +1,242 @@
+#include <algorithm>
+#include <cstdint>
+#include <initializer_list>
+#include <vector>
+
+
+#ifndef GRAMTOOLS_FLAT_COUNTS_HPP
+#define GRAMTOOLS_FLAT_COUNTS_HPP
+
+namespace gram {
+
+    // iterates a container's elements by index, elements are returned by value (as views)
+    template<typename CONTAINER, typename VALUE>
+    class IndexIterator {
+    public:
+        IndexIterator(CONTAINER *container, uint64_t index) : container(container), index(index) {}
+
+        VALUE operator*() const { return (*container)[index]; }
+
+        IndexIterator &operator++() {
+            ++index;
+            return *this;
+        }
+
+        bool operator==(const IndexIterator &other) const { return index == other.index; }
+
+        bool operator!=(const IndexIterator &other) const { return index != other.index; }
+
+    private:
+        CONTAINER *container;
+        uint64_t index;
+    };
+
+
+    // contiguous range of counts
+    template<typename T>
+    class CountsSpan {
+    public:
+        using value_type = T;
+        using iterator = T *;
+        using const_iterator = T *;
+
+        CountsSpan(T *first, T *last) : first(first), last(last) {}
+
+        T *begin() const { return first; }
+
+        T *end() const { return last; }
+
+        uint64_t size() const { return last - first; }
+
+        bool empty() const { return first == last; }
+
+        T &operator[](const uint64_t &i) const { return first[i]; }
+
+        T &back() const { return *(last - 1); }
+
+        template<typename OTHER>
+        bool operator==(const CountsSpan<OTHER> &other) const {
+            return std::equal(first, last, other.begin(), other.end());
+        }
+
+    private:
+        T *first;
+        T *last;
+    };
+
+
+    // rows of counts over one contiguous buffer (CSR), row i is counts[offsets[i], offsets[i + 1])
+    template<typename T>
+    class FlatCounts {
+    public:
+        using Row = CountsSpan<T>;
+        using ConstRow = CountsSpan<const T>;
+        using iterator = IndexIterator<FlatCounts, Row>;
+        using const_iterator = IndexIterator<const FlatCounts, ConstRow>;
+
+        FlatCounts() = default;
+
+        FlatCounts(std::initializer_list<std::vector<T>> rows) {
+            for (const auto &row: rows) {
+                counts.insert(counts.end(), row.begin(), row.end());
+                offsets.push_back(counts.size());
+            }
+        }
+
+        static FlatCounts with_row_sizes(const std::vector<uint64_t> &row_sizes) {
+            FlatCounts flat_counts;
+            flat_counts.offsets.reserve(row_sizes.size() + 1);
+            for (const auto &row_size: row_sizes)
+                flat_counts.offsets.push_back(flat_counts.offsets.back() + row_size);
+            flat_counts.counts.resize(flat_counts.offsets.back(), 0);
+            return flat_counts;
+        }
+
+        uint64_t size() const { return offsets.size() - 1; }
+
+        bool empty() const { return size() == 0; }
+
+        Row operator[](const uint64_t &i) {
+            return Row(counts.data() + offsets[i], counts.data() + offsets[i + 1]);
+        }
+
+        ConstRow operator[](const uint64_t &i) const {
+            return ConstRow(counts.data() + offsets[i], counts.data() + offsets[i + 1]);
+        }
+
+        iterator begin() { return iterator(this, 0); }
+
+        iterator end() { return iterator(this, size()); }
+
+        const_iterator begin() const { return const_iterator(this, 0); }
+
+        const_iterator end() const { return const_iterator(this, size()); }
+
+        std::vector<T> &all_counts() { return counts; }
+
+        const std::vector<T> &all_counts() const { return counts; }
+
+        bool operator==(const FlatCounts &other) const {
+            return offsets == other.offsets and counts == other.counts;
+        }
+
+    private:
+        std::vector<uint64_t> offsets = {0};
+        std::vector<T> counts;
+    };
+
+
+    // rows of FlatCounts rows: site i holds rows[site_offsets[i], site_offsets[i + 1])
+    template<typename T>
+    class FlatNestedCounts {
+    public:
+        template<typename COUNTS, typename ROW>
+        class RowsView {
+        public:
+            using value_type = ROW;
+            using iterator = IndexIterator<const RowsView, ROW>;
+            using const_iterator = iterator;
+
+            RowsView(COUNTS *rows, uint64_t first, uint64_t last) : rows(rows), first(first), last(last) {}
+
+            uint64_t size() const { return last - first; }
+
+            bool empty() const { return first == last; }
+
+            ROW operator[](const uint64_t &i) const { return (*rows)[first + i]; }
+
+            iterator begin() const { return iterator(this, 0); }
+
+            iterator end() const { return iterator(this, size()); }
+
+            template<typename OTHER_COUNTS, typename OTHER_ROW>
+            bool operator==(const RowsView<OTHER_COUNTS, OTHER_ROW> &other) const {
+                if (size() != other.size())
+                    return false;
+                for (uint64_t i = 0; i < size(); ++i)
+                    if (not((*this)[i] == other[i]))
+                        return false;
+                return true;
+            }
+
+        private:
+            COUNTS *rows;
+            uint64_t first;
+            uint64_t last;
+        };
+
+        using Site = RowsView<FlatCounts<T>, CountsSpan<T>>;
+        using ConstSite = RowsView<const FlatCounts<T>, CountsSpan<const T>>;
+        using iterator = IndexIterator<FlatNestedCounts, Site>;
+        using const_iterator = IndexIterator<const FlatNestedCounts, ConstSite>;
+
+        FlatNestedCounts() = default;
+
+        FlatNestedCounts(std::initializer_list<std::vector<std::vector<T>>> sites) {
+            std::vector<std::vector<uint64_t>> sizes;
+            for (const auto &site: sites) {
+                sizes.emplace_back();
+                for (const auto &row: site)
+                    sizes.back().push_back(row.size());
+            }
+            *this = with_row_sizes(sizes);
+
+            uint64_t i = 0;
+            for (const auto &site: sites)
+                for (const auto &row: site)
+                    for (const auto &count: row)
+                        rows.all_counts()[i++] = count;
+        }
+
+        static FlatNestedCounts with_row_sizes(const std::vector<std::vector<uint64_t>> &site_row_sizes) {
+            FlatNestedCounts flat_counts;
+            std::vector<uint64_t> row_sizes;
+            for (const auto &site_sizes: site_row_sizes) {
+                row_sizes.insert(row_sizes.end(), site_sizes.begin(), site_sizes.end());
+                flat_counts.site_offsets.push_back(row_sizes.size());
+            }
+            flat_counts.rows = FlatCounts<T>::with_row_sizes(row_sizes);
+            return flat_counts;
+        }
+
+        uint64_t size() const { return site_offsets.size() - 1; }
+
+        bool empty() const { return size() == 0; }
+
+        Site operator[](const uint64_t &i) {
+            return Site(&rows, site_offsets[i], site_offsets[i + 1]);
+        }
+
+        ConstSite operator[](const uint64_t &i) const {
+            return ConstSite(&rows, site_offsets[i], site_offsets[i + 1]);
+        }
+
+        iterator begin() { return iterator(this, 0); }
+
+        iterator end() { return iterator(this, size()); }
+
+        const_iterator begin() const { return const_iterator(this, 0); }
+
+        const_iterator end() const { return const_iterator(this, size()); }
+
+        FlatCounts<T> &all_rows() { return rows; }
+
+        const FlatCounts<T> &all_rows() const { return rows; }
+
+        // index into all_rows of a site's row
+        uint64_t row_index(const uint64_t &site_index, const uint64_t &row) const {
+            return site_offsets[site_index] + row;
+        }
+
+        bool operator==(const FlatNestedCounts &other) const {
+            return site_offsets == other.site_offsets and rows == other.rows;
+        }
+
+    private:
+        std::vector<uint64_t> site_offsets = {0};
+        FlatCounts<T> rows;
+    };
+
+}
+
+#endif //GRAMTOOLS_FLAT_COUNTS_HPP
@@ -8,12 +8,16 @@
 namespace gram {
     namespace coverage {
         namespace generate {
-            SitesGroupedAlleleCounts grouped_allele_counts(const PRG_Info &prg_info);
+            SitesAlleleGroupCounts grouped_allele_counts(const PRG_Info &prg_info);
         }
 
         namespace record {
             void grouped_allele_counts(Coverage &coverage,
                                        const SearchStates &search_states);
+
+            void grouped_allele_counts(Coverage &coverage,
+                                       RecordScratch &scratch,
+                                       const SelectedSearchStates &selected_search_states);
         }
 
         namespace dump {
@@ -22,6 +26,21 @@ namespace gram {
         }
     }
 
+    void insert_allele_id(AlleleGroup &allele_group, const AlleleId &allele_id);
+
+    AlleleIds get_allele_ids(const AlleleGroup &allele_group);
+
+    AlleleGroupId intern_allele_group(AlleleGroupTable &allele_groups,
+                                      const AlleleGroup &allele_group);
+
+    // group IDs renumbered in allele IDs order, so they do not depend on the order in which
+    // threads recorded reads: canonical ID of group ID i is at index i
+    std::vector<AlleleGroupId> canonical_group_ids(const AlleleGroupTable &allele_groups);
+
+    SitesGroupedAlleleCounts get_grouped_allele_counts(const Coverage &coverage);
+
+    std::string dump_grouped_allele_counts(const Coverage &coverage);
+
     AlleleGroupHash hash_allele_groups(const SitesGroupedAlleleCounts &sites);
 
     std::string dump_site(const AlleleGroupHash &allele_ids_groups_hash,
@@ -1,11 +1,19 @@
+#include <array>
+#include <limits>
+#include <mutex>
+#include <shared_mutex>
+
 #include "common/utils.hpp"
+#include "search/search_types.hpp"
+#include "quasimap/coverage/flat_counts.hpp"
 
 
 #ifndef GRAMTOOLS_COVERAGE_TYPES_HPP
 #define GRAMTOOLS_COVERAGE_TYPES_HPP
 
 namespace gram {
-    using AlleleSumCoverage = std::vector<std::vector<uint64_t>>;
+    // site indexed rows of allele counts
+    using AlleleSumCoverage = FlatCounts<uint64_t>;
 
     template<typename SEQUENCE, typename T>
     using SequenceHashMap = std::unordered_map<SEQUENCE, T, sequence_hash < SEQUENCE>>;
@@ -14,14 +22,177 @@ namespace gram {
     using SitesGroupedAlleleCounts = std::vector<GroupedAlleleCounts>;
     using AlleleGroupHash = SequenceHashMap<AlleleIds, uint64_t>;
 
-    using BaseCoverage = std::vector<uint16_t>;
+    // set of (zero based) allele IDs: a bitset for IDs below 64, spilled to sorted IDs otherwise
+    struct AlleleGroup {
+        uint64_t bitset = 0;
+        AlleleIds spilled_ids = {};
+
+        bool operator==(const AlleleGroup &other) const {
+            return this->bitset == other.bitset
+                   and this->spilled_ids == other.spilled_ids;
+        };
+    };
+
+    struct allele_group_hash {
+        std::size_t operator()(const AlleleGroup &allele_group) const {
+            std::size_t hash = 0;
+            boost::hash_combine(hash, allele_group.bitset);
+            boost::hash_range(hash, allele_group.spilled_ids.begin(), allele_group.spilled_ids.end());
+            return hash;
+        }
+    };
+
+    using AlleleGroupId = uint64_t;
+
+    // allele groups interned as reads are recorded, IDs in order of first appearance;
+    // dumps renumber them by allele IDs (see canonical_group_ids)
+    struct AlleleGroupTable {
+        std::vector<AlleleGroup> groups;
+        std::unordered_map<AlleleGroup, AlleleGroupId, allele_group_hash> group_ids;
+    };
+
+    // a site's read counts by interned allele group ID
+    using SiteAlleleGroupCounts = std::unordered_map<AlleleGroupId, uint64_t>;
+    using SitesAlleleGroupCounts = std::vector<SiteAlleleGroupCounts>;
+
+    // a site's group counts are guarded by one of a fixed pool of locks, so threads recording
+    // reads at different sites rarely wait on each other; copies get their own locks
+    struct GroupedCountsLocks {
+        static constexpr uint64_t count_site_locks = 1024;
+
+        GroupedCountsLocks() = default;
+
+        GroupedCountsLocks(const GroupedCountsLocks &) {}
+
+        GroupedCountsLocks &operator=(const GroupedCountsLocks &) { return *this; }
+
+        std::mutex &site_lock(const uint64_t &site_index) {
+            return site_locks[site_index % count_site_locks];
+        }
+
+        std::array<std::mutex, count_site_locks> site_locks;
+        std::shared_mutex allele_groups_mutex;
+    };
+
+    // a mutex which copies as a fresh unlocked mutex, so structures holding one stay copyable
+    struct CopyableMutex {
+        CopyableMutex() = default;
+
+        CopyableMutex(const CopyableMutex &) {}
+
+        CopyableMutex &operator=(const CopyableMutex &) { return *this; }
+
+        std::mutex mutex;
+    };
+
+    // narrow per base counts, 32 bit with GRAMTOOLS_WIDE_BASE_COVERAGE
+#ifdef GRAMTOOLS_WIDE_BASE_COVERAGE
+    using BaseCount = uint32_t;
+#else
+    using BaseCount = uint16_t;
+#endif
+    constexpr BaseCount max_base_count = std::numeric_limits<BaseCount>::max();
+    using WideBaseCount = uint64_t;
+
+    using BaseCoverage = std::vector<WideBaseCount>;
     using AlleleCoverage = std::vector<BaseCoverage>;
-    using SitesAlleleBaseCoverage = std::vector<AlleleCoverage>;
+
+    /*
+    site indexed rows (one per allele) of per base counts. Counts start narrow; an allele whose
+    count would reach max_base_count is promoted to wide counts, after which all its narrow
+    counts hold max_base_count. Alleles are indexed across all sites (see allele_index).
+    */
+    class SitesAlleleBaseCoverage {
+    public:
+        using Site = FlatNestedCounts<BaseCount>::Site;
+        using ConstSite = FlatNestedCounts<BaseCount>::ConstSite;
+
+        SitesAlleleBaseCoverage() = default;
+
+        // alleles with a count of at least max_base_count start promoted
+        SitesAlleleBaseCoverage(std::initializer_list<AlleleCoverage> sites);
+
+        static SitesAlleleBaseCoverage with_row_sizes(const std::vector<std::vector<uint64_t>> &site_row_sizes);
+
+        uint64_t size() const { return narrow_counts.size(); }
+
+        bool empty() const { return narrow_counts.empty(); }
+
+        // narrow counts, max_base_count throughout for a promoted allele
+        Site operator[](const uint64_t &site_index) { return narrow_counts[site_index]; }
+
+        ConstSite operator[](const uint64_t &site_index) const { return narrow_counts[site_index]; }
+
+        uint64_t count_alleles() const { return narrow_counts.all_rows().size(); }
+
+        uint64_t allele_index(const uint64_t &site_index, const uint64_t &allele) const {
+            return narrow_counts.row_index(site_index, allele);
+        }
+
+        uint64_t allele_size(const uint64_t &allele_index) const {
+            return narrow_counts.all_rows()[allele_index].size();
+        }
+
+        WideBaseCount base_count(const uint64_t &allele_index, const uint64_t &base_index) const;
+
+        // threads may add to different alleles concurrently, but not to the same allele
+        void add(const uint64_t &allele_index, const uint64_t &base_index, const WideBaseCount &count);
+
+        // adds one, safe for concurrent calls on the same allele
+        void increment(const uint64_t &allele_index, const uint64_t &base_index);
+
+        // compares counts, whether narrow or promoted
+        bool operator==(const SitesAlleleBaseCoverage &other) const;
+
+    private:
+        // promotes the allele if not yet promoted, promotion_mutex must be held
+        std::vector<WideBaseCount> &promoted_allele(const uint64_t &allele_index);
+
+        FlatNestedCounts<BaseCount> narrow_counts;
+        std::unordered_map<uint64_t, std::vector<WideBaseCount>> promoted_alleles;
+        CopyableMutex promotion_mutex;
+    };
+
+    // coverage interval start (+1) and end (-1) counts, one element longer than each allele
+    using SitesAlleleBaseDeltas = FlatNestedCounts<int32_t>;
+
+    // a thread's pending deltas, as (index into the flat delta counts, delta)
+    using BaseDeltasBuffer = std::vector<std::pair<uint64_t, int32_t>>;
+
+    // a selected search state, sa_interval narrowed when a single mapping is randomly chosen
+    struct SelectedSearchState {
+        const SearchState *search_state;
+        SA_Interval sa_interval;
+    };
+    using SelectedSearchStates = std::vector<SelectedSearchState>;
+
+    // per read allele base coverage end indexes, sorted by variant site
+    using SitesCoverageBoundaries = std::vector<std::pair<VariantSite, uint64_t>>;
+
+    // buffers cleared (not freed) between reads, so recording a read does not allocate
+    struct RecordScratch {
+        std::vector<const SearchState *> unique_path_search_states;
+        SelectedSearchStates selected_search_states;
+        std::vector<VariantSite> seen_sites;
+        std::vector<std::pair<Marker, AlleleGroup>> site_allele_groups;
+        SitesCoverageBoundaries sites_coverage_boundaries;
+    };
 
     struct Coverage {
         AlleleSumCoverage allele_sum_coverage;
-        SitesGroupedAlleleCounts grouped_allele_counts;
+        SitesAlleleGroupCounts grouped_allele_counts;
+        AlleleGroupTable allele_groups;
+        GroupedCountsLocks grouped_counts_locks;
         SitesAlleleBaseCoverage allele_base_coverage;
+
+        // allele base deltas shared by all threads, fed from the per thread buffers
+        SitesAlleleBaseDeltas allele_base_deltas;
+
+        // per thread pending deltas, when empty base coverage is recorded directly
+        std::vector<BaseDeltasBuffer> allele_base_delta_buffers;
+
+        // per thread record buffers, when empty each read uses its own
+        std::vector<RecordScratch> record_scratches;
     };
 }
 
@@ -17,6 +17,18 @@ namespace fs = boost::filesystem;
 namespace gram::commands::quasimap {
     Parameters parse_parameters(po::variables_map &vm,
                                 const po::parsed_options &parsed);
+
+    // quasimap input file paths, within the gram directory
+    void set_gram_directory(Parameters &parameters, const std::string &gram_dirpath);
+
+    // quasimap output file paths, within the run directory
+    void set_run_directory(Parameters &parameters, const std::string &run_dirpath);
+
+    // why the given options cannot be used together, empty when they can
+    std::string conflicting_options(const Parameters &parameters);
+
+    // exits when the given options cannot be used together
+    void check_conflicting_options(const Parameters &parameters);
 }
 
 #endif //GRAMTOOLS_QUASIMAP_PARAMETERS_HPP
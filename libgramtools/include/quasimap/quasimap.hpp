@@ -1,6 +1,13 @@
+#include <memory>
+#include <ostream>
+
 #include "parameters.hpp"
+#include "common/numa.hpp"
 #include "kmer_index/kmer_index_types.hpp"
+#include "kmer_index/extended_seed_cache.hpp"
 #include "quasimap/coverage/types.hpp"
+#include "search/search_types.hpp"
+#include "quasimap/read_cache.hpp"
 
 
 #ifndef GRAMTOOLS_QUASIMAP_HPP
@@ -8,32 +15,101 @@
 
 namespace gram {
 
-    namespace commands::quasimap {
-        void run(const Parameters &parameters);
-    }
-
     struct QuasimapReadsStats {
         uint64_t all_reads_count = 0;
         uint64_t skipped_reads_count = 0;
         uint64_t mapped_reads_count = 0;
+
+        // reads abandoned for exceeding the search budget, by limit
+        uint64_t search_states_limit_count = 0;
+        uint64_t sa_interval_width_limit_count = 0;
+        uint64_t marker_crossings_limit_count = 0;
+
+        uint64_t read_cache_hits_count = 0;
+        uint64_t read_cache_misses_count = 0;
+
+        uint64_t extended_seeds_count = 0;
+
+        uint64_t presence_rejected_count = 0;
+        uint64_t seedless_strands_count = 0;
+        uint64_t invariant_reads_count = 0;
+
+        // summed over read search threads, idle while waiting for queued reads
+        double read_threads_busy_seconds = 0;
+        double read_threads_idle_seconds = 0;
+
+        // summed over read search threads, when perf events are permitted
+        uint64_t dtlb_load_misses_count = 0;
+    };
+
+    namespace commands::quasimap {
+        void run(const Parameters &parameters);
+
+        void report_stats(std::ostream &out,
+                          const QuasimapReadsStats &quasimap_stats,
+                          const Parameters &parameters);
+    }
+
+    // a NUMA node's CPUs, and the read only index copies its pinned read search threads use
+    struct NumaNode {
+        numa::CPUs cpus;
+        const KmerIndex *kmer_index = nullptr;
+        const PRG_Info *prg_info = nullptr;
+    };
+
+    // empty when read search threads are left unpinned
+    using NumaNodes = std::vector<NumaNode>;
+
+    // per node index copies, each loaded by a thread pinned to its node; node 0 uses
+    // the caller's copy, so its entries stay empty
+    struct NumaReplicas {
+        std::vector<std::unique_ptr<const KmerIndex>> kmer_indexes;
+        std::vector<std::unique_ptr<const PRG_Info>> prg_infos;
     };
 
+    NumaNodes place_numa_nodes(const Parameters &parameters,
+                               const KmerIndex &kmer_index,
+                               const PRG_Info &prg_info,
+                               NumaReplicas &numa_replicas);
+
     QuasimapReadsStats quasimap_reads(const Parameters &parameters,
                                       const KmerIndex &kmer_index,
                                       const PRG_Info &prg_info);
 
-    void handle_read_file(QuasimapReadsStats &quasimap_stats, Coverage &coverage, const std::string &reads_fpath,
-                          const Parameters &parameters, const KmerIndex &kmer_index, const PRG_Info &prg_info);
+    QuasimapReadsStats quasimap_reads(const Parameters &parameters,
+                                      const KmerIndex &kmer_index,
+                                      const PRG_Info &prg_info,
+                                      const NumaNodes &numa_nodes);
+
+    void handle_read_file(QuasimapReadsStats &quasimap_stats, Coverage &coverage, ReadSearchCache &read_cache,
+                          ExtendedSeedCache &seed_cache, const std::string &reads_fpath, const Parameters &parameters,
+                          const KmerIndex &kmer_index, const PRG_Info &prg_info, const NumaNodes &numa_nodes);
+
+    struct SeededStrands {
+        bool forward = false;
+        bool reverse = false;
+    };
 
-    void quasimap_forward_reverse(QuasimapReadsStats &quasimap_reads_stats,
-                                  Coverage &coverage,
-                                  const Pattern &read,
-                                  const Parameters &parameters,
-                                  const KmerIndex &kmer_index,
-                                  const PRG_Info &prg_info);
+    SeededStrands find_seeded_strands(const Pattern &read,
+                                      const uint32_t &kmer_size,
+                                      const KmerIndex &kmer_index);
 
     bool quasimap_read(const Pattern &read, Coverage &coverage, const KmerIndex &kmer_index, const PRG_Info &prg_info,
-                       const Parameters &parameters, const uint32_t &random_seed = 0);
+                       const Parameters &parameters, const uint64_t &random_seed = 0);
+
+    bool quasimap_read(QuasimapReadsStats &quasimap_reads_stats, ReadSearchCache &read_cache,
+                       ExtendedSeedCache &seed_cache, const Pattern &read, Coverage &coverage,
+                       const KmerIndex &kmer_index, const PRG_Info &prg_info, const Parameters &parameters,
+                       const uint64_t &random_seed);
+
+    std::vector<uint64_t> sort_reads_by_suffix(const std::vector<Pattern> &reads);
+
+    uint64_t count_common_suffix_bases(const Pattern &lhs, const Pattern &rhs);
+
+    SearchBudget get_search_budget(const Parameters &parameters);
+
+    void record_search_budget_limit(QuasimapReadsStats &quasimap_reads_stats,
+                                    const SearchBudgetLimit &exceeded_limit);
 
     Pattern get_kmer_from_read(const uint32_t &kmer_size, const Pattern &read);
 
@@ -0,0 +1,49 @@
+#include <list>
+#include <mutex>
+#include <vector>
+
+#include "common/utils.hpp"
+#include "search/search_types.hpp"
+
+
+#ifndef GRAMTOOLS_READ_CACHE_HPP
+#define GRAMTOOLS_READ_CACHE_HPP
+
+namespace gram {
+
+    struct CachedReadSearch {
+        SearchStates search_states;
+        SearchBudgetLimit exceeded_limit = SearchBudgetLimit::none;
+    };
+
+    // final search states of recently searched reads, keyed by encoded read; sharded so that
+    // threads rarely contend, each shard evicting its least recently used read when full
+    class ReadSearchCache {
+    public:
+        explicit ReadSearchCache(const uint64_t &max_count_reads);
+
+        bool enabled() const { return max_shard_count_reads != 0; }
+
+        bool find(const Pattern &read, CachedReadSearch &cached_read_search);
+
+        void insert(const Pattern &read, const CachedReadSearch &cached_read_search);
+
+    private:
+        using Entries = std::list<std::pair<Pattern, CachedReadSearch>>;
+
+        struct Shard {
+            std::mutex mutex;
+            Entries entries;
+            SequenceHashMap<Pattern, Entries::iterator> entry_its;
+        };
+
+        Shard &get_shard(const Pattern &read);
+
+        static constexpr uint64_t count_shards = 64;
+        uint64_t max_shard_count_reads;
+        std::vector<Shard> shards;
+    };
+
+}
+
+#endif //GRAMTOOLS_READ_CACHE_HPP
@@ -0,0 +1,67 @@
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "common/utils.hpp"
+
+
+#ifndef GRAMTOOLS_READ_SCHEDULER_HPP
+#define GRAMTOOLS_READ_SCHEDULER_HPP
+
+namespace gram {
+
+    using ReadsBuffer = std::vector<Pattern>;
+
+    // reads [first_buffer_index, last_buffer_index) of a buffer whose first read is
+    // read number first_read_index of the run
+    struct ReadsChunk {
+        std::shared_ptr<const ReadsBuffer> reads_buffer;
+        uint64_t first_buffer_index = 0;
+        uint64_t last_buffer_index = 0;
+        uint64_t first_read_index = 0;
+    };
+
+    // per thread deques of read chunks: a thread takes chunks from the front of its own
+    // deque, and once empty steals from the back of the others'
+    class ReadsChunkScheduler {
+    public:
+        explicit ReadsChunkScheduler(const uint64_t &count_threads);
+
+        // queues the buffer's chunks, spread round robin over the threads' deques
+        void push_buffer(const std::shared_ptr<const ReadsBuffer> &reads_buffer,
+                         const uint64_t &first_read_index);
+
+        bool pop(const uint64_t &thread_index, ReadsChunk &chunk);
+
+        uint64_t count_queued_chunks() const { return count_queued; }
+
+        // no more buffers will be pushed
+        void close();
+
+        bool closed() const { return reads_closed; }
+
+        // blocks until a chunk is queued or the scheduler is closed
+        void wait_for_chunks();
+
+        static constexpr uint64_t chunk_size = 32;
+
+    private:
+        struct ThreadQueue {
+            std::mutex mutex;
+            std::deque<ReadsChunk> chunks;
+        };
+
+        std::vector<ThreadQueue> queues;
+        std::atomic<uint64_t> count_queued;
+        std::atomic<bool> reads_closed;
+        std::mutex wait_mutex;
+        std::condition_variable chunks_queued;
+        uint64_t next_queue_index = 0;
+    };
+
+}
+
+#endif //GRAMTOOLS_READ_SCHEDULER_HPP
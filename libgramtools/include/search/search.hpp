@@ -1,5 +1,6 @@
 #include "common/utils.hpp"
 #include "kmer_index/kmer_index_types.hpp"
+#include "kmer_index/extended_seed_cache.hpp"
 #include "search_types.hpp"
 
 
@@ -19,6 +20,85 @@ namespace gram {
                                        const KmerIndex &kmer_index,
                                        const PRG_Info &prg_info);
 
+    SearchStates search_read_backwards(const Pattern &read,
+                                       const Pattern &kmer,
+                                       const KmerIndex &kmer_index,
+                                       const PRG_Info &prg_info,
+                                       const SearchBudget &search_budget,
+                                       SearchBudgetLimit &exceeded_limit);
+
+    SearchStates search_read_backwards(const Pattern &read,
+                                       const Pattern &kmer,
+                                       const KmerIndex &kmer_index,
+                                       const PRG_Info &prg_info,
+                                       const SearchBudget &search_budget,
+                                       ExtendedSeedCache &seed_cache,
+                                       SearchBudgetLimit &exceeded_limit);
+
+    // kmer is the read's seed kmer packed, see pack_read_kmer
+    SearchStates search_read_backwards(const Pattern &read,
+                                       const PackedKmer &kmer,
+                                       const uint32_t &kmer_size,
+                                       const KmerIndex &kmer_index,
+                                       const PRG_Info &prg_info,
+                                       const SearchBudget &search_budget,
+                                       ExtendedSeedCache &seed_cache,
+                                       SearchBudgetLimit &exceeded_limit);
+
+    // true if every occurrence of the read's seed kmer is far enough from variant sites and
+    // markers that the rest of the read, if it maps there, cannot reach one
+    bool read_reaches_no_site(const Pattern &read,
+                              const Pattern &kmer,
+                              const KmerIndex &kmer_index,
+                              const PRG_Info &prg_info);
+
+    bool read_reaches_no_site(const Pattern &read,
+                              const PackedKmer &kmer,
+                              const uint32_t &kmer_size,
+                              const KmerIndex &kmer_index,
+                              const PRG_Info &prg_info);
+
+    SearchStates search_invariant_read_backwards(const Pattern &read,
+                                                 const Pattern &kmer,
+                                                 const KmerIndex &kmer_index,
+                                                 const PRG_Info &prg_info,
+                                                 const SearchBudget &search_budget,
+                                                 SearchBudgetLimit &exceeded_limit);
+
+    SearchStates search_invariant_read_backwards(const Pattern &read,
+                                                 const PackedKmer &kmer,
+                                                 const uint32_t &kmer_size,
+                                                 const KmerIndex &kmer_index,
+                                                 const PRG_Info &prg_info,
+                                                 const SearchBudget &search_budget,
+                                                 SearchBudgetLimit &exceeded_limit);
+
+    SearchStates search_shared_suffix_backwards(const Pattern &read,
+                                                const uint64_t &count_shared_bases,
+                                                const uint32_t &kmer_size,
+                                                const KmerIndex &kmer_index,
+                                                const PRG_Info &prg_info,
+                                                const SearchBudget &search_budget,
+                                                SuffixSearchStack &search_stack,
+                                                SearchBudgetLimit &exceeded_limit);
+
+    uint64_t count_left_markers(const SearchStates &search_states,
+                                const PRG_Info &prg_info);
+
+    // checked before each read base: the search states count and marker crossings so far
+    SearchBudgetLimit check_search_budget(const SearchStates &search_states,
+                                          const uint64_t &marker_crossings,
+                                          const SearchBudget &search_budget);
+
+    // checked once the read is searched, also against the SA interval width limit: extending
+    // a state only narrows its interval, so a wide seed interval is not held against the read
+    SearchBudgetLimit check_final_search_budget(const SearchStates &search_states,
+                                                const uint64_t &marker_crossings,
+                                                const SearchBudget &search_budget);
+
+    SearchBudgetLimit check_extended_seed_budget(const ExtendedSeed &extended_seed,
+                                                 const SearchBudget &search_budget);
+
     SearchStates search_base_backwards(const Base &pattern_char,
                                        const SearchStates &search_states,
                                        const PRG_Info &prg_info);
@@ -5,7 +5,7 @@
 #define GRAMTOOLS_SEARCH_TYPES_HPP
 
 namespace gram {
-    enum class SearchVariantSiteState {
+    enum class SearchVariantSiteState : uint8_t {
         within_variant_site,
         outside_variant_site,
         unknown
@@ -30,7 +30,34 @@ namespace gram {
         };
     };
 
+#ifndef GRAMTOOLS_WIDE_VARIANT_IDS
+    static_assert(sizeof(SearchState) <= 64, "search state should fit in a cache line");
+#endif
+
     using SearchStates = std::list<SearchState>;
+
+    // per read search limits, zero means unlimited
+    struct SearchBudget {
+        uint64_t max_search_states = 0;
+        uint64_t max_sa_interval_width = 0;
+        uint64_t max_marker_crossings = 0;
+    };
+
+    enum class SearchBudgetLimit : uint8_t {
+        none,
+        search_states,
+        sa_interval_width,
+        marker_crossings
+    };
+
+    // search states after a kmer and each following read base, shared by reads with
+    // a common suffix; marker crossings are those counted before reaching the level
+    struct SuffixSearchLevel {
+        SearchStates search_states = {};
+        uint64_t marker_crossings = 0;
+    };
+
+    using SuffixSearchStack = std::vector<SuffixSearchLevel>;
 }
 
 #endif //GRAMTOOLS_SEARCH_TYPES_HPP
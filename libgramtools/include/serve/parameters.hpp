@@ -0,0 +1,19 @@
+#include <boost/program_options/variables_map.hpp>
+#include <boost/program_options/parsers.hpp>
+#include <boost/variant/variant.hpp>
+#include <boost/variant/get.hpp>
+
+#include "common/parameters.hpp"
+
+
+namespace po = boost::program_options;
+
+
+#ifndef GRAMTOOLS_SERVE_PARAMETERS_HPP
+#define GRAMTOOLS_SERVE_PARAMETERS_HPP
+
+namespace gram::commands::serve {
+    Parameters parse_parameters(po::variables_map &vm, const po::parsed_options &parsed);
+}
+
+#endif //GRAMTOOLS_SERVE_PARAMETERS_HPP
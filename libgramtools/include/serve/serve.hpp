@@ -0,0 +1,74 @@
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "common/parameters.hpp"
+
+
+#ifndef GRAMTOOLS_SERVE_HPP
+#define GRAMTOOLS_SERVE_HPP
+
+namespace gram {
+
+    // one request line per connection, tab separated:
+    //   quasimap <run directory> <reads file> [<reads file> ...]
+    //   shutdown
+    struct ServeJob {
+        std::string run_dirpath;
+        std::vector<std::string> reads_fpaths;
+        bool shutdown = false;
+        bool valid = false;
+    };
+
+    ServeJob parse_serve_request(const std::string &request);
+
+    struct QueuedServeJob {
+        int client_fd = -1;
+        ServeJob job;
+    };
+
+    // accepted jobs waiting for a free job slot
+    class ServeJobQueue {
+    public:
+        void push(QueuedServeJob queued_job);
+
+        // blocks until a job is queued; false once closed and drained
+        bool pop(QueuedServeJob &queued_job);
+
+        void close();
+
+        uint64_t size();
+
+    private:
+        std::mutex mutex;
+        std::condition_variable job_queued;
+        std::deque<QueuedServeJob> queued_jobs;
+        bool closed = false;
+    };
+
+    // the server's threads, shared by running jobs: a starting job takes its share of the
+    // threads free at that moment, so a lone job on an idle server uses all of them
+    class ServeThreads {
+    public:
+        explicit ServeThreads(const uint32_t &count_threads) : count_free(count_threads) {}
+
+        // blocks until a thread is free; count_waiting_jobs includes the caller's job
+        uint32_t acquire(const uint64_t &count_waiting_jobs);
+
+        void release(const uint32_t &count_threads);
+
+    private:
+        std::mutex mutex;
+        std::condition_variable thread_released;
+        uint32_t count_free;
+    };
+
+    namespace commands::serve {
+        void run(const Parameters &parameters);
+    }
+
+}
+
+#endif //GRAMTOOLS_SERVE_HPP
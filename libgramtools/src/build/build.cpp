@@ -2,6 +2,7 @@
 #include "common/timer_report.hpp"
 
 #include "prg/prg.hpp"
+#include "prg/strand_symmetric.hpp"
 #include "prg/masks.hpp"
 
 #include "kmer_index/build.hpp"
@@ -16,12 +17,20 @@ using namespace gram;
 void commands::build::run(const Parameters &parameters) {
     std::cout << "Executing build command" << std::endl;
     auto timer = TimerReport();
+    exit_if_kmer_size_unpackable(parameters.kmers_size);
 
     PRG_Info prg_info;
 
     std::cout << "Generating integer encoded PRG" << std::endl;
     timer.start("Encoded PRG");
     prg_info.encoded_prg = generate_encoded_prg(parameters);
+    if (parameters.strand_symmetric_flag)
+        prg_info.strand_count_sites = count_variant_sites(prg_info.encoded_prg);
+    // without variant sites the build exits below, there is no reverse complement to add
+    if (prg_info.strand_count_sites != 0) {
+        prg_info.encoded_prg = generate_strand_symmetric_prg(prg_info.encoded_prg);
+        sdsl::store_to_file(prg_info.encoded_prg, parameters.encoded_prg_fpath);
+    }
     timer.stop();
     std::cout << "Number of charecters in integer encoded linear PRG: "
               << prg_info.encoded_prg.size()
@@ -33,6 +42,7 @@ void commands::build::run(const Parameters &parameters) {
         std::cout << "No variant sites found.\nExiting 1" << std::endl;
         std::exit(1);
     }
+    exit_if_markers_exceed_variant_ids(prg_info.max_alphabet_num);
 
     std::cout << "Generating FM-Index" << std::endl;
     timer.start("Generate FM-Index");
@@ -49,15 +59,38 @@ void commands::build::run(const Parameters &parameters) {
     prg_info.allele_mask = generate_allele_mask(prg_info.encoded_prg);
     sdsl::store_to_file(prg_info.allele_mask, parameters.allele_mask_fpath);
 
-    prg_info.prg_markers_mask = generate_prg_markers_mask(prg_info.encoded_prg);
+    prg_info.site_table = generate_site_table(prg_info.encoded_prg, prg_info.fm_index);
+    sdsl::store_to_file(prg_info.site_table, parameters.site_table_fpath);
+
+    prg_info.sa_allele_runs = generate_sa_allele_runs(prg_info.fm_index,
+                                                      prg_info.sites_mask,
+                                                      prg_info.allele_mask);
+    sdsl::store_to_file(prg_info.sa_allele_runs, parameters.sa_allele_runs_fpath);
+    prg_info.sa_allele_runs_rank = sdsl::rank_support_v<1>(&prg_info.sa_allele_runs.run_starts_mask);
+    prg_info.sa_allele_runs_select = sdsl::select_support_mcl<1>(&prg_info.sa_allele_runs.run_starts_mask);
+
+    prg_info.kmer_presence = generate_kmer_presence(prg_info.encoded_prg, presence_kmer_size);
+    sdsl::store_to_file(prg_info.kmer_presence, parameters.kmer_presence_fpath);
+
+    prg_info.invariant_reach = generate_invariant_reach(prg_info.fm_index,
+                                                        prg_info.encoded_prg,
+                                                        prg_info.sites_mask,
+                                                        parameters.kmers_size);
+    sdsl::store_to_file(prg_info.invariant_reach, parameters.invariant_reach_fpath);
+
+    prg_info.prg_markers_mask = generate_prg_markers_mask(prg_info.encoded_prg,
+                                                          strand_separator(prg_info.strand_count_sites));
     prg_info.prg_markers_rank = sdsl::rank_support_v<1>(&prg_info.prg_markers_mask);
     prg_info.prg_markers_select = sdsl::select_support_mcl<1>(&prg_info.prg_markers_mask);
 
-    prg_info.bwt_markers_mask = generate_bwt_markers_mask(prg_info.fm_index);
+    prg_info.bwt_markers_mask = generate_bwt_markers_mask(prg_info.fm_index,
+                                                          strand_separator(prg_info.strand_count_sites));
     prg_info.bwt_markers_rank = sdsl::rank_support_v<1>(&prg_info.bwt_markers_mask);
     prg_info.bwt_markers_select = sdsl::select_support_mcl<1>(&prg_info.bwt_markers_mask);
     prg_info.markers_mask_count_set_bits =
             prg_info.bwt_markers_rank(prg_info.bwt_markers_mask.size());
+    prg_info.bwt_markers = generate_bwt_markers(prg_info.fm_index, prg_info.bwt_markers_mask);
+    sdsl::store_to_file(prg_info.bwt_markers, parameters.bwt_markers_fpath);
 
     prg_info.dna_bwt_masks = load_dna_bwt_masks(prg_info.fm_index, parameters);
     prg_info.rank_bwt_a = sdsl::rank_support_v<1>(&prg_info.dna_bwt_masks.mask_a);
@@ -24,7 +24,9 @@ Parameters commands::build::parse_parameters(po::variables_map &vm, const po::pa
                              ("max-threads", po::value<uint32_t>()->default_value(1),
                               "maximum number of threads used")
                              ("all-kmers", po::bool_switch()->default_value(false),
-                              "generate all kmers of given size (as opposed to inspecting PRG for min set)");
+                              "generate all kmers of given size (as opposed to inspecting PRG for min set)")
+                             ("strand-symmetric", po::bool_switch()->default_value(false),
+                              "index the PRG with its reverse complement, so quasimap searches each read once");
 
     std::vector<std::string> opts = po::collect_unrecognized(parsed.options,
                                                              po::include_positional);
@@ -41,6 +43,11 @@ Parameters commands::build::parse_parameters(po::variables_map &vm, const po::pa
     parameters.fm_index_fpath = full_path(gram_dirpath, "fm_index");
     parameters.sites_mask_fpath = full_path(gram_dirpath, "variant_site_mask");
     parameters.allele_mask_fpath = full_path(gram_dirpath, "allele_mask");
+    parameters.site_table_fpath = full_path(gram_dirpath, "site_table");
+    parameters.sa_allele_runs_fpath = full_path(gram_dirpath, "sa_allele_runs");
+    parameters.bwt_markers_fpath = full_path(gram_dirpath, "bwt_markers");
+    parameters.kmer_presence_fpath = full_path(gram_dirpath, "kmer_presence");
+    parameters.invariant_reach_fpath = full_path(gram_dirpath, "invariant_reach");
     parameters.sdsl_memory_log_fpath = full_path(gram_dirpath, "sdsl_memory_log");
 
     parameters.kmer_index_fpath = full_path(gram_dirpath, "kmer_index");
@@ -52,6 +59,7 @@ Parameters commands::build::parse_parameters(po::variables_map &vm, const po::pa
     parameters.kmers_size = vm["kmer-size"].as<uint32_t>();
     parameters.max_read_size = vm["max-read-size"].as<uint32_t>();
     parameters.all_kmers_flag = vm["all-kmers"].as<bool>();
+    parameters.strand_symmetric_flag = vm["strand-symmetric"].as<bool>();
     
     parameters.maximum_threads = vm["max-threads"].as<uint32_t>();
     return parameters;
@@ -0,0 +1,153 @@
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <system_error>
+
+#include <sdsl/memory_management.hpp>
+
+#ifdef __linux__
+#include <cstring>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+#include "common/huge_pages.hpp"
+
+
+using namespace gram;
+
+
+bool huge_pages::use_reserved_pages() {
+    try {
+        // sizes the pool from the free huge pages listed in /proc/meminfo
+        sdsl::memory_manager::use_hugepages();
+    } catch (const std::system_error &) {
+        return false;
+    }
+    return true;
+}
+
+
+struct Mapping {
+    huge_pages::MemoryRange range;
+    std::string perms;
+    bool anonymous;
+};
+
+
+std::vector<Mapping> read_mappings() {
+    std::vector<Mapping> mappings;
+    std::ifstream maps("/proc/self/maps");
+    std::string line;
+    while (std::getline(maps, line)) {
+        // start-end perms offset dev inode [path]
+        std::stringstream fields(line);
+        std::string range, perms, offset, device, path;
+        uint64_t inode = 0;
+        fields >> range >> perms >> offset >> device >> inode;
+        fields >> path;
+
+        auto dash = range.find('-');
+        Mapping mapping = {};
+        mapping.range.first = std::stoull(range.substr(0, dash), nullptr, 16);
+        mapping.range.second = std::stoull(range.substr(dash + 1), nullptr, 16);
+        mapping.perms = perms;
+        mapping.anonymous = inode == 0 and (path.empty() or path == "[heap]");
+        mappings.push_back(mapping);
+    }
+    return mappings;
+}
+
+
+huge_pages::MemoryRanges huge_pages::anonymous_mappings() {
+    MemoryRanges ranges;
+    for (const auto &mapping: read_mappings()) {
+        if (mapping.anonymous and mapping.perms == "rw-p")
+            ranges.push_back(mapping.range);
+    }
+    return ranges;
+}
+
+
+huge_pages::MemoryRanges huge_pages::subtract_ranges(const MemoryRange &range, const MemoryRanges &ranges) {
+    MemoryRanges remaining;
+    uint64_t start = range.first;
+    for (const auto &other: ranges) {
+        if (other.second <= start)
+            continue;
+        if (other.first >= range.second)
+            break;
+        if (other.first > start)
+            remaining.emplace_back(start, other.first);
+        start = std::max(start, other.second);
+    }
+    if (start < range.second)
+        remaining.emplace_back(start, range.second);
+    return remaining;
+}
+
+
+uint64_t huge_pages::advise_transparent_pages(const MemoryRanges &mappings_before) {
+    uint64_t count_advised_bytes = 0;
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+    Mapping previous = {};
+    for (const auto &mapping: read_mappings()) {
+        // a thread stack sits right above its inaccessible guard page
+        bool thread_stack = previous.anonymous and previous.perms == "---p"
+                            and previous.range.second == mapping.range.first;
+        previous = mapping;
+        if (not mapping.anonymous or mapping.perms != "rw-p" or thread_stack)
+            continue;
+
+        for (const auto &range: subtract_ranges(mapping.range, mappings_before)) {
+            // only whole huge pages within the range
+            uint64_t aligned_start = (range.first + huge_page_size - 1) / huge_page_size * huge_page_size;
+            uint64_t aligned_end = range.second / huge_page_size * huge_page_size;
+            if (aligned_end <= aligned_start)
+                continue;
+            auto length = aligned_end - aligned_start;
+            if (madvise(reinterpret_cast<void *>(aligned_start), length, MADV_HUGEPAGE) == 0)
+                count_advised_bytes += length;
+        }
+    }
+#endif
+    return count_advised_bytes;
+}
+
+
+TlbMissCounter::TlbMissCounter() {
+#ifdef __linux__
+    perf_event_attr attributes;
+    std::memset(&attributes, 0, sizeof(attributes));
+    attributes.type = PERF_TYPE_HW_CACHE;
+    attributes.size = sizeof(attributes);
+    attributes.config = PERF_COUNT_HW_CACHE_DTLB
+                        | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+                        | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    attributes.exclude_kernel = 1;
+    attributes.exclude_hv = 1;
+    // this thread, on any CPU
+    fd = (int) syscall(SYS_perf_event_open, &attributes, 0, -1, -1, 0);
+#endif
+}
+
+
+TlbMissCounter::~TlbMissCounter() {
+#ifdef __linux__
+    if (fd >= 0)
+        close(fd);
+#endif
+}
+
+
+uint64_t TlbMissCounter::count_misses() const {
+    uint64_t count_misses = 0;
+#ifdef __linux__
+    if (fd >= 0 and read(fd, &count_misses, sizeof(count_misses)) != sizeof(count_misses))
+        count_misses = 0;
+#endif
+    return count_misses;
+}
@@ -0,0 +1,166 @@
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+#ifdef __linux__
+#include <sched.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#endif
+
+#include "common/numa.hpp"
+
+
+using namespace gram;
+
+
+// set_mempolicy modes, from linux/mempolicy.h (libnuma's numaif.h is not required)
+constexpr int mpol_default = 0;
+constexpr int mpol_interleave = 3;
+
+const std::string nodes_dirpath = "/sys/devices/system/node/";
+
+
+std::string read_sysfs_line(const std::string &fpath) {
+    std::ifstream file(fpath);
+    std::string line;
+    if (file)
+        std::getline(file, line);
+    return line;
+}
+
+
+numa::CPUs numa::parse_cpu_list(const std::string &cpu_list) {
+    CPUs cpus;
+    std::stringstream stream(cpu_list);
+    std::string range;
+    while (std::getline(stream, range, ',')) {
+        if (range.empty() or range.find_first_not_of(" \n") == std::string::npos)
+            continue;
+        auto dash = range.find('-');
+        uint64_t first = std::stoull(range.substr(0, dash));
+        uint64_t last = first;
+        if (dash != std::string::npos)
+            last = std::stoull(range.substr(dash + 1));
+        for (uint64_t cpu = first; cpu <= last; ++cpu)
+            cpus.push_back(cpu);
+    }
+    return cpus;
+}
+
+
+std::vector<uint64_t> numa::node_ids() {
+    // "online" lists node ids in the same format as CPU lists
+    return parse_cpu_list(read_sysfs_line(nodes_dirpath + "online"));
+}
+
+
+std::vector<numa::CPUs> numa::node_cpus() {
+    std::vector<CPUs> nodes;
+    for (const auto &node_id: node_ids()) {
+        auto cpu_list = read_sysfs_line(nodes_dirpath + "node" + std::to_string(node_id) + "/cpulist");
+        auto cpus = parse_cpu_list(cpu_list);
+        if (not cpus.empty())
+            nodes.emplace_back(cpus);
+    }
+    return nodes;
+}
+
+
+bool numa::pin_thread(const CPUs &cpus) {
+#ifdef __linux__
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    for (const auto &cpu: cpus) {
+        if (cpu < CPU_SETSIZE)
+            CPU_SET(cpu, &cpu_set);
+    }
+    return sched_setaffinity(0, sizeof(cpu_set), &cpu_set) == 0;
+#else
+    return false;
+#endif
+}
+
+
+numa::CPUs numa::thread_cpus() {
+    CPUs cpus;
+#ifdef __linux__
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    if (sched_getaffinity(0, sizeof(cpu_set), &cpu_set) != 0)
+        return cpus;
+    for (uint64_t cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+        if (CPU_ISSET(cpu, &cpu_set))
+            cpus.push_back(cpu);
+    }
+#endif
+    return cpus;
+}
+
+
+void numa::run_on_nodes(const std::vector<CPUs> &nodes_cpus,
+                        const uint64_t &first_node,
+                        const std::function<void(const uint64_t &)> &task) {
+    std::vector<std::thread> node_threads;
+    for (uint64_t node = first_node; node < nodes_cpus.size(); ++node) {
+        node_threads.emplace_back([&nodes_cpus, &task, node]() {
+            pin_thread(nodes_cpus[node]);
+            task(node);
+        });
+    }
+    for (auto &node_thread: node_threads)
+        node_thread.join();
+}
+
+
+bool numa::interleave_allocations(const std::vector<uint64_t> &node_ids) {
+    const uint64_t mask_bits = 8 * sizeof(unsigned long);
+    MemoryPolicy memory_policy = {};
+    memory_policy.mode = mpol_interleave;
+    memory_policy.nodes_mask.resize(1, 0);
+    for (const auto &node_id: node_ids) {
+        if (node_id / mask_bits >= memory_policy.nodes_mask.size())
+            memory_policy.nodes_mask.resize(node_id / mask_bits + 1, 0);
+        memory_policy.nodes_mask[node_id / mask_bits] |= 1UL << (node_id % mask_bits);
+    }
+    return apply_policy(memory_policy);
+}
+
+
+void numa::default_allocations() {
+    apply_policy(MemoryPolicy{});
+}
+
+
+numa::MemoryPolicy numa::current_policy() {
+    MemoryPolicy memory_policy = {};
+#ifdef __linux__
+    // room for the largest node count the kernel can be configured with
+    const uint64_t max_count_nodes = 1024;
+    std::vector<unsigned long> nodes_mask(max_count_nodes / (8 * sizeof(unsigned long)), 0);
+    int mode = mpol_default;
+    if (syscall(SYS_get_mempolicy, &mode, nodes_mask.data(), max_count_nodes, nullptr, 0) != 0)
+        return memory_policy;
+    memory_policy.mode = mode;
+    // local and default modes take no nodes
+    bool any_node = std::any_of(nodes_mask.begin(), nodes_mask.end(),
+                                [](const unsigned long &word) { return word != 0; });
+    if (any_node)
+        memory_policy.nodes_mask = nodes_mask;
+#endif
+    return memory_policy;
+}
+
+
+bool numa::apply_policy(const MemoryPolicy &memory_policy) {
+#ifdef __linux__
+    if (memory_policy.nodes_mask.empty())
+        return syscall(SYS_set_mempolicy, memory_policy.mode, nullptr, 0) == 0;
+    // the kernel reads max node - 1 bits
+    unsigned long max_node = memory_policy.nodes_mask.size() * 8 * sizeof(unsigned long) + 1;
+    return syscall(SYS_set_mempolicy, memory_policy.mode, memory_policy.nodes_mask.data(), max_node) == 0;
+#else
+    return false;
+#endif
+}
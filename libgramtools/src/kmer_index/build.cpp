@@ -122,6 +122,16 @@ void update_full_kmer(Pattern &full_kmer,
 }
 
 
+void gram::exit_if_kmer_size_unpackable(const uint32_t &kmers_size) {
+    if (kmers_size <= max_packed_kmer_size)
+        return;
+    std::cout << "Kmer size " << kmers_size
+              << " exceeds the maximum kmer size of " << max_packed_kmer_size
+              << ".\nExiting 1" << std::endl;
+    std::exit(1);
+}
+
+
 KmerIndex gram::index_kmers(const Patterns &kmer_prefix_diffs,
                             const int kmer_size,
                             const PRG_Info &prg_info) {
@@ -153,7 +163,7 @@ KmerIndex gram::index_kmers(const Patterns &kmer_prefix_diffs,
 
         const auto &last_cache_element = cache.back();
         if (not last_cache_element.search_states.empty())
-            kmer_index[full_kmer] = last_cache_element.search_states;
+            kmer_index[pack_kmer(full_kmer)] = last_cache_element.search_states;
     }
     return kmer_index;
 }
@@ -0,0 +1,205 @@
+#include <algorithm>
+#include <tuple>
+#include <unordered_map>
+
+#include "kmer_index/compressed_paths.hpp"
+
+
+using namespace gram;
+
+
+uint64_t CompressedPaths::serialize(std::ostream &out,
+                                    sdsl::structure_tree_node *v,
+                                    std::string name) const {
+    auto child = sdsl::structure_tree::add_child(v, name, sdsl::util::class_name(*this));
+    uint64_t written_bytes = 0;
+    written_bytes += kmer_path_list_ids.serialize(out, child, "kmer_path_list_ids");
+    written_bytes += path_list_starts.serialize(out, child, "path_list_starts");
+    written_bytes += first_markers.serialize(out, child, "first_markers");
+    written_bytes += marker_deltas.serialize(out, child, "marker_deltas");
+    written_bytes += allele_ids.serialize(out, child, "allele_ids");
+    sdsl::structure_tree::add_size(child, written_bytes);
+    return written_bytes;
+}
+
+
+void CompressedPaths::load(std::istream &in) {
+    kmer_path_list_ids.load(in);
+    path_list_starts.load(in);
+    first_markers.load(in);
+    marker_deltas.load(in);
+    allele_ids.load(in);
+}
+
+
+uint64_t zigzag_encode(const int64_t &value) {
+    return ((uint64_t) value << 1) ^ (uint64_t) (value >> 63);
+}
+
+
+int64_t zigzag_decode(const uint64_t &value) {
+    return (int64_t) (value >> 1) ^ -(int64_t) (value & 1);
+}
+
+
+uint64_t hash_path_elements(const sdsl::int_vector<> &paths,
+                            const uint64_t &first_element,
+                            const uint64_t &end_element) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (uint64_t i = first_element * 2; i < end_element * 2; ++i) {
+        hash ^= paths[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash ^ (end_element - first_element);
+}
+
+
+bool path_elements_equal(const sdsl::int_vector<> &paths,
+                         const std::pair<uint64_t, uint64_t> &lhs,
+                         const std::pair<uint64_t, uint64_t> &rhs) {
+    if (lhs.second - lhs.first != rhs.second - rhs.first)
+        return false;
+    return std::equal(paths.begin() + lhs.first * 2,
+                      paths.begin() + lhs.second * 2,
+                      paths.begin() + rhs.first * 2);
+}
+
+
+// assigns each kmer the ID of the first path list with identical path elements,
+// returns each distinct path list's (first, end) path element range in ID order
+std::vector<std::pair<uint64_t, uint64_t>> intern_path_lists(sdsl::int_vector<> &kmer_path_list_ids,
+                                                             const sdsl::int_vector<> &paths,
+                                                             const std::vector<uint64_t> &kmer_paths_offsets) {
+    const uint64_t count_kmers = kmer_paths_offsets.size() - 1;
+    std::vector<uint64_t> hashes(count_kmers);
+
+    #pragma omp parallel for schedule(dynamic, 1024)
+    for (uint64_t kmer_number = 0; kmer_number < count_kmers; ++kmer_number)
+        hashes[kmer_number] = hash_path_elements(paths,
+                                                 kmer_paths_offsets[kmer_number] / 2,
+                                                 kmer_paths_offsets[kmer_number + 1] / 2);
+
+    std::vector<std::pair<uint64_t, uint64_t>> path_lists;
+    std::unordered_map<uint64_t, std::vector<uint64_t>> path_list_ids_by_hash;
+    for (uint64_t kmer_number = 0; kmer_number < count_kmers; ++kmer_number) {
+        auto range = std::make_pair(kmer_paths_offsets[kmer_number] / 2,
+                                    kmer_paths_offsets[kmer_number + 1] / 2);
+        auto &candidate_ids = path_list_ids_by_hash[hashes[kmer_number]];
+
+        auto found_id = std::find_if(candidate_ids.begin(), candidate_ids.end(),
+                                     [&](const uint64_t &id) {
+                                         return path_elements_equal(paths, path_lists[id], range);
+                                     });
+        if (found_id != candidate_ids.end()) {
+            kmer_path_list_ids[kmer_number] = *found_id;
+            continue;
+        }
+
+        kmer_path_list_ids[kmer_number] = path_lists.size();
+        candidate_ids.push_back(path_lists.size());
+        path_lists.push_back(range);
+    }
+    return path_lists;
+}
+
+
+CompressedPaths gram::compress_paths(const sdsl::int_vector<> &paths,
+                                     const std::vector<uint64_t> &kmer_paths_offsets) {
+    assert(not kmer_paths_offsets.empty());
+    const uint64_t count_kmers = kmer_paths_offsets.size() - 1;
+
+    CompressedPaths compressed_paths = {};
+    compressed_paths.kmer_path_list_ids = sdsl::int_vector<>(count_kmers, 0, 64);
+    const auto path_lists = intern_path_lists(compressed_paths.kmer_path_list_ids,
+                                              paths,
+                                              kmer_paths_offsets);
+    const uint64_t count_path_lists = path_lists.size();
+
+    // prefix sum of distinct path list sizes
+    std::vector<uint64_t> path_list_offsets(count_path_lists + 1, 0);
+    for (uint64_t id = 0; id < count_path_lists; ++id)
+        path_list_offsets[id + 1] = path_list_offsets[id]
+                                    + path_lists[id].second - path_lists[id].first;
+    const uint64_t count_path_elements = path_list_offsets.back();
+
+    compressed_paths.first_markers = sdsl::int_vector<>(count_path_lists, 0, 64);
+    compressed_paths.marker_deltas = sdsl::int_vector<>(count_path_elements, 0, 64);
+    compressed_paths.allele_ids = sdsl::int_vector<>(count_path_elements, 0, 64);
+
+    // path list start positions are made strictly increasing (as required by sd_vector)
+    // by offsetting each list's first path element index with the list's ID
+    std::vector<uint64_t> path_list_starts(count_path_lists + 1);
+
+    #pragma omp parallel for schedule(dynamic, 1024)
+    for (uint64_t id = 0; id < count_path_lists; ++id) {
+        path_list_starts[id] = path_list_offsets[id] + id;
+
+        const auto &range = path_lists[id];
+        if (range.first == range.second)
+            continue;
+
+        Marker last_marker = paths[range.first * 2];
+        compressed_paths.first_markers[id] = last_marker;
+
+        uint64_t compressed_index = path_list_offsets[id];
+        for (uint64_t i = range.first; i < range.second; ++i) {
+            Marker marker = paths[i * 2];
+            AlleleId allele_id = paths[i * 2 + 1];
+
+            auto marker_delta = (int64_t) marker - (int64_t) last_marker;
+            compressed_paths.marker_deltas[compressed_index] = zigzag_encode(marker_delta);
+            compressed_paths.allele_ids[compressed_index] = allele_id;
+            ++compressed_index;
+            last_marker = marker;
+        }
+    }
+    path_list_starts[count_path_lists] = count_path_elements + count_path_lists;
+
+    compressed_paths.path_list_starts = sdsl::sd_vector<>(path_list_starts.begin(),
+                                                          path_list_starts.end());
+    sdsl::util::bit_compress(compressed_paths.kmer_path_list_ids);
+    sdsl::util::bit_compress(compressed_paths.first_markers);
+    sdsl::util::bit_compress(compressed_paths.marker_deltas);
+    sdsl::util::bit_compress(compressed_paths.allele_ids);
+    return compressed_paths;
+}
+
+
+uint64_t gram::count_compressed_kmers(const CompressedPaths &compressed_paths) {
+    return compressed_paths.kmer_path_list_ids.size();
+}
+
+
+uint64_t gram::count_distinct_path_lists(const CompressedPaths &compressed_paths) {
+    return compressed_paths.first_markers.size();
+}
+
+
+std::pair<uint64_t, uint64_t> gram::kmer_path_elements_range(const uint64_t &kmer_number,
+                                                             const CompressedPaths &compressed_paths) {
+    assert(kmer_number < count_compressed_kmers(compressed_paths));
+    const uint64_t id = compressed_paths.kmer_path_list_ids[kmer_number];
+    sdsl::sd_vector<>::select_1_type select_path_list_start(&compressed_paths.path_list_starts);
+    auto first_element = select_path_list_start(id + 1) - id;
+    auto end_element = select_path_list_start(id + 2) - (id + 1);
+    return std::make_pair(first_element, end_element);
+}
+
+
+std::vector<VariantSite> gram::decompress_kmer_paths(const uint64_t &kmer_number,
+                                                     const CompressedPaths &compressed_paths) {
+    uint64_t first_element, end_element;
+    std::tie(first_element, end_element) = kmer_path_elements_range(kmer_number,
+                                                                    compressed_paths);
+    std::vector<VariantSite> path_elements;
+    path_elements.reserve(end_element - first_element);
+
+    const uint64_t id = compressed_paths.kmer_path_list_ids[kmer_number];
+    Marker marker = compressed_paths.first_markers[id];
+    for (uint64_t i = first_element; i < end_element; ++i) {
+        marker += zigzag_decode(compressed_paths.marker_deltas[i]);
+        AlleleId allele_id = compressed_paths.allele_ids[i];
+        path_elements.emplace_back(VariantSite{marker, allele_id});
+    }
+    return path_elements;
+}
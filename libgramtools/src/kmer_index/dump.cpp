@@ -26,111 +26,106 @@ KmerIndexStats gram::calculate_stats(const KmerIndex &kmer_index) {
 }
 
 
-sdsl::int_vector<3> gram::dump_kmers(const KmerIndex &kmer_index,
-                                     const Parameters &parameters) {
-    sdsl::int_vector<3> all_kmers(kmer_index.size() * parameters.kmers_size);
-    uint64_t i = 0;
+KmerIndexLayout gram::calculate_layout(const KmerIndex &kmer_index) {
+    KmerIndexLayout layout = {};
+    layout.entries.reserve(kmer_index.size());
+    layout.stats_offsets.reserve(kmer_index.size() + 1);
+    layout.sa_intervals_offsets.reserve(kmer_index.size() + 1);
+    layout.paths_offsets.reserve(kmer_index.size() + 1);
+
+    uint64_t stats_offset = 0;
+    uint64_t sa_intervals_offset = 0;
+    uint64_t paths_offset = 0;
 
     for (const auto &entry: kmer_index) {
-        const auto &kmer = entry.first;
-        for (const auto &base: kmer) {
-            assert(base >= 1 and base <= 4);
-            all_kmers[i++] = base;
-        }
+        layout.entries.push_back(&entry);
+        layout.stats_offsets.push_back(stats_offset);
+        layout.sa_intervals_offsets.push_back(sa_intervals_offset);
+        layout.paths_offsets.push_back(paths_offset);
+
+        // each kmer: number of search states, path length, path length...
+        const auto &search_states = entry.second;
+        stats_offset += search_states.size() + 1;
+        sa_intervals_offset += search_states.size() * 2;
+        for (const auto &search_state: search_states)
+            paths_offset += search_state.variant_site_path.size() * 2;
     }
 
-    store_to_file(all_kmers, parameters.kmers_fpath);
-    return all_kmers;
+    layout.stats_offsets.push_back(stats_offset);
+    layout.sa_intervals_offsets.push_back(sa_intervals_offset);
+    layout.paths_offsets.push_back(paths_offset);
+    return layout;
 }
 
 
-void gram::dump_kmers_stats(const KmerIndexStats &stats,
-                            const sdsl::int_vector<3> &all_kmers,
-                            const KmerIndex &kmer_index,
-                            const Parameters &parameters) {
-    // each kmer: number of search states, path length, path length...
-    const auto &count_distinct_paths = stats.count_search_states;
-    uint64_t count_memory_elements = stats.count_kmers + count_distinct_paths;
-    sdsl::int_vector<> kmers_stats(count_memory_elements, 0, 32);
-    uint64_t i = 0;
-
-    uint64_t kmer_start_index = 0;
-    while (kmer_start_index <= all_kmers.size() - parameters.kmers_size) {
-        auto kmer = deserialize_next_kmer(kmer_start_index,
-                                          all_kmers,
-                                          parameters.kmers_size);
-        kmer_start_index += kmer.size();
-
-        const auto &search_states = kmer_index.at(kmer);
-        kmers_stats[i++] = search_states.size();
-        for (const auto &search_state: search_states)
-            kmers_stats[i++] = search_state.variant_site_path.size();
+void serialize_entry(SerializedKmerIndex &serialized,
+                     sdsl::int_vector<> &paths,
+                     const uint64_t &entry_index,
+                     const KmerIndexLayout &layout,
+                     const uint32_t &kmers_size) {
+    const auto kmer = unpack_kmer(layout.entries[entry_index]->first, kmers_size);
+    const auto &search_states = layout.entries[entry_index]->second;
+
+    uint64_t kmers_index = entry_index * kmers_size;
+    for (const auto &base: kmer) {
+        assert(base >= 1 and base <= 4);
+        serialized.kmers[kmers_index++] = base;
     }
 
-    sdsl::util::bit_compress(kmers_stats);
-    store_to_file(kmers_stats, parameters.kmers_stats_fpath);
-}
+    uint64_t stats_index = layout.stats_offsets[entry_index];
+    uint64_t sa_intervals_index = layout.sa_intervals_offsets[entry_index];
+    uint64_t paths_index = layout.paths_offsets[entry_index];
+
+    serialized.kmers_stats[stats_index++] = search_states.size();
+    for (const auto &search_state: search_states) {
+        serialized.kmers_stats[stats_index++] = search_state.variant_site_path.size();
 
+        serialized.sa_intervals[sa_intervals_index++] = search_state.sa_interval.first;
+        serialized.sa_intervals[sa_intervals_index++] = search_state.sa_interval.second;
 
-void gram::dump_sa_intervals(const KmerIndexStats &stats,
-                             const sdsl::int_vector<3> &all_kmers,
-                             const KmerIndex &kmer_index,
-                             const Parameters &parameters) {
-    sdsl::int_vector<> sa_intervals(stats.count_search_states * 2, 0, 32);
-    uint64_t i = 0;
-
-    uint64_t kmer_start_index = 0;
-    while (kmer_start_index <= all_kmers.size() - parameters.kmers_size) {
-        auto kmer = deserialize_next_kmer(kmer_start_index,
-                                          all_kmers,
-                                          parameters.kmers_size);
-        kmer_start_index += kmer.size();
-
-        const auto &search_states = kmer_index.at(kmer);
-        for (const auto &search_state: search_states) {
-            sa_intervals[i++] = search_state.sa_interval.first;
-            sa_intervals[i++] = search_state.sa_interval.second;
+        for (const auto &path_element: search_state.variant_site_path) {
+            paths[paths_index++] = path_element.first;
+            paths[paths_index++] = path_element.second;
         }
     }
-
-    sdsl::util::bit_compress(sa_intervals);
-    store_to_file(sa_intervals, parameters.sa_intervals_fpath);
 }
 
 
-void gram::dump_paths(const KmerIndexStats &stats,
-                      const sdsl::int_vector<3> &all_kmers,
-                      const KmerIndex &kmer_index,
-                      const Parameters &parameters) {
-    sdsl::int_vector<> paths(stats.count_total_path_elements, 0, 32);
-    uint64_t i = 0;
-
-    uint64_t kmer_start_index = 0;
-    while (kmer_start_index <= all_kmers.size() - parameters.kmers_size) {
-        auto kmer = deserialize_next_kmer(kmer_start_index,
-                                          all_kmers,
-                                          parameters.kmers_size);
-        kmer_start_index += kmer.size();
-
-        const auto &search_states = kmer_index.at(kmer);
-        for (const auto &search_state: search_states) {
-            for (const auto &path_element: search_state.variant_site_path) {
-                paths[i++] = path_element.first;
-                paths[i++] = path_element.second;
-            }
-        }
+SerializedKmerIndex gram::serialize_kmer_index(const KmerIndex &kmer_index,
+                                               const Parameters &parameters) {
+    const auto layout = calculate_layout(kmer_index);
+    const uint64_t count_kmers = layout.entries.size();
+
+    // full width elements: threads never share a memory word while writing
+    SerializedKmerIndex serialized = {};
+    serialized.kmers = sdsl::int_vector<3>(count_kmers * parameters.kmers_size);
+    serialized.kmers_stats = sdsl::int_vector<>(layout.stats_offsets.back(), 0, 64);
+    serialized.sa_intervals = sdsl::int_vector<>(layout.sa_intervals_offsets.back(), 0, 64);
+    sdsl::int_vector<> paths(layout.paths_offsets.back(), 0, 64);
+
+    // blocks of 64 kmers with 3 bit bases always end on a word boundary
+    const uint64_t block_size = 64;
+    const uint64_t count_blocks = (count_kmers + block_size - 1) / block_size;
+
+    #pragma omp parallel for schedule(dynamic, 16)
+    for (uint64_t block = 0; block < count_blocks; ++block) {
+        const auto block_end = std::min((block + 1) * block_size, count_kmers);
+        for (uint64_t entry_index = block * block_size; entry_index < block_end; ++entry_index)
+            serialize_entry(serialized, paths, entry_index, layout, parameters.kmers_size);
     }
 
-    sdsl::util::bit_compress(paths);
-    store_to_file(paths, parameters.paths_fpath);
+    sdsl::util::bit_compress(serialized.kmers_stats);
+    sdsl::util::bit_compress(serialized.sa_intervals);
+    serialized.paths = compress_paths(paths, layout.paths_offsets);
+    return serialized;
 }
 
 
 void gram::kmer_index::dump(const KmerIndex &kmer_index,
                             const Parameters &parameters) {
-    sdsl::int_vector<3> all_kmers = dump_kmers(kmer_index, parameters);
-    auto stats = calculate_stats(kmer_index);
-    dump_kmers_stats(stats, all_kmers, kmer_index, parameters);
-    dump_sa_intervals(stats, all_kmers, kmer_index, parameters);
-    dump_paths(stats, all_kmers, kmer_index, parameters);
-}
\ No newline at end of file
+    const auto serialized = serialize_kmer_index(kmer_index, parameters);
+    sdsl::store_to_file(serialized.kmers, parameters.kmers_fpath);
+    sdsl::store_to_file(serialized.kmers_stats, parameters.kmers_stats_fpath);
+    sdsl::store_to_file(serialized.sa_intervals, parameters.sa_intervals_fpath);
+    sdsl::store_to_file(serialized.paths, parameters.paths_fpath);
+}
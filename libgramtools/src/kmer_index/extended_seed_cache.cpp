@@ -0,0 +1,316 @@
+#include <algorithm>
+
+#include <sdsl/util.hpp>
+
+#include "kmer_index/extended_seed_cache.hpp"
+
+
+using namespace gram;
+
+
+ExtendedSeedCache::ExtendedSeedCache(const uint64_t &max_count_seeds)
+        : max_shard_count_seeds((max_count_seeds + count_shards - 1) / count_shards),
+          shards(max_count_seeds == 0 ? 0 : count_shards) {}
+
+
+ExtendedSeedCache::Shard &ExtendedSeedCache::get_shard(const Pattern &kmer) {
+    auto kmer_hash = sequence_hash<Pattern>()(kmer);
+    return shards[kmer_hash % count_shards];
+}
+
+
+ExtendedSeedLookup ExtendedSeedCache::lookup(const Pattern &read,
+                                             const uint64_t &kmer_size,
+                                             ExtendedSeed &extended_seed) {
+    ExtendedSeedLookup seed_lookup = {};
+    if (not enabled() or read.size() < kmer_size)
+        return seed_lookup;
+
+    Pattern kmer(read.end() - kmer_size, read.end());
+    auto &shard = get_shard(kmer);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    auto found = shard.kmers.find(kmer);
+    if (found == shard.kmers.end()) {
+        bool counters_full = shard.kmers.size() >= max_shard_count_seeds * counters_per_seed;
+        if (not counters_full)
+            shard.kmers[kmer].count_lookups = 1;
+        return seed_lookup;
+    }
+
+    auto &hot_kmer = found->second;
+    ++hot_kmer.count_lookups;
+    seed_lookup.kmer_hot = hot_kmer.count_lookups >= hot_kmer_min_count_lookups;
+    if (not seed_lookup.kmer_hot)
+        return seed_lookup;
+
+    // longest cached suffix first
+    uint64_t read_extension_bases = (read.size() - kmer_size) / extension_step * extension_step;
+    uint64_t count_extension_bases = std::min(hot_kmer.max_extension_bases, read_extension_bases);
+    for (; count_extension_bases >= extension_step; count_extension_bases -= extension_step) {
+        Pattern suffix(read.end() - kmer_size - count_extension_bases, read.end());
+        auto seed_it = shard.seeds.find(suffix);
+        if (seed_it == shard.seeds.end() or not seed_it->second.cached)
+            continue;
+
+        extended_seed = seed_it->second.extended_seed;
+        seed_lookup.count_extension_bases = count_extension_bases;
+        return seed_lookup;
+    }
+    return seed_lookup;
+}
+
+
+void ExtendedSeedCache::cache_seed(Shard &shard,
+                                   const Pattern &kmer,
+                                   const Pattern &suffix,
+                                   const ExtendedSeed &extended_seed) {
+    auto &seed_entry = shard.seeds[suffix];
+    if (seed_entry.cached)
+        return;
+    seed_entry.cached = true;
+    seed_entry.extended_seed = extended_seed;
+    ++shard.count_cached_seeds;
+
+    auto &hot_kmer = shard.kmers[kmer];
+    hot_kmer.count_lookups = std::max(hot_kmer.count_lookups, hot_kmer_min_count_lookups);
+    hot_kmer.max_extension_bases = std::max<uint64_t>(hot_kmer.max_extension_bases,
+                                                      suffix.size() - kmer.size());
+}
+
+
+void ExtendedSeedCache::record(const Pattern &read,
+                               const uint64_t &kmer_size,
+                               const uint64_t &count_extension_bases,
+                               const ExtendedSeed &extended_seed) {
+    bool extension_cacheable = count_extension_bases % extension_step == 0
+                               and count_extension_bases != 0
+                               and count_extension_bases <= max_extension_bases
+                               and kmer_size + count_extension_bases <= read.size();
+    if (not enabled() or not extension_cacheable)
+        return;
+
+    Pattern kmer(read.end() - kmer_size, read.end());
+    Pattern suffix(read.end() - kmer_size - count_extension_bases, read.end());
+    auto &shard = get_shard(kmer);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    auto found = shard.seeds.find(suffix);
+    if (found == shard.seeds.end()) {
+        bool counters_full = shard.seeds.size() >= max_shard_count_seeds * counters_per_seed;
+        if (counters_full)
+            return;
+        found = shard.seeds.emplace(suffix, SeedEntry{}).first;
+    }
+
+    auto &seed_entry = found->second;
+    ++seed_entry.count_lookups;
+    bool seed_frequent = seed_entry.count_lookups >= seed_min_count_lookups;
+    bool shard_full = shard.count_cached_seeds >= max_shard_count_seeds;
+    if (seed_entry.cached or not seed_frequent or shard_full)
+        return;
+    cache_seed(shard, kmer, suffix, extended_seed);
+}
+
+
+uint64_t ExtendedSeedCache::count_seeds() {
+    uint64_t count_seeds = 0;
+    for (auto &shard: shards) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        count_seeds += shard.count_cached_seeds;
+    }
+    return count_seeds;
+}
+
+
+void push_search_state_values(std::vector<uint64_t> &values, const SearchState &search_state) {
+    values.push_back(search_state.sa_interval.first);
+    values.push_back(search_state.sa_interval.second);
+    values.push_back((uint64_t) search_state.variant_site_state);
+    values.push_back(search_state.cache_populated);
+    values.push_back(search_state.cached_variant_site.first);
+    values.push_back(search_state.cached_variant_site.second);
+
+    values.push_back(search_state.variant_site_path.size());
+    for (const auto &variant_site: search_state.variant_site_path) {
+        values.push_back(variant_site.first);
+        values.push_back(variant_site.second);
+    }
+}
+
+
+// header: kmer size, PRG size, PRG checksum; then for each seed: extension bases count,
+// suffix bases, marker crossings, max search states count, search states
+sdsl::int_vector<> ExtendedSeedCache::serialize(const uint64_t &kmer_size,
+                                                const uint64_t &prg_size,
+                                                const uint64_t &prg_checksum) {
+    std::vector<uint64_t> values = {kmer_size, prg_size, prg_checksum};
+    for (auto &shard: shards) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        for (const auto &entry: shard.seeds) {
+            const auto &suffix = entry.first;
+            const auto &seed_entry = entry.second;
+            if (not seed_entry.cached)
+                continue;
+
+            values.push_back(suffix.size() - kmer_size);
+            values.insert(values.end(), suffix.begin(), suffix.end());
+
+            const auto &extended_seed = seed_entry.extended_seed;
+            values.push_back(extended_seed.marker_crossings);
+            values.push_back(extended_seed.max_count_search_states);
+            values.push_back(extended_seed.search_states.size());
+            for (const auto &search_state: extended_seed.search_states)
+                push_search_state_values(values, search_state);
+        }
+    }
+
+    sdsl::int_vector<> serialized(values.size(), 0, 64);
+    for (uint64_t i = 0; i < values.size(); ++i)
+        serialized[i] = values[i];
+    sdsl::util::bit_compress(serialized);
+    return serialized;
+}
+
+
+// reads serialized values in order, failing instead of reading past the end
+class SerializedReader {
+public:
+    explicit SerializedReader(const sdsl::int_vector<> &serialized) : serialized(serialized) {}
+
+    bool next(uint64_t &value) {
+        if (i >= serialized.size())
+            return false;
+        value = serialized[i++];
+        return true;
+    }
+
+    bool done() const { return i >= serialized.size(); }
+
+private:
+    const sdsl::int_vector<> &serialized;
+    uint64_t i = 0;
+};
+
+
+bool parse_search_state_values(SearchState &search_state, SerializedReader &reader) {
+    uint64_t sa_interval_first, sa_interval_second, variant_site_state, cache_populated;
+    uint64_t cached_marker, cached_allele_id, path_size;
+    bool parsed = reader.next(sa_interval_first)
+                  and reader.next(sa_interval_second)
+                  and reader.next(variant_site_state)
+                  and reader.next(cache_populated)
+                  and reader.next(cached_marker)
+                  and reader.next(cached_allele_id)
+                  and reader.next(path_size);
+    if (not parsed)
+        return false;
+
+    search_state = {};
+    search_state.sa_interval.first = sa_interval_first;
+    search_state.sa_interval.second = sa_interval_second;
+    search_state.variant_site_state = (SearchVariantSiteState) variant_site_state;
+    search_state.cache_populated = cache_populated != 0;
+    search_state.cached_variant_site.first = cached_marker;
+    search_state.cached_variant_site.second = cached_allele_id;
+
+    for (uint64_t j = 0; j < path_size; ++j) {
+        uint64_t marker, allele_id;
+        if (not reader.next(marker) or not reader.next(allele_id))
+            return false;
+        search_state.variant_site_path.push_back(VariantSite{(Marker) marker, (AlleleId) allele_id});
+    }
+    return true;
+}
+
+
+bool parse_extended_seed(Pattern &suffix,
+                         ExtendedSeed &extended_seed,
+                         SerializedReader &reader,
+                         const uint64_t &kmer_size) {
+    uint64_t count_extension_bases;
+    if (not reader.next(count_extension_bases)
+        or count_extension_bases > ExtendedSeedCache::max_extension_bases)
+        return false;
+
+    const uint64_t suffix_size = kmer_size + count_extension_bases;
+    suffix.clear();
+    suffix.reserve(suffix_size);
+    for (uint64_t j = 0; j < suffix_size; ++j) {
+        uint64_t base;
+        if (not reader.next(base))
+            return false;
+        suffix.push_back(base);
+    }
+
+    uint64_t count_search_states;
+    extended_seed = {};
+    bool parsed = reader.next(extended_seed.marker_crossings)
+                  and reader.next(extended_seed.max_count_search_states)
+                  and reader.next(count_search_states);
+    if (not parsed)
+        return false;
+
+    for (uint64_t j = 0; j < count_search_states; ++j) {
+        SearchState search_state = {};
+        if (not parse_search_state_values(search_state, reader))
+            return false;
+        extended_seed.search_states.push_back(search_state);
+    }
+    return true;
+}
+
+
+void ExtendedSeedCache::deserialize(const sdsl::int_vector<> &serialized,
+                                    const uint64_t &kmer_size,
+                                    const uint64_t &prg_size,
+                                    const uint64_t &prg_checksum) {
+    // seeds from another kmer size or PRG are of no use
+    SerializedReader reader(serialized);
+    uint64_t header_kmer_size, header_prg_size, header_prg_checksum;
+    bool header_matches = reader.next(header_kmer_size)
+                          and reader.next(header_prg_size)
+                          and reader.next(header_prg_checksum)
+                          and header_kmer_size == kmer_size
+                          and header_prg_size == prg_size
+                          and header_prg_checksum == prg_checksum;
+    if (not enabled() or not header_matches)
+        return;
+
+    while (not reader.done()) {
+        Pattern suffix;
+        ExtendedSeed extended_seed = {};
+        if (not parse_extended_seed(suffix, extended_seed, reader, kmer_size))
+            return;
+
+        Pattern kmer(suffix.end() - kmer_size, suffix.end());
+        auto &shard = get_shard(kmer);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        if (shard.count_cached_seeds < max_shard_count_seeds)
+            cache_seed(shard, kmer, suffix, extended_seed);
+    }
+}
+
+
+void gram::extended_seed_cache::dump(ExtendedSeedCache &seed_cache,
+                                     const PRG_Info &prg_info,
+                                     const Parameters &parameters) {
+    auto serialized = seed_cache.serialize(parameters.kmers_size,
+                                           prg_info.fm_index.size(),
+                                           encoded_prg_checksum(prg_info.encoded_prg));
+    sdsl::store_to_file(serialized, parameters.extended_seeds_fpath);
+}
+
+
+void gram::extended_seed_cache::load(ExtendedSeedCache &seed_cache,
+                                     const PRG_Info &prg_info,
+                                     const Parameters &parameters) {
+    sdsl::int_vector<> serialized;
+    bool file_loaded = sdsl::load_from_file(serialized, parameters.extended_seeds_fpath);
+    if (not file_loaded)
+        return;
+    seed_cache.deserialize(serialized,
+                           parameters.kmers_size,
+                           prg_info.fm_index.size(),
+                           encoded_prg_checksum(prg_info.encoded_prg));
+}
@@ -1,3 +1,6 @@
+#include <algorithm>
+
+#include "prg/strand_symmetric.hpp"
 #include "kmer_index/kmers.hpp"
 
 
@@ -5,39 +8,33 @@ using namespace gram;
 
 
 std::vector<PrgIndexRange> gram::get_boundary_marker_indexes(const PRG_Info &prg_info) {
+    const auto &site_table = prg_info.site_table;
     std::vector<PrgIndexRange> boundary_marker_indexes;
+    boundary_marker_indexes.reserve(count_sites(site_table));
 
-    using MarkerIndex = uint64_t;
-    std::unordered_map<Marker, MarkerIndex> start_indexes;
-
-    for (uint64_t marker_count = 1;
-         marker_count <= prg_info.markers_mask_count_set_bits;
-         ++marker_count) {
-        auto marker_index = prg_info.prg_markers_select(marker_count);
-        uint64_t marker_char = prg_info.encoded_prg[marker_index];
-
-        auto marker_is_site_boundary = marker_char % 2 != 0;
-        if (not marker_is_site_boundary)
-            continue;
-
-        auto start_index_memorized = start_indexes.find(marker_char) != start_indexes.end();
-        if (not start_index_memorized) {
-            start_indexes[marker_char] = marker_index;
-            continue;
-        }
-
-        auto start_index = start_indexes[marker_char];
-        auto &end_index = marker_index;
-        boundary_marker_indexes.emplace_back(PrgIndexRange{start_index, end_index});
-
-        start_indexes.erase(marker_char);
+    for (uint64_t i = 0; i < count_sites(site_table); ++i) {
+        bool site_in_prg = site_table.end_prg_indexes[i] != 0;
+        if (site_in_prg)
+            boundary_marker_indexes.emplace_back(PrgIndexRange{site_table.start_prg_indexes[i],
+                                                               site_table.end_prg_indexes[i]});
     }
+
+    // sites are not necessarily numbered in PRG order
+    std::sort(boundary_marker_indexes.begin(), boundary_marker_indexes.end());
     return boundary_marker_indexes;
 }
 
 
 uint64_t gram::find_site_end_boundary(const uint64_t &within_site_index,
                                       const PRG_Info &prg_info) {
+    Marker site_marker = prg_info.sites_mask[within_site_index];
+    Marker prg_char = prg_info.encoded_prg[within_site_index];
+    if (prg_char > 4)
+        site_marker = prg_char % 2 == 0 ? prg_char - 1 : prg_char;
+    if (site_marker != 0)
+        return site_prg_indexes(site_marker, prg_info.site_table).second;
+
+    // outside of a site: scan for the next site's end boundary
     auto last_prg_index = prg_info.encoded_prg.size() - 1;
     auto number_markers_before = prg_info.prg_markers_rank(within_site_index);
 
@@ -64,6 +61,17 @@ uint64_t gram::find_site_end_boundary(const uint64_t &within_site_index,
 }
 
 
+// kmers are taken from one strand of a strand symmetric PRG, never across the separator
+bool spans_strand_separator(const uint64_t &first_index,
+                            const uint64_t &last_index,
+                            const PRG_Info &prg_info) {
+    if (prg_info.strand_count_sites == 0)
+        return false;
+    auto separator_index = strand_separator_index(prg_info.encoded_prg.size());
+    return first_index <= separator_index and separator_index <= last_index;
+}
+
+
 uint64_t get_kmer_region_end_index(const uint64_t end_marker_index,
                                    const uint64_t max_read_size,
                                    const PRG_Info &prg_info) {
@@ -71,6 +79,8 @@ uint64_t get_kmer_region_end_index(const uint64_t end_marker_index,
     auto end_index = end_marker_index + max_read_size - 1;
     if (end_index > last_prg_index)
         end_index = last_prg_index;
+    if (spans_strand_separator(end_marker_index, end_index, prg_info))
+        end_index = strand_separator_index(prg_info.encoded_prg.size()) - 1;
 
     auto within_variant_site = prg_info.allele_mask[end_index] > 0
                                or prg_info.prg_markers_mask[end_index] != 0;
@@ -311,6 +321,8 @@ std::list<uint64_t> gram::sites_inrange_left(const uint64_t outside_site_start_i
          marker_count > 0;
          --marker_count) {
         auto marker_index = prg_info.prg_markers_select(marker_count);
+        if (spans_strand_separator(marker_index, start_index, prg_info))
+            break;
         auto result = find_site_end_indexes(inrange_sites,
                                             traversal_state,
                                             marker_index,
@@ -391,20 +403,8 @@ std::vector<Base> extract_simple_reverse_kmer(const uint64_t kmer_end_index,
 
 uint64_t gram::find_site_start_boundary(const uint64_t &end_boundary_index,
                                         const PRG_Info &prg_info) {
-    auto target_marker = prg_info.encoded_prg[end_boundary_index];
-
-    uint64_t current_index = end_boundary_index;
-    uint64_t current_marker = 0;
-    auto number_markers_before = prg_info.prg_markers_rank(current_index);
-
-    while (current_marker != target_marker) {
-        current_index = prg_info.prg_markers_select(number_markers_before);
-        current_marker = prg_info.encoded_prg[current_index];
-        if (number_markers_before == 1)
-            break;
-        number_markers_before--;
-    }
-    return current_index;
+    Marker site_marker = prg_info.encoded_prg[end_boundary_index];
+    return site_prg_indexes(site_marker, prg_info.site_table).first;
 }
 
 
@@ -421,10 +421,10 @@ Pattern get_pre_site_part(const uint64_t site_end_boundary,
 
         for (int64_t i = first_site_start_boundary - 1;
              i >= end_index; --i) {
-            auto base = (Base) prg_info.encoded_prg[i];
-            if (base > 4)
+            auto prg_char = prg_info.encoded_prg[i];
+            if (prg_char > 4)
                 break;
-            pre_site_part.push_back(base);
+            pre_site_part.push_back((Base) prg_char);
         }
         std::reverse(pre_site_part.begin(), pre_site_part.end());
     }
@@ -479,7 +479,8 @@ void add_post_site_regions(std::list<Patterns> &region_parts,
     Pattern nonvariant_region = {};
 
     while (number_consumed_kmer_bases < kmer_size + 1
-           and index <= prg_info.encoded_prg.size() - 1) {
+           and index <= prg_info.encoded_prg.size() - 1
+           and not spans_strand_separator(index, index, prg_info)) {
 
         auto within_site = prg_info.allele_mask[index] > 0
                            or prg_info.prg_markers_mask[index] != 0;
@@ -2,6 +2,7 @@
 #include <thread>
 #include <unordered_map>
 
+#include "common/numa.hpp"
 #include "kmer_index/kmers.hpp"
 #include "kmer_index/build.hpp"
 #include "kmer_index/load.hpp"
@@ -23,6 +24,18 @@ Pattern gram::deserialize_next_kmer(const uint64_t &kmer_start_index,
 }
 
 
+// the kmer packed straight from its serialized bases, without an intermediate Pattern
+PackedKmer deserialize_next_packed_kmer(const uint64_t &kmer_start_index,
+                                        const sdsl::int_vector<3> &all_kmers,
+                                        const uint32_t &kmers_size) {
+    assert(kmer_start_index <= all_kmers.size() - kmers_size);
+    PackedKmer packed_kmer = 0;
+    for (uint64_t i = kmer_start_index; i < kmer_start_index + kmers_size; ++i)
+        packed_kmer = (packed_kmer << 2) | ((all_kmers[i] - 1) & 3);
+    return packed_kmer;
+}
+
+
 IndexedKmerStats gram::deserialize_next_stats(const uint64_t &stats_index,
                                               const sdsl::int_vector<> &kmers_stats) {
     // TODO: implement as an iterator
@@ -39,114 +52,108 @@ IndexedKmerStats gram::deserialize_next_stats(const uint64_t &stats_index,
 }
 
 
-void pad_search_states(SearchStates &search_states,
-                       const IndexedKmerStats &stats) {
-    auto expected_count = stats.count_search_states - search_states.size();
-    for (uint64_t i = search_states.size(); i < expected_count; ++i)
-        search_states.emplace_back(SearchState{});
-}
+std::vector<IndexedKmerOffsets> gram::calculate_offsets(const uint64_t &count_kmers,
+                                                        const sdsl::int_vector<> &kmers_stats) {
+    std::vector<IndexedKmerOffsets> all_offsets;
+    all_offsets.reserve(count_kmers);
 
+    IndexedKmerOffsets offsets = {};
+    for (uint64_t i = 0; i < count_kmers; ++i) {
+        all_offsets.push_back(offsets);
 
-void handle_sa_interval(SearchStates &search_states,
-                        uint64_t &sa_interval_index,
-                        const sdsl::int_vector<> &sa_intervals) {
-    for (auto &search_state: search_states) {
-        search_state.sa_interval.first = sa_intervals[sa_interval_index];
-        search_state.sa_interval.second = sa_intervals[sa_interval_index + 1];
-        sa_interval_index += 2;
+        uint64_t count_search_states = kmers_stats[offsets.stats_index];
+        offsets.sa_intervals_index += count_search_states * 2;
+        offsets.stats_index += count_search_states + 1;
     }
+    return all_offsets;
 }
 
 
-void gram::parse_sa_intervals(KmerIndex &kmer_index,
-                              const sdsl::int_vector<3> &all_kmers,
-                              const sdsl::int_vector<> &kmers_stats,
-                              const Parameters &parameters) {
-    uint64_t sa_interval_index = 0;
-    sdsl::int_vector<> sa_intervals;
-    load_from_file(sa_intervals, parameters.sa_intervals_fpath);
-
-    uint64_t stats_index = 0;
-    uint64_t kmer_start_index = 0;
-
-    while (kmer_start_index <= all_kmers.size() - parameters.kmers_size) {
-        auto kmer = deserialize_next_kmer(kmer_start_index, all_kmers, parameters.kmers_size);
-        kmer_start_index += parameters.kmers_size;
-
-        auto stats = deserialize_next_stats(stats_index, kmers_stats);
-        stats_index += stats.count_search_states + 1;
-
-        auto &search_states = kmer_index[kmer];
-        pad_search_states(search_states, stats);
-
-        handle_sa_interval(search_states,
-                           sa_interval_index,
-                           sa_intervals);
-    }
-}
+SearchStates gram::deserialize_search_states(const uint64_t &kmer_number,
+                                             const IndexedKmerOffsets &offsets,
+                                             const sdsl::int_vector<> &kmers_stats,
+                                             const sdsl::int_vector<> &sa_intervals,
+                                             const CompressedPaths &paths) {
+    auto stats = deserialize_next_stats(offsets.stats_index, kmers_stats);
+    auto sa_intervals_index = offsets.sa_intervals_index;
 
+    const auto path_elements = decompress_kmer_paths(kmer_number, paths);
+    auto path_element_it = path_elements.begin();
 
-void handle_path_element(SearchStates &search_states,
-                         uint64_t &paths_index,
-                         const sdsl::int_vector<> &paths,
-                         const IndexedKmerStats &stats) {
-    uint64_t i = 0;
-    for (auto &search_state: search_states) {
-        const auto &path_length = stats.path_lengths[i++];
+    SearchStates search_states = {};
+    for (const auto &path_length: stats.path_lengths) {
+        SearchState search_state = {};
+        search_state.sa_interval.first = sa_intervals[sa_intervals_index];
+        search_state.sa_interval.second = sa_intervals[sa_intervals_index + 1];
+        sa_intervals_index += 2;
 
         for (uint64_t j = 0; j < path_length; ++j) {
-            Marker marker = paths[paths_index];
-            AlleleId allele_id = paths[paths_index + 1];
-            paths_index += 2;
-
-            VariantSite site = {marker, allele_id};
-            search_state.variant_site_path.emplace_back(site);
+            assert(path_element_it != path_elements.end());
+            search_state.variant_site_path.emplace_back(*path_element_it++);
         }
+        search_states.emplace_back(search_state);
     }
+    return search_states;
 }
 
 
-void gram::parse_paths(KmerIndex &kmer_index,
-                       const sdsl::int_vector<3> &all_kmers,
-                       const sdsl::int_vector<> &kmers_stats,
-                       const Parameters &parameters) {
-    uint64_t paths_index = 0;
-    sdsl::int_vector<> paths;
-    load_from_file(paths, parameters.paths_fpath);
-
-    uint64_t stats_index = 0;
-    uint64_t kmer_start_index = 0;
-
-    while (kmer_start_index <= all_kmers.size() - parameters.kmers_size) {
-        auto kmer = deserialize_next_kmer(kmer_start_index,
-                                          all_kmers,
-                                          parameters.kmers_size);
-        kmer_start_index += parameters.kmers_size;
-
-        auto stats = deserialize_next_stats(stats_index, kmers_stats);
-        stats_index += stats.count_search_states + 1;
-
-        auto &search_states = kmer_index[kmer];
-        pad_search_states(search_states, stats);
+KmerIndex gram::parse_kmer_index(const sdsl::int_vector<3> &all_kmers,
+                                 const sdsl::int_vector<> &kmers_stats,
+                                 const sdsl::int_vector<> &sa_intervals,
+                                 const CompressedPaths &paths,
+                                 const Parameters &parameters) {
+    const uint64_t count_kmers = all_kmers.size() / parameters.kmers_size;
+    const auto all_offsets = calculate_offsets(count_kmers, kmers_stats);
+
+    using Entry = std::pair<PackedKmer, SearchStates>;
+    std::vector<Entry> entries(count_kmers);
+
+    // memory policies are per thread: worker threads allocate the entries under the
+    // calling thread's policy (interleaved, with --numa interleave), then restore their own
+    const auto memory_policy = numa::current_policy();
+
+    #pragma omp parallel
+    {
+        const auto thread_memory_policy = numa::current_policy();
+        numa::apply_policy(memory_policy);
+
+        #pragma omp for schedule(dynamic, 1024)
+        for (uint64_t i = 0; i < count_kmers; ++i) {
+            entries[i].first = deserialize_next_packed_kmer(i * parameters.kmers_size,
+                                                            all_kmers,
+                                                            parameters.kmers_size);
+            entries[i].second = deserialize_search_states(i,
+                                                          all_offsets[i],
+                                                          kmers_stats,
+                                                          sa_intervals,
+                                                          paths);
+        }
 
-        handle_path_element(search_states,
-                            paths_index,
-                            paths,
-                            stats);
+        numa::apply_policy(thread_memory_policy);
     }
+
+    KmerIndex kmer_index;
+    kmer_index.reserve(count_kmers);
+    for (auto &entry: entries)
+        kmer_index.emplace(entry.first, std::move(entry.second));
+    return kmer_index;
 }
 
 
 KmerIndex gram::kmer_index::load(const Parameters &parameters) {
-    KmerIndex kmer_index;
+    exit_if_kmer_size_unpackable(parameters.kmers_size);
 
     sdsl::int_vector<3> all_kmers;
-    load_from_file(all_kmers, parameters.kmers_fpath);
+    sdsl::load_from_file(all_kmers, parameters.kmers_fpath);
 
     sdsl::int_vector<> kmers_stats;
-    load_from_file(kmers_stats, parameters.kmers_stats_fpath);
+    sdsl::load_from_file(kmers_stats, parameters.kmers_stats_fpath);
 
-    parse_sa_intervals(kmer_index, all_kmers, kmers_stats, parameters);
-    parse_paths(kmer_index, all_kmers, kmers_stats, parameters);
-    return kmer_index;
+    sdsl::int_vector<> sa_intervals;
+    sdsl::load_from_file(sa_intervals, parameters.sa_intervals_fpath);
+
+    CompressedPaths paths;
+    sdsl::load_from_file(paths, parameters.paths_fpath);
+
+    return parse_kmer_index(all_kmers, kmers_stats, sa_intervals, paths, parameters);
 }
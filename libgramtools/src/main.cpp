@@ -18,6 +18,9 @@
 #include "quasimap/quasimap.hpp"
 #include "quasimap/parameters.hpp"
 
+#include "serve/serve.hpp"
+#include "serve/parameters.hpp"
+
 #include "main.hpp"
 
 
@@ -41,6 +44,9 @@ int main(int argc, const char *const *argv) {
         case Commands::quasimap:
             commands::quasimap::run(parameters);
             break;
+        case Commands::serve:
+            commands::serve::run(parameters);
+            break;
     }
     return 0;
 }
@@ -75,6 +81,9 @@ std::pair<Parameters, Commands> gram::parse_command_line_parameters(int argc, co
     } else if (cmd == "quasimap") {
         auto parameters = commands::quasimap::parse_parameters(vm, parsed);
         return std::make_pair(parameters, Commands::quasimap);
+    } else if (cmd == "serve") {
+        auto parameters = commands::serve::parse_parameters(vm, parsed);
+        return std::make_pair(parameters, Commands::serve);
     }
 
     // unrecognised command
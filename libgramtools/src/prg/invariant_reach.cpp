@@ -0,0 +1,80 @@
+#include <algorithm>
+#include <vector>
+
+#include "prg/invariant_reach.hpp"
+
+
+using namespace gram;
+
+
+uint64_t InvariantReach::serialize(std::ostream &out,
+                                   sdsl::structure_tree_node *v,
+                                   std::string name) const {
+    auto child = sdsl::structure_tree::add_child(v, name, sdsl::util::class_name(*this));
+    uint64_t written_bytes = 0;
+    written_bytes += sdsl::write_member(kmer_size, out, child, "kmer_size");
+    written_bytes += sa_reach.serialize(out, child, "sa_reach");
+    sdsl::structure_tree::add_size(child, written_bytes);
+    return written_bytes;
+}
+
+
+void InvariantReach::load(std::istream &in) {
+    sdsl::read_member(kmer_size, in);
+    sa_reach.load(in);
+}
+
+
+InvariantReach gram::generate_invariant_reach(const FM_Index &fm_index,
+                                              const sdsl::int_vector<> &encoded_prg,
+                                              const sdsl::int_vector<> &sites_mask,
+                                              const uint64_t &kmer_size) {
+    const uint64_t prg_size = encoded_prg.size();
+    auto invariant = [&](const uint64_t &prg_index) {
+        return encoded_prg[prg_index] <= 4 and sites_mask[prg_index] == 0;
+    };
+
+    // prg index reach: non-variant bases left of it, plus one, if its kmer is non-variant
+    std::vector<uint8_t> prg_reach(prg_size, 0);
+    uint64_t count_right_bases = 0;
+    for (uint64_t i = prg_size; i-- > 0;) {
+        count_right_bases = invariant(i) ? count_right_bases + 1 : 0;
+        if (count_right_bases >= kmer_size)
+            prg_reach[i] = 1;
+    }
+    uint64_t count_left_bases = 0;
+    for (uint64_t i = 0; i < prg_size; ++i) {
+        if (prg_reach[i] != 0)
+            prg_reach[i] = (uint8_t) std::min<uint64_t>(count_left_bases + 1, max_invariant_reach);
+        count_left_bases = invariant(i) ? count_left_bases + 1 : 0;
+    }
+
+    InvariantReach invariant_reach = {};
+    invariant_reach.kmer_size = kmer_size;
+    invariant_reach.sa_reach = sdsl::int_vector<8>(fm_index.size(), 0);
+    for (uint64_t sa_index = 0; sa_index < fm_index.size(); ++sa_index) {
+        // the sentinel's suffix starts past the end of the PRG
+        auto prg_index = fm_index[sa_index];
+        if (prg_index < prg_size)
+            invariant_reach.sa_reach[sa_index] = prg_reach[prg_index];
+    }
+    return invariant_reach;
+}
+
+
+InvariantReach gram::load_invariant_reach(const Parameters &parameters) {
+    InvariantReach invariant_reach;
+    sdsl::load_from_file(invariant_reach, parameters.invariant_reach_fpath);
+    return invariant_reach;
+}
+
+
+bool gram::sa_interval_invariant(const InvariantReach &invariant_reach,
+                                 const InvariantReachRMQ &invariant_reach_rmq,
+                                 const SA_Interval &sa_interval,
+                                 const uint64_t &count_left_bases) {
+    if (invariant_reach.sa_reach.empty() or count_left_bases + 1 > max_invariant_reach)
+        return false;
+    auto min_sa_index = invariant_reach_rmq(sa_interval.first, sa_interval.second);
+    return invariant_reach.sa_reach[min_sa_index] >= count_left_bases + 1;
+}
@@ -0,0 +1,139 @@
+#include <algorithm>
+#include <vector>
+
+#include "prg/kmer_presence.hpp"
+
+
+using namespace gram;
+
+
+uint64_t KmerPresence::serialize(std::ostream &out,
+                                 sdsl::structure_tree_node *v,
+                                 std::string name) const {
+    auto child = sdsl::structure_tree::add_child(v, name, sdsl::util::class_name(*this));
+    uint64_t written_bytes = 0;
+    written_bytes += sdsl::write_member(kmer_size, out, child, "kmer_size");
+    written_bytes += kmers_mask.serialize(out, child, "kmers_mask");
+    sdsl::structure_tree::add_size(child, written_bytes);
+    return written_bytes;
+}
+
+
+void KmerPresence::load(std::istream &in) {
+    sdsl::read_member(kmer_size, in);
+    kmers_mask.load(in);
+}
+
+
+// a context is the last bases of a path, at most kmer size - 1 of them,
+// packed with its length in the top byte
+using PathContext = uint64_t;
+using PathContexts = std::vector<PathContext>;
+
+
+void deduplicate(PathContexts &contexts) {
+    std::sort(contexts.begin(), contexts.end());
+    contexts.erase(std::unique(contexts.begin(), contexts.end()), contexts.end());
+}
+
+
+PathContexts extend_contexts(const PathContexts &contexts,
+                             const Base &base,
+                             const uint64_t &kmer_size,
+                             sdsl::bit_vector &kmers_mask) {
+    const uint64_t context_size = kmer_size - 1;
+    const uint64_t context_bits_mask = (uint64_t(1) << (2 * context_size)) - 1;
+    const uint64_t kmer_bits_mask = (uint64_t(1) << (2 * kmer_size)) - 1;
+
+    PathContexts new_contexts;
+    new_contexts.reserve(contexts.size());
+    for (const auto &context: contexts) {
+        uint64_t length = context >> 56;
+        uint64_t bases = ((context & context_bits_mask) << 2) | (base - 1);
+
+        if (length == context_size)
+            kmers_mask[bases & kmer_bits_mask] = 1;
+        uint64_t new_length = std::min(length + 1, context_size);
+        new_contexts.push_back((new_length << 56) | (bases & context_bits_mask));
+    }
+    deduplicate(new_contexts);
+    return new_contexts;
+}
+
+
+KmerPresence gram::generate_kmer_presence(const sdsl::int_vector<> &encoded_prg,
+                                          const uint64_t &kmer_size) {
+    KmerPresence kmer_presence = {};
+    kmer_presence.kmer_size = kmer_size;
+    kmer_presence.kmers_mask = sdsl::bit_vector(uint64_t(1) << (2 * kmer_size), 0);
+
+    // every path through a site starts from the contexts before it, through one allele
+    PathContexts contexts = {0};
+    PathContexts site_start_contexts;
+    PathContexts site_end_contexts;
+    Marker current_site_marker = 0;
+
+    for (const auto &value: encoded_prg) {
+        bool is_base = value <= 4;
+        if (is_base) {
+            contexts = extend_contexts(contexts, value, kmer_size, kmer_presence.kmers_mask);
+            continue;
+        }
+
+        site_end_contexts.insert(site_end_contexts.end(), contexts.begin(), contexts.end());
+        bool is_site_boundary = value % 2 == 1;
+        if (not is_site_boundary) {
+            contexts = site_start_contexts;
+            continue;
+        }
+
+        bool site_start = value != current_site_marker;
+        if (site_start) {
+            current_site_marker = value;
+            site_start_contexts = contexts;
+            site_end_contexts.clear();
+            continue;
+        }
+
+        current_site_marker = 0;
+        contexts = site_end_contexts;
+        deduplicate(contexts);
+        site_end_contexts.clear();
+    }
+    return kmer_presence;
+}
+
+
+KmerPresence gram::load_kmer_presence(const Parameters &parameters) {
+    KmerPresence kmer_presence;
+    sdsl::load_from_file(kmer_presence, parameters.kmer_presence_fpath);
+    return kmer_presence;
+}
+
+
+bool kmer_present(const KmerPresence &kmer_presence,
+                  const Pattern &read,
+                  const uint64_t &kmer_start) {
+    uint64_t kmer_bits = 0;
+    for (uint64_t i = kmer_start; i < kmer_start + kmer_presence.kmer_size; ++i)
+        kmer_bits = (kmer_bits << 2) | (read[i] - 1);
+    return kmer_presence.kmers_mask[kmer_bits] == 1;
+}
+
+
+bool gram::sampled_kmers_present(const KmerPresence &kmer_presence,
+                                 const Pattern &read) {
+    bool presence_generated = kmer_presence.kmer_size != 0;
+    if (not presence_generated or read.size() < kmer_presence.kmer_size)
+        return true;
+
+    // first, last and two evenly spaced kmers in between
+    const uint64_t count_samples = 4;
+    const uint64_t last_kmer_start = read.size() - kmer_presence.kmer_size;
+    for (uint64_t sample = 0; sample < count_samples; ++sample) {
+        uint64_t kmer_start = last_kmer_start * sample / (count_samples - 1);
+        if (not kmer_present(kmer_presence, read, kmer_start))
+            return false;
+    }
+    return true;
+}
@@ -8,18 +8,79 @@
 using namespace gram;
 
 
-sdsl::bit_vector gram::generate_prg_markers_mask(const sdsl::int_vector<> &encoded_prg) {
+sdsl::bit_vector gram::generate_prg_markers_mask(const sdsl::int_vector<> &encoded_prg,
+                                                 const uint64_t &strand_separator) {
     sdsl::bit_vector variants_markers_mask(encoded_prg.size(), 0);
     for (uint64_t i = 0; i < encoded_prg.size(); i++)
-        variants_markers_mask[i] = encoded_prg[i] > 4;
+        variants_markers_mask[i] = encoded_prg[i] > 4 and encoded_prg[i] != strand_separator;
     return variants_markers_mask;
 }
 
 
-sdsl::bit_vector gram::generate_bwt_markers_mask(const FM_Index &fm_index) {
+sdsl::bit_vector gram::generate_bwt_markers_mask(const FM_Index &fm_index,
+                                                 const uint64_t &strand_separator) {
     sdsl::bit_vector bwt_markers_mask(fm_index.bwt.size(), 0);
     for (uint64_t i = 0; i < fm_index.bwt.size(); i++)
-        bwt_markers_mask[i] = fm_index.bwt[i] > 4;
+        bwt_markers_mask[i] = fm_index.bwt[i] > 4 and fm_index.bwt[i] != strand_separator;
+    return bwt_markers_mask;
+}
+
+
+BWT_Markers gram::generate_bwt_markers(const FM_Index &fm_index,
+                                       const sdsl::bit_vector &bwt_markers_mask) {
+    uint64_t count_markers = 0;
+    for (uint64_t i = 0; i < bwt_markers_mask.size(); i++)
+        count_markers += bwt_markers_mask[i];
+
+    BWT_Markers bwt_markers = {};
+    bwt_markers.indexes = sdsl::int_vector<>(count_markers, 0, 64);
+    bwt_markers.symbols = sdsl::int_vector<>(count_markers, 0, 64);
+
+    uint64_t marker_rank = 0;
+    for (uint64_t i = 0; i < bwt_markers_mask.size(); i++) {
+        if (not bwt_markers_mask[i])
+            continue;
+        bwt_markers.indexes[marker_rank] = i;
+        bwt_markers.symbols[marker_rank] = fm_index.bwt[i];
+        ++marker_rank;
+    }
+
+    sdsl::util::bit_compress(bwt_markers.indexes);
+    sdsl::util::bit_compress(bwt_markers.symbols);
+    return bwt_markers;
+}
+
+
+uint64_t BWT_Markers::serialize(std::ostream &out,
+                                sdsl::structure_tree_node *v,
+                                std::string name) const {
+    auto child = sdsl::structure_tree::add_child(v, name, sdsl::util::class_name(*this));
+    uint64_t written_bytes = 0;
+    written_bytes += indexes.serialize(out, child, "indexes");
+    written_bytes += symbols.serialize(out, child, "symbols");
+    sdsl::structure_tree::add_size(child, written_bytes);
+    return written_bytes;
+}
+
+
+void BWT_Markers::load(std::istream &in) {
+    indexes.load(in);
+    symbols.load(in);
+}
+
+
+BWT_Markers gram::load_bwt_markers(const Parameters &parameters) {
+    BWT_Markers bwt_markers;
+    sdsl::load_from_file(bwt_markers, parameters.bwt_markers_fpath);
+    return bwt_markers;
+}
+
+
+sdsl::bit_vector gram::generate_bwt_markers_mask(const BWT_Markers &bwt_markers,
+                                                 const uint64_t &bwt_size) {
+    sdsl::bit_vector bwt_markers_mask(bwt_size, 0);
+    for (uint64_t i = 0; i < bwt_markers.indexes.size(); i++)
+        bwt_markers_mask[bwt_markers.indexes[i]] = 1;
     return bwt_markers_mask;
 }
 
@@ -1,5 +1,9 @@
+#include <limits>
+
+#include "common/random.hpp"
 #include "prg/masks.hpp"
 #include "prg/prg.hpp"
+#include "prg/strand_symmetric.hpp"
 
 
 using namespace gram;
@@ -33,6 +37,29 @@ uint64_t gram::get_max_alphabet_num(const sdsl::int_vector<> &encoded_prg) {
 }
 
 
+uint64_t gram::encoded_prg_checksum(const sdsl::int_vector<> &encoded_prg) {
+    uint64_t checksum = SplitMix64::mix(encoded_prg.size());
+    for (const uint64_t &x: encoded_prg)
+        checksum = SplitMix64::mix(checksum ^ x) + SplitMix64::golden_gamma;
+    return checksum;
+}
+
+
+bool gram::markers_fit_variant_ids(const uint64_t &max_alphabet_num) {
+    return max_alphabet_num <= std::numeric_limits<Marker>::max();
+}
+
+
+void gram::exit_if_markers_exceed_variant_ids(const uint64_t &max_alphabet_num) {
+    if (markers_fit_variant_ids(max_alphabet_num))
+        return;
+    std::cout << "PRG marker " << max_alphabet_num
+              << " exceeds the variant site ID width, "
+              << "rebuild gramtools with GRAMTOOLS_WIDE_VARIANT_IDS.\nExiting 1" << std::endl;
+    std::exit(1);
+}
+
+
 sdsl::int_vector<> gram::generate_encoded_prg(const Parameters &parameters) {
     auto encoded_prg = parse_raw_prg_file(parameters.linear_prg_fpath);
     sdsl::store_to_file(encoded_prg, parameters.encoded_prg_fpath);
@@ -151,21 +178,37 @@ PRG_Info gram::load_prg_info(const Parameters &parameters) {
     PRG_Info prg_info = {};
 
     prg_info.encoded_prg = parse_raw_prg_file(parameters.linear_prg_fpath);
+    prg_info.fm_index = load_fm_index(parameters);
+    if (index_is_strand_symmetric(prg_info.fm_index.size(), prg_info.encoded_prg.size())) {
+        prg_info.strand_count_sites = count_variant_sites(prg_info.encoded_prg);
+        prg_info.encoded_prg = generate_strand_symmetric_prg(prg_info.encoded_prg);
+    }
     prg_info.max_alphabet_num = get_max_alphabet_num(prg_info.encoded_prg);
+    exit_if_markers_exceed_variant_ids(prg_info.max_alphabet_num);
 
-    prg_info.fm_index = load_fm_index(parameters);
     prg_info.sites_mask = load_sites_mask(parameters);
     prg_info.allele_mask = load_allele_mask(parameters);
+    prg_info.site_table = load_site_table(parameters);
+
+    prg_info.sa_allele_runs = load_sa_allele_runs(parameters);
+    prg_info.sa_allele_runs_rank = sdsl::rank_support_v<1>(&prg_info.sa_allele_runs.run_starts_mask);
+    prg_info.sa_allele_runs_select = sdsl::select_support_mcl<1>(&prg_info.sa_allele_runs.run_starts_mask);
+
+    prg_info.kmer_presence = load_kmer_presence(parameters);
+
+    prg_info.invariant_reach = load_invariant_reach(parameters);
+    prg_info.invariant_reach_rmq = InvariantReachRMQ(&prg_info.invariant_reach.sa_reach);
 
-    prg_info.prg_markers_mask = generate_prg_markers_mask(prg_info.encoded_prg);
+    prg_info.prg_markers_mask = generate_prg_markers_mask(prg_info.encoded_prg,
+                                                          strand_separator(prg_info.strand_count_sites));
     prg_info.prg_markers_rank = sdsl::rank_support_v<1>(&prg_info.prg_markers_mask);
     prg_info.prg_markers_select = sdsl::select_support_mcl<1>(&prg_info.prg_markers_mask);
 
-    prg_info.bwt_markers_mask = generate_bwt_markers_mask(prg_info.fm_index);
+    prg_info.bwt_markers = load_bwt_markers(parameters);
+    prg_info.bwt_markers_mask = generate_bwt_markers_mask(prg_info.bwt_markers, prg_info.fm_index.bwt.size());
     prg_info.bwt_markers_rank = sdsl::rank_support_v<1>(&prg_info.bwt_markers_mask);
     prg_info.bwt_markers_select = sdsl::select_support_mcl<1>(&prg_info.bwt_markers_mask);
-    prg_info.markers_mask_count_set_bits =
-            prg_info.bwt_markers_rank(prg_info.bwt_markers_mask.size());
+    prg_info.markers_mask_count_set_bits = prg_info.bwt_markers.indexes.size();
 
     prg_info.dna_bwt_masks = load_dna_bwt_masks(prg_info.fm_index, parameters);
     prg_info.rank_bwt_a = sdsl::rank_support_v<1>(&prg_info.dna_bwt_masks.mask_a);
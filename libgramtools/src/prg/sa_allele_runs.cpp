@@ -0,0 +1,67 @@
+#include <vector>
+
+#include "prg/sa_allele_runs.hpp"
+
+
+using namespace gram;
+
+
+uint64_t SA_AlleleRuns::serialize(std::ostream &out,
+                                  sdsl::structure_tree_node *v,
+                                  std::string name) const {
+    auto child = sdsl::structure_tree::add_child(v, name, sdsl::util::class_name(*this));
+    uint64_t written_bytes = 0;
+    written_bytes += run_starts_mask.serialize(out, child, "run_starts_mask");
+    written_bytes += site_markers.serialize(out, child, "site_markers");
+    written_bytes += allele_ids.serialize(out, child, "allele_ids");
+    sdsl::structure_tree::add_size(child, written_bytes);
+    return written_bytes;
+}
+
+
+void SA_AlleleRuns::load(std::istream &in) {
+    run_starts_mask.load(in);
+    site_markers.load(in);
+    allele_ids.load(in);
+}
+
+
+SA_AlleleRuns gram::generate_sa_allele_runs(const FM_Index &fm_index,
+                                            const sdsl::int_vector<> &sites_mask,
+                                            const sdsl::int_vector<> &allele_mask) {
+    SA_AlleleRuns sa_allele_runs = {};
+    sa_allele_runs.run_starts_mask = sdsl::bit_vector(fm_index.size(), 0);
+    std::vector<VariantSite> run_alleles;
+
+    for (uint64_t sa_index = 0; sa_index < fm_index.size(); ++sa_index) {
+        auto prg_index = fm_index[sa_index];
+
+        // the sentinel's suffix starts past the end of the masks
+        VariantSite allele = {0, 0};
+        if (prg_index < sites_mask.size())
+            allele = VariantSite{sites_mask[prg_index], allele_mask[prg_index]};
+
+        bool run_continues = not run_alleles.empty() and run_alleles.back() == allele;
+        if (run_continues)
+            continue;
+        sa_allele_runs.run_starts_mask[sa_index] = 1;
+        run_alleles.push_back(allele);
+    }
+
+    sa_allele_runs.site_markers = sdsl::int_vector<>(run_alleles.size(), 0, 64);
+    sa_allele_runs.allele_ids = sdsl::int_vector<>(run_alleles.size(), 0, 64);
+    for (uint64_t i = 0; i < run_alleles.size(); ++i) {
+        sa_allele_runs.site_markers[i] = run_alleles[i].first;
+        sa_allele_runs.allele_ids[i] = run_alleles[i].second;
+    }
+    sdsl::util::bit_compress(sa_allele_runs.site_markers);
+    sdsl::util::bit_compress(sa_allele_runs.allele_ids);
+    return sa_allele_runs;
+}
+
+
+SA_AlleleRuns gram::load_sa_allele_runs(const Parameters &parameters) {
+    SA_AlleleRuns sa_allele_runs;
+    sdsl::load_from_file(sa_allele_runs, parameters.sa_allele_runs_fpath);
+    return sa_allele_runs;
+}
@@ -0,0 +1,177 @@
+#include <vector>
+
+#include "prg/site_table.hpp"
+
+
+using namespace gram;
+
+
+uint64_t SiteTable::serialize(std::ostream &out,
+                              sdsl::structure_tree_node *v,
+                              std::string name) const {
+    auto child = sdsl::structure_tree::add_child(v, name, sdsl::util::class_name(*this));
+    uint64_t written_bytes = 0;
+    written_bytes += start_prg_indexes.serialize(out, child, "start_prg_indexes");
+    written_bytes += end_prg_indexes.serialize(out, child, "end_prg_indexes");
+    written_bytes += start_sa_indexes.serialize(out, child, "start_sa_indexes");
+    written_bytes += end_sa_indexes.serialize(out, child, "end_sa_indexes");
+    written_bytes += allele_offsets.serialize(out, child, "allele_offsets");
+    written_bytes += allele_start_prg_indexes.serialize(out, child, "allele_start_prg_indexes");
+    written_bytes += allele_lengths.serialize(out, child, "allele_lengths");
+    sdsl::structure_tree::add_size(child, written_bytes);
+    return written_bytes;
+}
+
+
+void SiteTable::load(std::istream &in) {
+    start_prg_indexes.load(in);
+    end_prg_indexes.load(in);
+    start_sa_indexes.load(in);
+    end_sa_indexes.load(in);
+    allele_offsets.load(in);
+    allele_start_prg_indexes.load(in);
+    allele_lengths.load(in);
+}
+
+
+using SiteAlleles = std::vector<std::pair<uint64_t, uint64_t>>;
+
+
+void flatten_site_alleles(SiteTable &site_table,
+                          const std::vector<SiteAlleles> &all_site_alleles) {
+    uint64_t count_alleles = 0;
+    for (const auto &site_alleles: all_site_alleles)
+        count_alleles += site_alleles.size();
+
+    site_table.allele_offsets = sdsl::int_vector<>(all_site_alleles.size() + 1, 0, 64);
+    site_table.allele_start_prg_indexes = sdsl::int_vector<>(count_alleles, 0, 64);
+    site_table.allele_lengths = sdsl::int_vector<>(count_alleles, 0, 64);
+
+    uint64_t allele_offset = 0;
+    for (uint64_t i = 0; i < all_site_alleles.size(); ++i) {
+        site_table.allele_offsets[i] = allele_offset;
+        for (const auto &allele: all_site_alleles[i]) {
+            site_table.allele_start_prg_indexes[allele_offset] = allele.first;
+            site_table.allele_lengths[allele_offset] = allele.second;
+            ++allele_offset;
+        }
+    }
+    site_table.allele_offsets[all_site_alleles.size()] = allele_offset;
+}
+
+
+void set_boundary_sa_indexes(SiteTable &site_table,
+                             const FM_Index &fm_index) {
+    const auto count_sites = site_table.start_prg_indexes.size();
+    for (uint64_t i = 0; i < count_sites; ++i) {
+        Marker site_marker = 5 + i * 2;
+        bool site_in_prg = site_table.end_prg_indexes[i] != 0;
+        if (not site_in_prg)
+            continue;
+
+        // both boundary markers are adjacent in the SA, ordered by their right context
+        auto alphabet_rank = fm_index.char2comp[site_marker];
+        uint64_t first_sa_index = fm_index.C[alphabet_rank];
+        uint64_t second_sa_index = first_sa_index + 1;
+
+        bool first_is_start = fm_index[first_sa_index] == site_table.start_prg_indexes[i];
+        site_table.start_sa_indexes[i] = first_is_start ? first_sa_index : second_sa_index;
+        site_table.end_sa_indexes[i] = first_is_start ? second_sa_index : first_sa_index;
+    }
+}
+
+
+SiteTable gram::generate_site_table(const sdsl::int_vector<> &encoded_prg,
+                                    const FM_Index &fm_index) {
+    Marker max_site_marker = 0;
+    for (const auto &prg_char: encoded_prg) {
+        bool is_site_marker = prg_char > 4 and prg_char % 2 != 0;
+        if (is_site_marker and prg_char > max_site_marker)
+            max_site_marker = prg_char;
+    }
+    uint64_t count_sites = max_site_marker == 0 ? 0 : site_index(max_site_marker) + 1;
+
+    SiteTable site_table = {};
+    site_table.start_prg_indexes = sdsl::int_vector<>(count_sites, 0, 64);
+    site_table.end_prg_indexes = sdsl::int_vector<>(count_sites, 0, 64);
+    site_table.start_sa_indexes = sdsl::int_vector<>(count_sites, 0, 64);
+    site_table.end_sa_indexes = sdsl::int_vector<>(count_sites, 0, 64);
+    std::vector<SiteAlleles> all_site_alleles(count_sites);
+
+    Marker current_site_marker = 0;
+    for (uint64_t i = 0; i < encoded_prg.size(); ++i) {
+        const Marker prg_char = encoded_prg[i];
+        if (prg_char <= 4) {
+            if (current_site_marker != 0)
+                ++all_site_alleles[site_index(current_site_marker)].back().second;
+            continue;
+        }
+
+        // an allele marker outside of a site is a strand symmetric PRG's strand separator
+        auto at_site_boundary = prg_char % 2 != 0;
+        if (not at_site_boundary and current_site_marker == 0)
+            continue;
+
+        auto &site_alleles = all_site_alleles[site_index(prg_char)];
+        if (not at_site_boundary) {
+            site_alleles.emplace_back(std::make_pair(i + 1, 0));
+            continue;
+        }
+
+        auto entering_site = current_site_marker == 0;
+        if (entering_site) {
+            current_site_marker = prg_char;
+            site_table.start_prg_indexes[site_index(prg_char)] = i;
+            site_alleles.emplace_back(std::make_pair(i + 1, 0));
+            continue;
+        }
+
+        site_table.end_prg_indexes[site_index(prg_char)] = i;
+        current_site_marker = 0;
+    }
+
+    flatten_site_alleles(site_table, all_site_alleles);
+    set_boundary_sa_indexes(site_table, fm_index);
+
+    sdsl::util::bit_compress(site_table.start_prg_indexes);
+    sdsl::util::bit_compress(site_table.end_prg_indexes);
+    sdsl::util::bit_compress(site_table.start_sa_indexes);
+    sdsl::util::bit_compress(site_table.end_sa_indexes);
+    sdsl::util::bit_compress(site_table.allele_offsets);
+    sdsl::util::bit_compress(site_table.allele_start_prg_indexes);
+    sdsl::util::bit_compress(site_table.allele_lengths);
+    return site_table;
+}
+
+
+SiteTable gram::load_site_table(const Parameters &parameters) {
+    SiteTable site_table;
+    sdsl::load_from_file(site_table, parameters.site_table_fpath);
+    return site_table;
+}
+
+
+uint64_t gram::count_sites(const SiteTable &site_table) {
+    return site_table.start_prg_indexes.size();
+}
+
+
+std::pair<uint64_t, uint64_t> gram::site_prg_indexes(const Marker &site_marker,
+                                                     const SiteTable &site_table) {
+    auto i = site_index(site_marker);
+    return std::make_pair(site_table.start_prg_indexes[i], site_table.end_prg_indexes[i]);
+}
+
+
+uint64_t gram::allele_start_prg_index(const VariantSite &variant_site,
+                                      const SiteTable &site_table) {
+    auto allele_offset = site_table.allele_offsets[site_index(variant_site.first)];
+    return site_table.allele_start_prg_indexes[allele_offset + variant_site.second - 1];
+}
+
+
+uint64_t gram::allele_length(const VariantSite &variant_site,
+                             const SiteTable &site_table) {
+    auto allele_offset = site_table.allele_offsets[site_index(variant_site.first)];
+    return site_table.allele_lengths[allele_offset + variant_site.second - 1];
+}
@@ -0,0 +1,119 @@
+#include <vector>
+
+#include "prg/strand_symmetric.hpp"
+
+
+using namespace gram;
+
+
+uint64_t gram::count_variant_sites(const sdsl::int_vector<> &encoded_prg) {
+    uint64_t max_site_marker = 0;
+    for (const auto &value: encoded_prg) {
+        bool is_site_marker = value > 4 and value % 2 == 1;
+        if (is_site_marker and value > max_site_marker)
+            max_site_marker = value;
+    }
+    if (max_site_marker == 0)
+        return 0;
+    return (max_site_marker - 5) / 2 + 1;
+}
+
+
+uint64_t gram::strand_separator(const uint64_t &strand_count_sites) {
+    if (strand_count_sites == 0)
+        return 0;
+    const uint64_t first_unused_site_marker = 5 + 4 * strand_count_sites;
+    return first_unused_site_marker + 1;
+}
+
+
+uint64_t gram::strand_separator_index(const uint64_t &symmetric_prg_size) {
+    return symmetric_prg_size / 2;
+}
+
+
+// a run of non-variant bases, or a variant site's alleles
+struct PrgSegment {
+    Marker site_marker = 0;
+    Patterns alleles;
+};
+
+
+std::vector<PrgSegment> split_prg_segments(const sdsl::int_vector<> &encoded_prg) {
+    std::vector<PrgSegment> segments;
+    PrgSegment current = {};
+    current.alleles.emplace_back();
+
+    for (const auto &value: encoded_prg) {
+        bool is_base = value <= 4;
+        if (is_base) {
+            current.alleles.back().push_back(value);
+            continue;
+        }
+
+        bool is_allele_marker = value % 2 == 0;
+        if (is_allele_marker) {
+            current.alleles.emplace_back();
+            continue;
+        }
+
+        // site boundary: close the non-variant run or the site
+        bool site_start = current.site_marker == 0;
+        if (site_start and not current.alleles.back().empty())
+            segments.emplace_back(current);
+        if (not site_start)
+            segments.emplace_back(current);
+
+        current = PrgSegment{};
+        current.alleles.emplace_back();
+        if (site_start)
+            current.site_marker = value;
+    }
+    if (not current.alleles.back().empty())
+        segments.emplace_back(current);
+    return segments;
+}
+
+
+sdsl::int_vector<> gram::generate_strand_symmetric_prg(const sdsl::int_vector<> &encoded_prg) {
+    const uint64_t strand_count_sites = count_variant_sites(encoded_prg);
+    const uint64_t marker_offset = 2 * strand_count_sites;
+    const auto segments = split_prg_segments(encoded_prg);
+
+    std::vector<uint64_t> reverse_strand;
+    reverse_strand.reserve(encoded_prg.size());
+    for (auto it = segments.rbegin(); it != segments.rend(); ++it) {
+        const auto &segment = *it;
+        if (segment.site_marker == 0) {
+            const auto bases = reverse_compliment_read(segment.alleles.front());
+            reverse_strand.insert(reverse_strand.end(), bases.begin(), bases.end());
+            continue;
+        }
+
+        const uint64_t site_marker = segment.site_marker + marker_offset;
+        reverse_strand.push_back(site_marker);
+        for (uint64_t i = 0; i < segment.alleles.size(); ++i) {
+            if (i != 0)
+                reverse_strand.push_back(site_marker + 1);
+            const auto bases = reverse_compliment_read(segment.alleles[i]);
+            reverse_strand.insert(reverse_strand.end(), bases.begin(), bases.end());
+        }
+        reverse_strand.push_back(site_marker);
+    }
+
+    sdsl::int_vector<> symmetric_prg(encoded_prg.size() + 1 + reverse_strand.size(), 0, 64);
+    uint64_t i = 0;
+    for (const auto &value: encoded_prg)
+        symmetric_prg[i++] = value;
+    symmetric_prg[i++] = strand_separator(strand_count_sites);
+    for (const auto &value: reverse_strand)
+        symmetric_prg[i++] = value;
+    sdsl::util::bit_compress(symmetric_prg);
+    return symmetric_prg;
+}
+
+
+bool gram::index_is_strand_symmetric(const uint64_t &fm_index_size,
+                                     const uint64_t &encoded_prg_size) {
+    return encoded_prg_size != 0 and fm_index_size == 2 * encoded_prg_size + 2;
+}
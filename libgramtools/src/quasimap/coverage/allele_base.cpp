@@ -1,19 +1,121 @@
+#include <algorithm>
 #include <cassert>
 #include <fstream>
 #include <vector>
+#include <omp.h>
 
 #include "search/search.hpp"
 
 #include "quasimap/utils.hpp"
+#include "quasimap/coverage/common.hpp"
 #include "quasimap/coverage/allele_base.hpp"
 
 
 using namespace gram;
 
 
+SitesAlleleBaseCoverage::SitesAlleleBaseCoverage(std::initializer_list<AlleleCoverage> sites) {
+    std::vector<std::vector<uint64_t>> sizes;
+    for (const auto &site: sites) {
+        sizes.emplace_back();
+        for (const auto &allele: site)
+            sizes.back().push_back(allele.size());
+    }
+    narrow_counts = FlatNestedCounts<BaseCount>::with_row_sizes(sizes);
+
+    uint64_t site_index = 0;
+    for (const auto &site: sites) {
+        for (uint64_t allele = 0; allele < site.size(); ++allele)
+            for (uint64_t i = 0; i < site[allele].size(); ++i)
+                add(allele_index(site_index, allele), i, site[allele][i]);
+        ++site_index;
+    }
+}
+
+
+SitesAlleleBaseCoverage SitesAlleleBaseCoverage::with_row_sizes(const std::vector<std::vector<uint64_t>> &site_row_sizes) {
+    SitesAlleleBaseCoverage allele_base_coverage;
+    allele_base_coverage.narrow_counts = FlatNestedCounts<BaseCount>::with_row_sizes(site_row_sizes);
+    return allele_base_coverage;
+}
+
+
+WideBaseCount SitesAlleleBaseCoverage::base_count(const uint64_t &allele_index, const uint64_t &base_index) const {
+    auto count = narrow_counts.all_rows()[allele_index][base_index];
+    if (count != max_base_count)
+        return count;
+    return promoted_alleles.at(allele_index)[base_index];
+}
+
+
+void SitesAlleleBaseCoverage::add(const uint64_t &allele_index, const uint64_t &base_index,
+                                  const WideBaseCount &count) {
+    if (count == 0)
+        return;
+    auto &narrow_count = narrow_counts.all_rows()[allele_index][base_index];
+    bool fits_narrow = narrow_count != max_base_count
+                       and count < (WideBaseCount) max_base_count - narrow_count;
+    if (fits_narrow) {
+        narrow_count += count;
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(promotion_mutex.mutex);
+    promoted_allele(allele_index)[base_index] += count;
+}
+
+
+void SitesAlleleBaseCoverage::increment(const uint64_t &allele_index, const uint64_t &base_index) {
+    auto &narrow_count = narrow_counts.all_rows()[allele_index][base_index];
+    auto count = __atomic_load_n(&narrow_count, __ATOMIC_RELAXED);
+    while (count < max_base_count - 1) {
+        if (__atomic_compare_exchange_n(&narrow_count, &count, (BaseCount) (count + 1), true,
+                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+            return;
+    }
+
+    std::lock_guard<std::mutex> lock(promotion_mutex.mutex);
+    ++promoted_allele(allele_index)[base_index];
+}
+
+
+std::vector<WideBaseCount> &SitesAlleleBaseCoverage::promoted_allele(const uint64_t &allele_index) {
+    auto found = promoted_alleles.find(allele_index);
+    if (found != promoted_alleles.end())
+        return found->second;
+
+    // each narrow count is swapped for max_base_count, so a concurrent increment either
+    // lands before the swap or fails its exchange and retries on the promoted counts
+    auto narrow_allele = narrow_counts.all_rows()[allele_index];
+    std::vector<WideBaseCount> wide_allele(narrow_allele.size());
+    for (uint64_t i = 0; i < narrow_allele.size(); ++i)
+        wide_allele[i] = __atomic_exchange_n(&narrow_allele[i], max_base_count, __ATOMIC_RELAXED);
+    return promoted_alleles.emplace(allele_index, std::move(wide_allele)).first->second;
+}
+
+
+bool SitesAlleleBaseCoverage::operator==(const SitesAlleleBaseCoverage &other) const {
+    if (narrow_counts.all_rows().size() != other.narrow_counts.all_rows().size()
+        or size() != other.size())
+        return false;
+    for (uint64_t site_index = 0; site_index < size(); ++site_index)
+        if ((*this)[site_index].size() != other[site_index].size())
+            return false;
+
+    for (uint64_t allele_index = 0; allele_index < count_alleles(); ++allele_index) {
+        if (allele_size(allele_index) != other.allele_size(allele_index))
+            return false;
+        for (uint64_t i = 0; i < allele_size(allele_index); ++i)
+            if (base_count(allele_index, i) != other.base_count(allele_index, i))
+                return false;
+    }
+    return true;
+}
+
+
 SitesAlleleBaseCoverage gram::coverage::generate::allele_base_structure(const PRG_Info &prg_info) {
     uint64_t number_of_variant_sites = get_number_of_variant_sites(prg_info);
-    SitesAlleleBaseCoverage allele_base_coverage(number_of_variant_sites);
+    std::vector<std::vector<uint64_t>> sites_allele_sizes(number_of_variant_sites);
 
     const auto min_boundary_marker = 5;
 
@@ -32,22 +134,75 @@ SitesAlleleBaseCoverage gram::coverage::generate::allele_base_structure(const PR
         if (no_allele_to_flush)
             continue;
 
-        BaseCoverage bases(allele_size);
         uint64_t variant_site_cover_index = (last_marker - min_boundary_marker) / 2;
-        allele_base_coverage.at(variant_site_cover_index).emplace_back(bases);
+        sites_allele_sizes.at(variant_site_cover_index).push_back(allele_size);
         allele_size = 0;
     }
-    return allele_base_coverage;
+    return SitesAlleleBaseCoverage::with_row_sizes(sites_allele_sizes);
 }
 
 
-uint64_t gram::allele_start_offset_index(const uint64_t within_allele_prg_index, const PRG_Info &prg_info) {
-    // find the nearest left marker with rank and select
-    uint64_t number_markers_before = prg_info.prg_markers_rank(within_allele_prg_index);
-    uint64_t marker_index = prg_info.prg_markers_select(number_markers_before);
-    uint64_t offset = within_allele_prg_index - marker_index - 1;
+void gram::coverage::generate::allele_base_deltas(Coverage &coverage, const uint32_t &count_threads) {
+    const auto &allele_base_coverage = coverage.allele_base_coverage;
+    std::vector<std::vector<uint64_t>> sites_delta_sizes(allele_base_coverage.size());
+    for (uint64_t site_index = 0; site_index < allele_base_coverage.size(); ++site_index) {
+        for (const auto &allele_coverage: allele_base_coverage[site_index])
+            sites_delta_sizes[site_index].push_back(allele_coverage.size() + 1);
+    }
+    coverage.allele_base_deltas = SitesAlleleBaseDeltas::with_row_sizes(sites_delta_sizes);
+    coverage.allele_base_delta_buffers = std::vector<BaseDeltasBuffer>(count_threads);
+}
 
-    return offset;
+
+void gram::flush_base_deltas(SitesAlleleBaseDeltas &allele_base_deltas, BaseDeltasBuffer &buffer) {
+    // sorted, so a base's repeated deltas cost one atomic add
+    std::sort(buffer.begin(), buffer.end());
+    auto &deltas = allele_base_deltas.all_rows().all_counts();
+    auto it = buffer.begin();
+    while (it != buffer.end()) {
+        auto delta_index = it->first;
+        int32_t delta = 0;
+        for (; it != buffer.end() and it->first == delta_index; ++it)
+            delta += it->second;
+        if (delta == 0)
+            continue;
+
+        #pragma omp atomic
+        deltas[delta_index] += delta;
+    }
+    buffer.clear();
+}
+
+
+void gram::coverage::generate::allele_base_from_deltas(Coverage &coverage) {
+    for (auto &buffer: coverage.allele_base_delta_buffers)
+        flush_base_deltas(coverage.allele_base_deltas, buffer);
+
+    // coverage and deltas share the same allele rows, delta rows are one element longer
+    auto &allele_base_coverage = coverage.allele_base_coverage;
+    auto &alleles_deltas = coverage.allele_base_deltas.all_rows();
+    const uint64_t count_alleles = allele_base_coverage.count_alleles();
+
+    #pragma omp parallel for schedule(dynamic, 256)
+    for (uint64_t allele_index = 0; allele_index < count_alleles; ++allele_index) {
+        auto allele_deltas = alleles_deltas[allele_index];
+
+        int64_t base_count = 0;
+        for (uint64_t i = 0; i < allele_deltas.size() - 1; ++i) {
+            base_count += allele_deltas[i];
+            allele_deltas[i] = 0;
+            allele_base_coverage.add(allele_index, i, (WideBaseCount) base_count);
+        }
+        allele_deltas.back() = 0;
+    }
+}
+
+
+uint64_t gram::allele_start_offset_index(const uint64_t within_allele_prg_index, const PRG_Info &prg_info) {
+    Marker site_marker = prg_info.sites_mask[within_allele_prg_index];
+    AlleleId allele_id = prg_info.allele_mask[within_allele_prg_index];
+    auto allele_start = allele_start_prg_index(VariantSite{site_marker, allele_id}, prg_info.site_table);
+    return within_allele_prg_index - allele_start;
 }
 
 
@@ -59,55 +214,64 @@ uint64_t gram::set_site_base_coverage(Coverage &coverage,
     auto marker = path_element.first;
     auto min_boundary_marker = 5;
     auto variant_site_coverage_index = (marker - min_boundary_marker) / 2;
-    auto &site_coverage = coverage.allele_base_coverage.at(variant_site_coverage_index);
+    auto site_coverage = coverage.allele_base_coverage[variant_site_coverage_index];
 
     auto allele_id = path_element.second;
     auto allele_coverage_index = allele_id - 1;
-    auto &allele_coverage = site_coverage.at(allele_coverage_index);
+    assert(allele_coverage_index < site_coverage.size());
+    auto allele_coverage = site_coverage[allele_coverage_index];
 
     uint64_t index_end_boundary = std::min(allele_coverage_offset + max_bases_to_set, allele_coverage.size());
     assert(index_end_boundary >= allele_coverage_offset);
     uint64_t count_bases_consumed = index_end_boundary - allele_coverage_offset;
 
     uint64_t index_start_boundary = allele_coverage_offset;
-    bool site_seen_previously = sites_coverage_boundaries.find(path_element) != sites_coverage_boundaries.end();
-    if (site_seen_previously)
-        index_start_boundary = std::max(allele_coverage_offset, sites_coverage_boundaries[path_element]);
-    sites_coverage_boundaries[path_element] = index_end_boundary;
-
-    for (uint64_t i = index_start_boundary; i < index_end_boundary; ++i) {
-        if (allele_coverage[i] == UINT16_MAX)
-            continue;
-
-        #pragma omp atomic
-        ++allele_coverage[i];
+    auto boundary_it = std::lower_bound(sites_coverage_boundaries.begin(), sites_coverage_boundaries.end(),
+                                        path_element,
+                                        [](const std::pair<VariantSite, uint64_t> &entry,
+                                           const VariantSite &site) {
+                                            return entry.first < site;
+                                        });
+    bool site_seen_previously = boundary_it != sites_coverage_boundaries.end()
+                                and boundary_it->first == path_element;
+    if (site_seen_previously) {
+        index_start_boundary = std::max(allele_coverage_offset, boundary_it->second);
+        boundary_it->second = index_end_boundary;
+    } else {
+        sites_coverage_boundaries.insert(boundary_it, std::make_pair(path_element, index_end_boundary));
     }
-    return count_bases_consumed;
-}
-
 
-std::pair<uint64_t, uint64_t> site_marker_prg_indexes(const uint64_t &site_marker, const PRG_Info &prg_info) {
-    auto alphabet_rank = prg_info.fm_index.char2comp[site_marker];
-    auto first_sa_index = prg_info.fm_index.C[alphabet_rank];
-    auto second_sa_index = first_sa_index + 1;
-
-    auto first_prg_index = prg_info.fm_index[first_sa_index];
-    auto second_prg_index = prg_info.fm_index[second_sa_index];
+    // deferred: only the covered interval's bounds, materialised by allele_base_from_deltas
+    bool record_deltas = not coverage.allele_base_delta_buffers.empty();
+    if (record_deltas) {
+        if (index_start_boundary < index_end_boundary) {
+            auto &buffer = coverage.allele_base_delta_buffers[omp_get_thread_num()];
+            auto allele_deltas = coverage.allele_base_deltas[variant_site_coverage_index][allele_coverage_index];
+            uint64_t allele_deltas_index = allele_deltas.begin()
+                                           - coverage.allele_base_deltas.all_rows().all_counts().data();
+            buffer.emplace_back(allele_deltas_index + index_start_boundary, 1);
+            buffer.emplace_back(allele_deltas_index + index_end_boundary, -1);
+            if (buffer.size() >= max_buffered_base_deltas)
+                flush_base_deltas(coverage.allele_base_deltas, buffer);
+        }
+        return count_bases_consumed;
+    }
 
-    if (first_prg_index < second_prg_index)
-        return std::make_pair(first_prg_index, second_prg_index);
-    else
-        return std::make_pair(second_prg_index, first_prg_index);
+    auto allele_index = coverage.allele_base_coverage.allele_index(variant_site_coverage_index,
+                                                                   allele_coverage_index);
+    for (uint64_t i = index_start_boundary; i < index_end_boundary; ++i)
+        coverage.allele_base_coverage.increment(allele_index, i);
+    return count_bases_consumed;
 }
 
 
 uint64_t gram::inter_site_base_count(const uint64_t &first_site_marker,
                                const uint64_t &second_site_marker,
                                const PRG_Info &prg_info) {
-    auto first_site_prg_start_end = site_marker_prg_indexes(first_site_marker, prg_info);
+    auto first_site_prg_start_end = site_prg_indexes(first_site_marker, prg_info.site_table);
     auto first_site_prg_end = first_site_prg_start_end.second;
 
-    auto second_site_prg_start_end = site_marker_prg_indexes(second_site_marker, prg_info);
+    auto second_site_prg_start_end = site_prg_indexes(second_site_marker, prg_info.site_table);
     auto second_site_prg_start = second_site_prg_start_end.first;
 
     return second_site_prg_start - first_site_prg_end - 1;
@@ -143,7 +307,7 @@ void sa_index_allele_base_coverage(Coverage &coverage,
         // forward to first path element
         const auto &path_element = *path_it;
         auto site_marker = path_element.first;
-        auto site_prg_start_end = site_marker_prg_indexes(site_marker, prg_info);
+        auto site_prg_start_end = site_prg_indexes(site_marker, prg_info.site_table);
         read_bases_consumed += site_prg_start_end.first - read_start_index;
     }
 
@@ -173,14 +337,27 @@ void coverage::record::allele_base(Coverage &coverage,
                                    const SearchStates &search_states,
                                    const uint64_t &read_length,
                                    const PRG_Info &prg_info) {
-    SitesCoverageBoundaries sites_coverage_boundaries;
+    RecordScratch scratch;
+    auto selected_search_states = get_selected_search_states(search_states);
+    coverage::record::allele_base(coverage, scratch, selected_search_states, read_length, prg_info);
+}
 
-    for (const auto &search_state: search_states) {
+
+void coverage::record::allele_base(Coverage &coverage,
+                                   RecordScratch &scratch,
+                                   const SelectedSearchStates &selected_search_states,
+                                   const uint64_t &read_length,
+                                   const PRG_Info &prg_info) {
+    auto &sites_coverage_boundaries = scratch.sites_coverage_boundaries;
+    sites_coverage_boundaries.clear();
+
+    for (const auto &selected: selected_search_states) {
+        const auto &search_state = *selected.search_state;
         if (search_state.variant_site_path.empty())
             continue;
 
-        auto first_sa_index = search_state.sa_interval.first;
-        auto last_sa_index = search_state.sa_interval.second;
+        auto first_sa_index = selected.sa_interval.first;
+        auto last_sa_index = selected.sa_interval.second;
         for (auto sa_index = first_sa_index; sa_index <= last_sa_index; ++sa_index)
             sa_index_allele_base_coverage(coverage,
                                           sites_coverage_boundaries,
@@ -192,13 +369,13 @@ void coverage::record::allele_base(Coverage &coverage,
 }
 
 
-std::string dump_allele(const BaseCoverage &allele) {
+std::string dump_allele(const SitesAlleleBaseCoverage &sites, const uint64_t &allele_index) {
     std::stringstream stream;
     stream << "[";
-    auto i = 0;
-    for (const auto &base_coverage: allele) {
-        stream << (int) base_coverage;
-        if (i++ < allele.size() - 1)
+    const auto allele_size = sites.allele_size(allele_index);
+    for (uint64_t i = 0; i < allele_size; ++i) {
+        stream << sites.base_count(allele_index, i);
+        if (i < allele_size - 1)
             stream << ",";
     }
     stream << "]";
@@ -206,12 +383,12 @@ std::string dump_allele(const BaseCoverage &allele) {
 }
 
 
-std::string dump_site(const AlleleCoverage &site) {
+std::string dump_site(const SitesAlleleBaseCoverage &sites, const uint64_t &site_index) {
     std::stringstream stream;
-    auto i = 0;
-    for (const auto &allele: site) {
-        stream << dump_allele(allele);
-        if (i++ < site.size() - 1)
+    const auto count_alleles = sites[site_index].size();
+    for (uint64_t allele = 0; allele < count_alleles; ++allele) {
+        stream << dump_allele(sites, sites.allele_index(site_index, allele));
+        if (allele < count_alleles - 1)
             stream << ",";
     }
     return stream.str();
@@ -220,12 +397,11 @@ std::string dump_site(const AlleleCoverage &site) {
 
 std::string dump_sites(const SitesAlleleBaseCoverage &sites) {
     std::stringstream stream;
-    auto i = 0;
-    for (const auto &site: sites) {
+    for (uint64_t site_index = 0; site_index < sites.size(); ++site_index) {
         stream << "[";
-        stream << dump_site(site);
+        stream << dump_site(sites, site_index);
         stream << "]";
-        if (i++ < sites.size() - 1)
+        if (site_index < sites.size() - 1)
             stream << ",";
     }
     return stream.str();
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <cassert>
 #include <fstream>
 #include <vector>
@@ -5,6 +6,7 @@
 #include "search/search.hpp"
 
 #include "quasimap/utils.hpp"
+#include "quasimap/coverage/common.hpp"
 #include "quasimap/coverage/allele_sum.hpp"
 
 
@@ -13,7 +15,7 @@ using namespace gram;
 
 AlleleSumCoverage gram::coverage::generate::allele_sum_structure(const PRG_Info &prg_info) {
     uint64_t numer_of_variant_sites = get_number_of_variant_sites(prg_info);
-    AlleleSumCoverage allele_sum_coverage(numer_of_variant_sites);
+    std::vector<uint64_t> sites_allele_counts(numer_of_variant_sites, 0);
 
     const auto min_boundary_marker = 5;
     bool last_char_was_zero = true;
@@ -27,22 +29,33 @@ AlleleSumCoverage gram::coverage::generate::allele_sum_structure(const PRG_Info
         const auto &current_marker = mask_value;
         if (last_char_was_zero) {
             auto variant_site_cover_index = (current_marker - min_boundary_marker) / 2;
-            allele_sum_coverage[variant_site_cover_index].push_back(0);
+            ++sites_allele_counts[variant_site_cover_index];
             last_char_was_zero = false;
         }
     }
-    return allele_sum_coverage;
+    return AlleleSumCoverage::with_row_sizes(sites_allele_counts);
 }
 
 
 void gram::coverage::record::allele_sum(Coverage &coverage,
                                         const SearchStates &search_states) {
+    RecordScratch scratch;
+    auto selected_search_states = get_selected_search_states(search_states);
+    coverage::record::allele_sum(coverage, scratch, selected_search_states);
+}
+
+
+void gram::coverage::record::allele_sum(Coverage &coverage,
+                                        RecordScratch &scratch,
+                                        const SelectedSearchStates &selected_search_states) {
     auto &allele_sum_coverage = coverage.allele_sum_coverage;
-    HashSet<VariantSite> seen_sites;
+    auto &seen_sites = scratch.seen_sites;
+    seen_sites.clear();
 
-    for (const auto &search_state: search_states) {
-        for (const auto &variant_site: search_state.variant_site_path) {
-            bool site_seen_previously = seen_sites.find(variant_site) != seen_sites.end();
+    for (const auto &selected: selected_search_states) {
+        for (const auto &variant_site: selected.search_state->variant_site_path) {
+            auto it = std::lower_bound(seen_sites.begin(), seen_sites.end(), variant_site);
+            bool site_seen_previously = it != seen_sites.end() and *it == variant_site;
             if (site_seen_previously)
                 continue;
 
@@ -55,7 +68,7 @@ void gram::coverage::record::allele_sum(Coverage &coverage,
 
             #pragma omp atomic
             allele_sum_coverage[site_coverage_index][allele_coverage_index] += 1;
-            seen_sites.insert(variant_site);
+            seen_sites.insert(it, variant_site);
         }
     }
 }
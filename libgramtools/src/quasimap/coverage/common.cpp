@@ -1,8 +1,8 @@
+#include <algorithm>
 #include <unordered_set>
+#include <omp.h>
 
-#include <boost/random.hpp>
-#include <boost/generator_iterator.hpp>
-#include <boost/nondet_random.hpp>
+#include "common/random.hpp"
 
 #include "quasimap/coverage/allele_sum.hpp"
 #include "quasimap/coverage/allele_base.hpp"
@@ -20,27 +20,24 @@ bool gram::check_allele_encapsulated(const SearchState &search_state,
     bool single_allele_path = search_state.variant_site_path.size() == 1;
     bool start_within_allele = search_state.variant_site_state
                                == SearchVariantSiteState::within_variant_site;
-
-    bool end_within_allele = true;
-    for (SA_Index sa_index = search_state.sa_interval.first;
-         sa_index <= search_state.sa_interval.second;
-         ++sa_index) {
-        auto start_index = prg_info.fm_index[sa_index];
-        auto start_site_marker = prg_info.sites_mask[start_index];
-        auto start_allele_id = prg_info.allele_mask[start_index];
-
-        auto end_index = start_index + read_length - 1;
-        assert(end_index < prg_info.encoded_prg.size());
-
-        auto end_site_marker = prg_info.sites_mask[end_index];
-        auto end_allele_id = prg_info.allele_mask[end_index];
-        end_within_allele = (start_site_marker == end_site_marker)
-                            and (start_allele_id == end_allele_id);
-        if (not end_within_allele)
-            break;
-    }
-
-    return single_allele_path and start_within_allele and end_within_allele;
+    if (not single_allele_path or not start_within_allele)
+        return false;
+
+    // all mappings of a search state cross the same markers: either none, and every mapping
+    // ends within the start allele, or the site exit, and none do; the first mapping decides
+    auto sa_index = search_state.sa_interval.first;
+    auto run_index = prg_info.sa_allele_runs_rank(sa_index + 1) - 1;
+    Marker start_site_marker = prg_info.sa_allele_runs.site_markers[run_index];
+    AlleleId start_allele_id = prg_info.sa_allele_runs.allele_ids[run_index];
+
+    auto start_index = prg_info.fm_index[sa_index];
+    auto end_index = start_index + read_length - 1;
+    assert(end_index < prg_info.encoded_prg.size());
+
+    auto end_site_marker = prg_info.sites_mask[end_index];
+    auto end_allele_id = prg_info.allele_mask[end_index];
+    return (start_site_marker == end_site_marker)
+           and (start_allele_id == end_allele_id);
 }
 
 
@@ -55,45 +52,11 @@ bool gram::multiple_allele_encapsulated(const SearchState &search_state,
 }
 
 
-SearchState random_select_single_mapping(const SearchState &search_state,
-                                         const uint32_t &random_seed) {
-    uint32_t actual_seed = 0;
-    if (random_seed == 0) {
-        boost::random_device seed_generator;
-        actual_seed = seed_generator();
-    } else {
-        actual_seed = random_seed;
-    }
-    boost::mt19937 random_number_generator(actual_seed);
-
-    boost::uniform_int<> range((int) search_state.sa_interval.first, (int) search_state.sa_interval.second);
-    using Generator = boost::variate_generator<boost::mt19937, boost::uniform_int<>>;
-    Generator generate_random_number(random_number_generator, range);
-    auto selected_sa_index = (SA_Index) generate_random_number();
-
-    SearchState single_mapping_search_state = search_state;
-    single_mapping_search_state.sa_interval.first = selected_sa_index;
-    single_mapping_search_state.sa_interval.second = selected_sa_index;
-    return single_mapping_search_state;
-}
-
-
 uint64_t gram::random_int_inclusive(const uint64_t &min,
                                     const uint64_t &max,
                                     const uint64_t &random_seed) {
-    uint64_t actual_seed = 0;
-    if (random_seed == 0) {
-        boost::random_device seed_generator;
-        actual_seed = seed_generator();
-    } else {
-        actual_seed = random_seed;
-    }
-    boost::mt19937 random_number_generator((uint32_t) actual_seed);
-
-    boost::uniform_int<> range((uint32_t) min, (uint32_t) max);
-    using Generator = boost::variate_generator<boost::mt19937, boost::uniform_int<>>;
-    Generator generate_random_number(random_number_generator, range);
-    return (uint64_t) generate_random_number();
+    SplitMix64 generator(random_seed);
+    return uniform_int_inclusive(generator, min, max);
 }
 
 
@@ -145,37 +108,83 @@ SearchStates gram::filter_for_path_sites(const PathSites &target_path_sites,
 }
 
 
-SearchStates selection(const SearchStates &search_states,
-                       const uint64_t &read_length,
-                       const PRG_Info &prg_info,
-                       const uint32_t &random_seed) {
-    uint64_t nonvariant_count = count_nonvariant_search_states(search_states);
-    auto path_sites = get_unique_path_sites(search_states);
+SelectedSearchStates gram::get_selected_search_states(const SearchStates &search_states) {
+    SelectedSearchStates selected_search_states = {};
+    for (const auto &search_state: search_states)
+        selected_search_states.emplace_back(SelectedSearchState{&search_state, search_state.sa_interval});
+    return selected_search_states;
+}
+
+
+bool path_sites_less(const SearchState *lhs, const SearchState *rhs) {
+    const auto &lhs_path = lhs->variant_site_path;
+    const auto &rhs_path = rhs->variant_site_path;
+    return std::lexicographical_compare(lhs_path.begin(), lhs_path.end(),
+                                        rhs_path.begin(), rhs_path.end(),
+                                        [](const VariantSite &lhs_site, const VariantSite &rhs_site) {
+                                            return lhs_site.first < rhs_site.first;
+                                        });
+}
+
+
+bool path_sites_equal(const SearchState *lhs, const SearchState *rhs) {
+    const auto &lhs_path = lhs->variant_site_path;
+    const auto &rhs_path = rhs->variant_site_path;
+    return std::equal(lhs_path.begin(), lhs_path.end(),
+                      rhs_path.begin(), rhs_path.end(),
+                      [](const VariantSite &lhs_site, const VariantSite &rhs_site) {
+                          return lhs_site.first == rhs_site.first;
+                      });
+}
 
-    uint64_t count_total_options = nonvariant_count + path_sites.size();
+
+void gram::select_search_states(RecordScratch &scratch,
+                                const SearchStates &search_states,
+                                const uint64_t &read_length,
+                                const PRG_Info &prg_info,
+                                const uint64_t &random_seed) {
+    SplitMix64 generator(random_seed);
+    auto &selected_search_states = scratch.selected_search_states;
+    selected_search_states.clear();
+
+    // one search state per distinct path sites, ordered as get_unique_path_sites orders them
+    auto &path_search_states = scratch.unique_path_search_states;
+    path_search_states.clear();
+    for (const auto &search_state: search_states) {
+        if (not search_state.variant_site_path.empty())
+            path_search_states.push_back(&search_state);
+    }
+    std::sort(path_search_states.begin(), path_search_states.end(), path_sites_less);
+    auto unique_end = std::unique(path_search_states.begin(), path_search_states.end(), path_sites_equal);
+    path_search_states.erase(unique_end, path_search_states.end());
+
+    uint64_t nonvariant_count = count_nonvariant_search_states(search_states);
+    uint64_t count_total_options = nonvariant_count + path_search_states.size();
     if (count_total_options == 0)
-        return SearchStates{};
-    uint64_t selected_option = random_int_inclusive(1, count_total_options, random_seed);
+        return;
+    uint64_t selected_option = uniform_int_inclusive(generator, 1, count_total_options);
 
     bool selected_no_path = selected_option <= nonvariant_count;
     if (selected_no_path)
-        return SearchStates{};
+        return;
 
     uint64_t paths_sites_offset = selected_option - nonvariant_count - 1;
-    auto it = path_sites.begin();
-    std::advance(it, paths_sites_offset);
-    auto selected_path_sites = *it;
+    const auto *selected_path = path_search_states[paths_sites_offset];
 
-    auto selected_search_states = filter_for_path_sites(selected_path_sites, search_states);
+    for (const auto &search_state: search_states) {
+        if (path_sites_equal(&search_state, selected_path))
+            selected_search_states.emplace_back(SelectedSearchState{&search_state, search_state.sa_interval});
+    }
     if (selected_search_states.size() > 1)
-        return selected_search_states;
-
-    auto search_state = selected_search_states.front();
-    if (multiple_allele_encapsulated(search_state, read_length, prg_info)) {
-        search_state = random_select_single_mapping(search_state,
-                                                    random_seed);
+        return;
+
+    auto &selected = selected_search_states.front();
+    if (multiple_allele_encapsulated(*selected.search_state, read_length, prg_info)) {
+        auto sa_index = (SA_Index) uniform_int_inclusive(generator,
+                                                         selected.sa_interval.first,
+                                                         selected.sa_interval.second);
+        selected.sa_interval = SA_Interval{sa_index, sa_index};
     }
-    return SearchStates{search_state};
 }
 
 
@@ -183,15 +192,17 @@ void coverage::record::search_states(Coverage &coverage,
                                      const SearchStates &search_states,
                                      const uint64_t &read_length,
                                      const PRG_Info &prg_info,
-                                     const uint32_t &random_seed) {
-    SearchStates selected_search_states = selection(search_states,
-                                                    read_length,
-                                                    prg_info,
-                                                    random_seed);
-
-    coverage::record::allele_sum(coverage, selected_search_states);
-    coverage::record::grouped_allele_counts(coverage, selected_search_states);
-    coverage::record::allele_base(coverage, selected_search_states, read_length, prg_info);
+                                     const uint64_t &random_seed) {
+    RecordScratch read_scratch;
+    bool thread_scratch = not coverage.record_scratches.empty();
+    auto &scratch = thread_scratch ? coverage.record_scratches[omp_get_thread_num()] : read_scratch;
+
+    select_search_states(scratch, search_states, read_length, prg_info, random_seed);
+    const auto &selected_search_states = scratch.selected_search_states;
+
+    coverage::record::allele_sum(coverage, scratch, selected_search_states);
+    coverage::record::grouped_allele_counts(coverage, scratch, selected_search_states);
+    coverage::record::allele_base(coverage, scratch, selected_search_states, read_length, prg_info);
 }
 
 
@@ -209,4 +220,50 @@ Coverage coverage::generate::empty_structure(const PRG_Info &prg_info) {
     coverage.allele_base_coverage = coverage::generate::allele_base_structure(prg_info);
     coverage.grouped_allele_counts = coverage::generate::grouped_allele_counts(prg_info);
     return coverage;
-}
\ No newline at end of file
+}
+
+
+void coverage::generate::fold_strand_symmetric(Coverage &coverage, const uint64_t &strand_count_sites) {
+    std::vector<uint64_t> allele_sum_sizes;
+    std::vector<std::vector<uint64_t>> allele_base_sizes;
+    for (uint64_t site = 0; site < strand_count_sites; ++site) {
+        allele_sum_sizes.push_back(coverage.allele_sum_coverage[site].size());
+        allele_base_sizes.emplace_back();
+        for (const auto &allele_coverage: coverage.allele_base_coverage[site])
+            allele_base_sizes.back().push_back(allele_coverage.size());
+    }
+    auto allele_sum_coverage = AlleleSumCoverage::with_row_sizes(allele_sum_sizes);
+    auto allele_base_coverage = SitesAlleleBaseCoverage::with_row_sizes(allele_base_sizes);
+
+    for (uint64_t site = 0; site < strand_count_sites; ++site) {
+        const uint64_t reverse_site = site + strand_count_sites;
+
+        auto allele_sums = allele_sum_coverage[site];
+        for (uint64_t allele = 0; allele < allele_sums.size(); ++allele)
+            allele_sums[allele] = coverage.allele_sum_coverage[site][allele]
+                                  + coverage.allele_sum_coverage[reverse_site][allele];
+
+        // a reverse complement allele's bases run in reverse order
+        const auto &base_coverage = coverage.allele_base_coverage;
+        for (uint64_t allele = 0; allele < allele_base_coverage[site].size(); ++allele) {
+            auto allele_index = allele_base_coverage.allele_index(site, allele);
+            auto forward_index = base_coverage.allele_index(site, allele);
+            auto reverse_index = base_coverage.allele_index(reverse_site, allele);
+            const auto allele_size = allele_base_coverage.allele_size(allele_index);
+            for (uint64_t i = 0; i < allele_size; ++i) {
+                auto total_count = base_coverage.base_count(forward_index, i)
+                                   + base_coverage.base_count(reverse_index, allele_size - 1 - i);
+                allele_base_coverage.add(allele_index, i, total_count);
+            }
+        }
+
+        // group IDs are shared by all sites
+        auto &site_group_counts = coverage.grouped_allele_counts[site];
+        for (const auto &reverse_group_count: coverage.grouped_allele_counts[reverse_site])
+            site_group_counts[reverse_group_count.first] += reverse_group_count.second;
+    }
+
+    coverage.allele_sum_coverage = allele_sum_coverage;
+    coverage.allele_base_coverage = allele_base_coverage;
+    coverage.grouped_allele_counts.resize(strand_count_sites);
+}
@@ -1,49 +1,225 @@
+#include <algorithm>
 #include <fstream>
+#include <mutex>
+#include <numeric>
+#include <shared_mutex>
 #include <vector>
 
 #include "search/search.hpp"
 
 #include "quasimap/utils.hpp"
+#include "quasimap/coverage/common.hpp"
 #include "quasimap/coverage/grouped_allele_counts.hpp"
 
 
 using namespace gram;
 
 
-SitesGroupedAlleleCounts coverage::generate::grouped_allele_counts(const PRG_Info &prg_info) {
+SitesAlleleGroupCounts coverage::generate::grouped_allele_counts(const PRG_Info &prg_info) {
     uint64_t numer_of_variant_sites = get_number_of_variant_sites(prg_info);
-    SitesGroupedAlleleCounts grouped_allele_counts(numer_of_variant_sites);
+    SitesAlleleGroupCounts grouped_allele_counts(numer_of_variant_sites);
     return grouped_allele_counts;
 }
 
 
+void gram::insert_allele_id(AlleleGroup &allele_group, const AlleleId &allele_id) {
+    const uint64_t bitset_size = 64;
+    bool spilled = not allele_group.spilled_ids.empty();
+    if (not spilled and allele_id < bitset_size) {
+        allele_group.bitset |= (uint64_t) 1 << allele_id;
+        return;
+    }
+
+    if (not spilled) {
+        allele_group.spilled_ids = get_allele_ids(allele_group);
+        allele_group.bitset = 0;
+    }
+    auto &ids = allele_group.spilled_ids;
+    auto it = std::lower_bound(ids.begin(), ids.end(), allele_id);
+    if (it == ids.end() or *it != allele_id)
+        ids.insert(it, allele_id);
+}
+
+
+AlleleIds gram::get_allele_ids(const AlleleGroup &allele_group) {
+    if (not allele_group.spilled_ids.empty())
+        return allele_group.spilled_ids;
+
+    AlleleIds allele_ids;
+    auto bitset = allele_group.bitset;
+    while (bitset != 0) {
+        allele_ids.push_back((AlleleId) __builtin_ctzll(bitset));
+        bitset &= bitset - 1;
+    }
+    return allele_ids;
+}
+
+
+AlleleGroupId gram::intern_allele_group(AlleleGroupTable &allele_groups,
+                                        const AlleleGroup &allele_group) {
+    auto found = allele_groups.group_ids.find(allele_group);
+    if (found != allele_groups.group_ids.end())
+        return found->second;
+
+    AlleleGroupId group_id = allele_groups.groups.size();
+    allele_groups.groups.push_back(allele_group);
+    allele_groups.group_ids[allele_group] = group_id;
+    return group_id;
+}
+
+
 void coverage::record::grouped_allele_counts(Coverage &coverage,
                                              const SearchStates &search_states) {
-    using AlleleIdSet = std::set<AlleleId>;
-    std::unordered_map<Marker, AlleleIdSet> site_allele_group;
+    RecordScratch scratch;
+    auto selected_search_states = get_selected_search_states(search_states);
+    coverage::record::grouped_allele_counts(coverage, scratch, selected_search_states);
+}
+
 
-    for (const auto &search_state: search_states) {
-        for (const auto &variant_site: search_state.variant_site_path) {
+// few distinct groups exist, so after the first reads the shared lock's lookup finds them
+static AlleleGroupId shared_intern_allele_group(Coverage &coverage, const AlleleGroup &allele_group) {
+    auto &allele_groups_mutex = coverage.grouped_counts_locks.allele_groups_mutex;
+    {
+        std::shared_lock<std::shared_mutex> lock(allele_groups_mutex);
+        auto found = coverage.allele_groups.group_ids.find(allele_group);
+        if (found != coverage.allele_groups.group_ids.end())
+            return found->second;
+    }
+    std::unique_lock<std::shared_mutex> lock(allele_groups_mutex);
+    return intern_allele_group(coverage.allele_groups, allele_group);
+}
+
+
+void coverage::record::grouped_allele_counts(Coverage &coverage,
+                                             RecordScratch &scratch,
+                                             const SelectedSearchStates &selected_search_states) {
+    // a read's path crosses few sites: a linear scan finds each site's group
+    auto &site_allele_groups = scratch.site_allele_groups;
+    site_allele_groups.clear();
+
+    for (const auto &selected: selected_search_states) {
+        for (const auto &variant_site: selected.search_state->variant_site_path) {
             auto site_marker = variant_site.first;
             auto allele_id = variant_site.second - 1;
-            site_allele_group[site_marker].insert(allele_id);
+
+            auto it = std::find_if(site_allele_groups.begin(), site_allele_groups.end(),
+                                   [&](const std::pair<Marker, AlleleGroup> &entry) {
+                                       return entry.first == site_marker;
+                                   });
+            if (it == site_allele_groups.end()) {
+                site_allele_groups.emplace_back(std::make_pair(site_marker, AlleleGroup{}));
+                it = site_allele_groups.end() - 1;
+            }
+            insert_allele_id(it->second, allele_id);
         }
     }
 
-    for (const auto &entry: site_allele_group) {
+    for (const auto &entry: site_allele_groups) {
         auto site_marker = entry.first;
-        auto allele_ids_set = entry.second;
-        AlleleIds allele_ids;
-        std::copy(allele_ids_set.begin(), allele_ids_set.end(),
-                  std::back_inserter(allele_ids));
+        const auto &allele_group = entry.second;
 
         auto min_boundary_marker = 5;
         auto site_coverage_index = (site_marker - min_boundary_marker) / 2;
 
-        auto &site_coverage = coverage.grouped_allele_counts[site_coverage_index];
-        #pragma omp atomic
-        site_coverage[allele_ids] += 1;
+        auto group_id = shared_intern_allele_group(coverage, allele_group);
+        std::lock_guard<std::mutex> lock(coverage.grouped_counts_locks.site_lock(site_coverage_index));
+        ++coverage.grouped_allele_counts[site_coverage_index][group_id];
+    }
+}
+
+
+std::vector<AlleleGroupId> gram::canonical_group_ids(const AlleleGroupTable &allele_groups) {
+    const auto &groups = allele_groups.groups;
+    std::vector<AlleleGroupId> ordered_group_ids(groups.size());
+    std::iota(ordered_group_ids.begin(), ordered_group_ids.end(), 0);
+    std::sort(ordered_group_ids.begin(), ordered_group_ids.end(),
+              [&groups](const AlleleGroupId &lhs, const AlleleGroupId &rhs) {
+                  return get_allele_ids(groups[lhs]) < get_allele_ids(groups[rhs]);
+              });
+
+    std::vector<AlleleGroupId> canonical_ids(groups.size());
+    for (uint64_t i = 0; i < ordered_group_ids.size(); ++i)
+        canonical_ids[ordered_group_ids[i]] = i;
+    return canonical_ids;
+}
+
+
+SitesGroupedAlleleCounts gram::get_grouped_allele_counts(const Coverage &coverage) {
+    SitesGroupedAlleleCounts sites(coverage.grouped_allele_counts.size());
+    for (uint64_t i = 0; i < sites.size(); ++i) {
+        for (const auto &group_count: coverage.grouped_allele_counts[i]) {
+            const auto &allele_group = coverage.allele_groups.groups[group_count.first];
+            sites[i][get_allele_ids(allele_group)] = group_count.second;
+        }
+    }
+    return sites;
+}
+
+
+std::string dump_interned_site_counts(const SitesAlleleGroupCounts &sites,
+                                      const std::vector<AlleleGroupId> &canonical_ids) {
+    std::stringstream stream;
+    stream << "\"site_counts\":[";
+    std::vector<std::pair<AlleleGroupId, uint64_t>> site_counts;
+    auto i = 0;
+    for (const auto &site: sites) {
+        site_counts.clear();
+        for (const auto &group_count: site)
+            site_counts.emplace_back(canonical_ids[group_count.first], group_count.second);
+        std::sort(site_counts.begin(), site_counts.end());
+
+        stream << "{";
+        auto j = 0;
+        for (const auto &group_count: site_counts) {
+            stream << "\"" << group_count.first << "\":" << group_count.second;
+            if (j++ < site_counts.size() - 1)
+                stream << ",";
+        }
+        stream << "}";
+        if (i++ < sites.size() - 1)
+            stream << ",";
     }
+    stream << "]";
+    return stream.str();
+}
+
+
+std::string dump_interned_allele_groups(const AlleleGroupTable &allele_groups,
+                                        const std::vector<AlleleGroupId> &canonical_ids) {
+    std::vector<const AlleleGroup *> canonical_groups(allele_groups.groups.size());
+    for (uint64_t group_id = 0; group_id < allele_groups.groups.size(); ++group_id)
+        canonical_groups[canonical_ids[group_id]] = &allele_groups.groups[group_id];
+
+    std::stringstream stream;
+    stream << "\"allele_groups\":{";
+    for (uint64_t group_id = 0; group_id < canonical_groups.size(); ++group_id) {
+        auto allele_ids_group = get_allele_ids(*canonical_groups[group_id]);
+        stream << "\"" << group_id << "\":[";
+        auto j = 0;
+        for (const auto &allele_id: allele_ids_group) {
+            stream << (int) allele_id;
+            if (j++ < allele_ids_group.size() - 1)
+                stream << ",";
+        }
+        stream << "]";
+        if (group_id < allele_groups.groups.size() - 1)
+            stream << ",";
+    }
+    stream << "}";
+    return stream.str();
+}
+
+
+std::string gram::dump_grouped_allele_counts(const Coverage &coverage) {
+    std::stringstream stream;
+    // renumbered over the small group table only, so output does not depend on thread order
+    auto canonical_ids = canonical_group_ids(coverage.allele_groups);
+    stream << "{\"grouped_allele_counts\":{";
+    stream << dump_interned_site_counts(coverage.grouped_allele_counts, canonical_ids);
+    stream << ",";
+    stream << dump_interned_allele_groups(coverage.allele_groups, canonical_ids);
+    stream << "}}";
+    return stream.str();
 }
 
 
@@ -135,7 +311,7 @@ std::string gram::dump_grouped_allele_counts(const SitesGroupedAlleleCounts &sit
 
 void coverage::dump::grouped_allele_counts(const Coverage &coverage,
                                            const Parameters &parameters) {
-    std::string json_string = dump_grouped_allele_counts(coverage.grouped_allele_counts);
+    std::string json_string = dump_grouped_allele_counts(coverage);
     std::ofstream file;
     file.open(parameters.grouped_allele_counts_fpath);
     file << json_string << std::endl;
@@ -1,3 +1,5 @@
+#include <iostream>
+
 #include "common/utils.hpp"
 #include "quasimap/quasimap.hpp"
 #include "quasimap/parameters.hpp"
@@ -19,7 +21,28 @@ Parameters commands::quasimap::parse_parameters(po::variables_map &vm,
                                 ("run-directory", po::value<std::string>(),
                                  "a directory which contains all quasimap output files")
                                 ("max-threads", po::value<uint32_t>()->default_value(1),
-                                 "maximum number of threads used");
+                                 "maximum number of threads used")
+                                ("seed", po::value<uint64_t>()->default_value(0),
+                                 "seed for choosing between multiple mappings, same seed gives same coverage")
+                                ("max-search-states", po::value<uint64_t>()->default_value(0),
+                                 "abandon reads with more live search states (0: no limit)")
+                                ("max-sa-interval-width", po::value<uint64_t>()->default_value(0),
+                                 "abandon reads ending with a wider search state SA interval (0: no limit)")
+                                ("max-marker-crossings", po::value<uint64_t>()->default_value(0),
+                                 "abandon reads crossing more variant site markers (0: no limit)")
+                                ("read-cache-size", po::value<uint64_t>()->default_value(0),
+                                 "number of distinct reads whose search results are cached (0: no cache)")
+                                ("max-extended-seeds", po::value<uint64_t>()->default_value(0),
+                                 "number of read suffixes longer than a kmer whose search states are cached (0: no cache)")
+                                ("persist-extended-seeds", po::bool_switch()->default_value(false),
+                                 "load cached read suffixes from the gram directory and store them back after mapping")
+                                ("sort-reads-batch", po::bool_switch()->default_value(false),
+                                 "search reads sorted by suffix, sharing search steps between reads, in batches instead of "
+                                 "scheduled chunks (not with the read caches or --numa replicate)")
+                                ("numa", po::value<std::string>()->default_value("none"),
+                                 "NUMA placement: none, interleave (spread index pages over nodes) or replicate (index copy per node)")
+                                ("huge-pages", po::value<std::string>()->default_value("none"),
+                                 "index huge pages: none, reserved (2 MB pages reserved by the system) or transparent");
 
     std::vector<std::string> opts = po::collect_unrecognized(parsed.options,
                                                              po::include_positional);
@@ -29,28 +52,79 @@ Parameters commands::quasimap::parse_parameters(po::variables_map &vm,
     std::string gram_dirpath = vm["gram"].as<std::string>();
 
     Parameters parameters = {};
-    parameters.gram_dirpath = gram_dirpath;
-    parameters.linear_prg_fpath = full_path(gram_dirpath, "prg");
-    parameters.encoded_prg_fpath = full_path(gram_dirpath, "encoded_prg");
-    parameters.fm_index_fpath = full_path(gram_dirpath, "fm_index");
-    parameters.sites_mask_fpath = full_path(gram_dirpath, "variant_site_mask");
-    parameters.allele_mask_fpath = full_path(gram_dirpath, "allele_mask");
-    parameters.kmer_index_fpath = full_path(gram_dirpath, "kmer_index");
-    parameters.kmers_fpath = full_path(gram_dirpath, "kmers");
-    parameters.kmers_stats_fpath = full_path(gram_dirpath, "kmers_stats");
-    parameters.sa_intervals_fpath = full_path(gram_dirpath, "sa_intervals");
-    parameters.paths_fpath = full_path(gram_dirpath, "paths");
+    set_gram_directory(parameters, gram_dirpath);
 
     parameters.kmers_size = vm["kmer-size"].as<uint32_t>();
     parameters.reads_fpaths = vm["reads"].as<std::vector<std::string>>();
 
     std::string run_dirpath = vm["run-directory"].as<std::string>();
+    set_run_directory(parameters, run_dirpath);
+
+    parameters.maximum_threads = vm["max-threads"].as<uint32_t>();
+    parameters.seed = vm["seed"].as<uint64_t>();
+    parameters.max_search_states = vm["max-search-states"].as<uint64_t>();
+    parameters.max_sa_interval_width = vm["max-sa-interval-width"].as<uint64_t>();
+    parameters.max_marker_crossings = vm["max-marker-crossings"].as<uint64_t>();
+    parameters.read_cache_size = vm["read-cache-size"].as<uint64_t>();
+    parameters.max_extended_seeds = vm["max-extended-seeds"].as<uint64_t>();
+    parameters.persist_extended_seeds = vm["persist-extended-seeds"].as<bool>();
+    parameters.sort_reads_batch = vm["sort-reads-batch"].as<bool>();
+    parameters.numa_mode = vm["numa"].as<std::string>();
+    parameters.huge_pages_mode = vm["huge-pages"].as<std::string>();
+    check_conflicting_options(parameters);
+    return parameters;
+}
+
+
+std::string commands::quasimap::conflicting_options(const Parameters &parameters) {
+    if (not parameters.sort_reads_batch)
+        return "";
+    // sorted batches are searched by unpinned threads using the caller's index copy,
+    // sharing search steps between reads in place of the read and extended seed caches
+    if (parameters.numa_mode == "replicate")
+        return "--sort-reads-batch cannot be used with --numa replicate";
+    if (parameters.read_cache_size != 0)
+        return "--sort-reads-batch cannot be used with --read-cache-size";
+    if (parameters.max_extended_seeds != 0 or parameters.persist_extended_seeds)
+        return "--sort-reads-batch cannot be used with --max-extended-seeds or --persist-extended-seeds";
+    return "";
+}
+
+
+void commands::quasimap::check_conflicting_options(const Parameters &parameters) {
+    auto conflict = conflicting_options(parameters);
+    if (conflict.empty())
+        return;
+    std::cout << conflict << "\nExiting 1" << std::endl;
+    std::exit(1);
+}
+
+
+void commands::quasimap::set_run_directory(Parameters &parameters, const std::string &run_dirpath) {
     parameters.sdsl_memory_log_fpath = full_path(run_dirpath, "sdsl_memory_log");
 
     parameters.allele_sum_coverage_fpath = full_path(run_dirpath, "allele_sum_coverage");
     parameters.allele_base_coverage_fpath = full_path(run_dirpath, "allele_base_coverage.json");
     parameters.grouped_allele_counts_fpath = full_path(run_dirpath, "grouped_allele_counts_coverage.json");
+}
 
-    parameters.maximum_threads = vm["max-threads"].as<uint32_t>();
-    return parameters;
-}
\ No newline at end of file
+
+void commands::quasimap::set_gram_directory(Parameters &parameters, const std::string &gram_dirpath) {
+    parameters.gram_dirpath = gram_dirpath;
+    parameters.linear_prg_fpath = full_path(gram_dirpath, "prg");
+    parameters.encoded_prg_fpath = full_path(gram_dirpath, "encoded_prg");
+    parameters.fm_index_fpath = full_path(gram_dirpath, "fm_index");
+    parameters.sites_mask_fpath = full_path(gram_dirpath, "variant_site_mask");
+    parameters.allele_mask_fpath = full_path(gram_dirpath, "allele_mask");
+    parameters.site_table_fpath = full_path(gram_dirpath, "site_table");
+    parameters.sa_allele_runs_fpath = full_path(gram_dirpath, "sa_allele_runs");
+    parameters.bwt_markers_fpath = full_path(gram_dirpath, "bwt_markers");
+    parameters.kmer_presence_fpath = full_path(gram_dirpath, "kmer_presence");
+    parameters.invariant_reach_fpath = full_path(gram_dirpath, "invariant_reach");
+    parameters.kmer_index_fpath = full_path(gram_dirpath, "kmer_index");
+    parameters.kmers_fpath = full_path(gram_dirpath, "kmers");
+    parameters.kmers_stats_fpath = full_path(gram_dirpath, "kmers_stats");
+    parameters.sa_intervals_fpath = full_path(gram_dirpath, "sa_intervals");
+    parameters.paths_fpath = full_path(gram_dirpath, "paths");
+    parameters.extended_seeds_fpath = full_path(gram_dirpath, "extended_seeds");
+}
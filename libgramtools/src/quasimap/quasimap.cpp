@@ -1,6 +1,8 @@
+#include <algorithm>
 #include <cassert>
 #include <fstream>
 #include <iostream>
+#include <memory>
 #include <vector>
 #include <omp.h>
 
@@ -9,11 +11,15 @@
 #include "common/timer_report.hpp"
 #include "common/parameters.hpp"
 #include "common/utils.hpp"
+#include "common/random.hpp"
+#include "common/huge_pages.hpp"
 
 #include "search/search.hpp"
 
 #include "quasimap/coverage/types.hpp"
 #include "quasimap/coverage/common.hpp"
+#include "quasimap/coverage/allele_base.hpp"
+#include "quasimap/read_scheduler.hpp"
 #include "quasimap/quasimap.hpp"
 #include "kmer_index/load.hpp"
 
@@ -25,48 +31,179 @@ void commands::quasimap::run(const Parameters &parameters) {
     std::cout << "Executing quasimap command" << std::endl;
     auto timer = TimerReport();
 
+    bool numa_mode_known = parameters.numa_mode == "none"
+                           or parameters.numa_mode == "interleave"
+                           or parameters.numa_mode == "replicate";
+    if (not numa_mode_known) {
+        std::cout << "Unknown NUMA mode: " << parameters.numa_mode << "\nExiting 1" << std::endl;
+        std::exit(1);
+    }
+    bool huge_pages_mode_known = parameters.huge_pages_mode == "none"
+                                 or parameters.huge_pages_mode == "reserved"
+                                 or parameters.huge_pages_mode == "transparent";
+    if (not huge_pages_mode_known) {
+        std::cout << "Unknown huge pages mode: " << parameters.huge_pages_mode << "\nExiting 1" << std::endl;
+        std::exit(1);
+    }
+
     timer.start("Load data");
+    // memory mapped from here until the index copies are placed holds the index
+    huge_pages::MemoryRanges mappings_before_index;
+    if (parameters.huge_pages_mode == "transparent")
+        mappings_before_index = huge_pages::anonymous_mappings();
+    if (parameters.huge_pages_mode == "reserved" and not huge_pages::use_reserved_pages())
+        std::cout << "No reserved huge pages available, index uses default pages" << std::endl;
+    bool interleaved = parameters.numa_mode == "interleave"
+                       and numa::interleave_allocations(numa::node_ids());
+    // the copy loaded here serves node 0, so it is loaded by a thread on node 0
+    auto nodes_cpus = numa::node_cpus();
+    if (parameters.numa_mode == "replicate" and nodes_cpus.size() >= 2)
+        numa::pin_thread(nodes_cpus[0]);
     std::cout << "Loading PRG data" << std::endl;
     const auto prg_info = load_prg_info(parameters);
     std::cout << "Loading kmer index data" << std::endl;
     const auto kmer_index = kmer_index::load(parameters);
+    if (interleaved)
+        numa::default_allocations();
+
+    NumaReplicas numa_replicas;
+    auto numa_nodes = place_numa_nodes(parameters, kmer_index, prg_info, numa_replicas);
+    if (parameters.huge_pages_mode == "transparent") {
+        auto count_advised_bytes = huge_pages::advise_transparent_pages(mappings_before_index);
+        std::cout << "Transparent huge pages advised over " << (count_advised_bytes >> 20) << " MB of index" << std::endl;
+    }
     timer.stop();
 
     std::cout << "Running quasimap" << std::endl;
     timer.start("Quasimap");
-    auto quasimap_stats = quasimap_reads(parameters, kmer_index, prg_info);
+    auto quasimap_stats = quasimap_reads(parameters, kmer_index, prg_info, numa_nodes);
 
     std::cout << std::endl;
-    std::cout << "The following counts include generated reverse complement reads."
-              << std::endl;
-    std::cout << "Count all reads: " << quasimap_stats.all_reads_count << std::endl;
-    std::cout << "Count skipped reads: " << quasimap_stats.skipped_reads_count << std::endl;
-    std::cout << "Count mapped reads: " << quasimap_stats.mapped_reads_count << std::endl;
+    report_stats(std::cout, quasimap_stats, parameters);
     timer.stop();
 
     timer.report();
 }
 
 
+void commands::quasimap::report_stats(std::ostream &out,
+                                      const QuasimapReadsStats &quasimap_stats,
+                                      const Parameters &parameters) {
+    out << "The following counts include generated reverse complement reads."
+        << std::endl;
+    out << "Count all reads: " << quasimap_stats.all_reads_count << std::endl;
+    out << "Count skipped reads: " << quasimap_stats.skipped_reads_count << std::endl;
+    out << "Count mapped reads: " << quasimap_stats.mapped_reads_count << std::endl;
+    out << "Count reads without seed kmer in index: "
+        << quasimap_stats.seedless_strands_count << std::endl;
+    out << "Count reads searched without reaching a variant site: "
+        << quasimap_stats.invariant_reads_count << std::endl;
+    out << "Count reads rejected by kmer presence prefilter: "
+        << quasimap_stats.presence_rejected_count << std::endl;
+    out << "Count reads over search states limit: "
+        << quasimap_stats.search_states_limit_count << std::endl;
+    out << "Count reads over SA interval width limit: "
+        << quasimap_stats.sa_interval_width_limit_count << std::endl;
+    out << "Count reads over marker crossings limit: "
+        << quasimap_stats.marker_crossings_limit_count << std::endl;
+    if (parameters.read_cache_size != 0) {
+        out << "Count read cache hits: " << quasimap_stats.read_cache_hits_count << std::endl;
+        out << "Count read cache misses: " << quasimap_stats.read_cache_misses_count << std::endl;
+    }
+    if (parameters.max_extended_seeds != 0)
+        out << "Count cached extended seeds: " << quasimap_stats.extended_seeds_count << std::endl;
+    if (quasimap_stats.dtlb_load_misses_count != 0)
+        out << "Count read search threads dTLB load misses: "
+            << quasimap_stats.dtlb_load_misses_count << std::endl;
+    auto read_threads_seconds = quasimap_stats.read_threads_busy_seconds + quasimap_stats.read_threads_idle_seconds;
+    if (read_threads_seconds > 0)
+        out << "Read search threads idle time: "
+            << 100 * quasimap_stats.read_threads_idle_seconds / read_threads_seconds << "%" << std::endl;
+}
+
+
+NumaNodes gram::place_numa_nodes(const Parameters &parameters,
+                                 const KmerIndex &kmer_index,
+                                 const PRG_Info &prg_info,
+                                 NumaReplicas &numa_replicas) {
+    if (parameters.numa_mode == "none")
+        return NumaNodes{};
+
+    auto nodes_cpus = numa::node_cpus();
+    if (nodes_cpus.size() < 2) {
+        std::cout << "Fewer than two NUMA nodes found, threads are not pinned" << std::endl;
+        return NumaNodes{};
+    }
+
+    NumaNodes numa_nodes(nodes_cpus.size());
+    for (uint64_t node = 0; node < numa_nodes.size(); ++node) {
+        numa_nodes[node].cpus = nodes_cpus[node];
+        numa_nodes[node].kmer_index = &kmer_index;
+        numa_nodes[node].prg_info = &prg_info;
+    }
+    if (parameters.numa_mode != "replicate")
+        return numa_nodes;
+
+    // pages are placed on the node of the thread first writing them; node 0 keeps the
+    // copy already loaded by the (node 0 pinned) calling thread, which stays on node 0
+    // while threads of their own load the other copies
+    std::cout << "Loading index copies on " << numa_nodes.size() - 1 << " more NUMA nodes" << std::endl;
+    numa_replicas.kmer_indexes.resize(numa_nodes.size());
+    numa_replicas.prg_infos.resize(numa_nodes.size());
+    numa::run_on_nodes(nodes_cpus, 1, [&](const uint64_t &node) {
+        numa_replicas.kmer_indexes[node].reset(new KmerIndex(kmer_index::load(parameters)));
+        // constructed in place: the rank and select supports point into the structure
+        numa_replicas.prg_infos[node].reset(new PRG_Info(load_prg_info(parameters)));
+        numa_nodes[node].kmer_index = numa_replicas.kmer_indexes[node].get();
+        numa_nodes[node].prg_info = numa_replicas.prg_infos[node].get();
+    });
+    return numa_nodes;
+}
+
+
 QuasimapReadsStats gram::quasimap_reads(const Parameters &parameters,
                                         const KmerIndex &kmer_index,
                                         const PRG_Info &prg_info) {
+    return quasimap_reads(parameters, kmer_index, prg_info, NumaNodes{});
+}
+
+
+QuasimapReadsStats gram::quasimap_reads(const Parameters &parameters,
+                                        const KmerIndex &kmer_index,
+                                        const PRG_Info &prg_info,
+                                        const NumaNodes &numa_nodes) {
     std::cout << "Generating allele quasimap data structure" << std::endl;
     auto coverage = coverage::generate::empty_structure(prg_info);
+    coverage::generate::allele_base_deltas(coverage, omp_get_max_threads());
+    coverage.record_scratches = std::vector<RecordScratch>(omp_get_max_threads());
     std::cout << "Done generating allele quasimap data structure" << std::endl;
 
     std::cout << "Processing reads:" << std::endl;
     QuasimapReadsStats quasimap_stats = {};
+    ReadSearchCache read_cache(parameters.read_cache_size);
+    ExtendedSeedCache seed_cache(parameters.max_extended_seeds);
+    if (parameters.persist_extended_seeds)
+        extended_seed_cache::load(seed_cache, prg_info, parameters);
 
     for (const auto &reads_fpath: parameters.reads_fpaths) {
         handle_read_file(quasimap_stats,
                          coverage,
+                         read_cache,
+                         seed_cache,
                          reads_fpath,
                          parameters,
                          kmer_index,
-                         prg_info);
+                         prg_info,
+                         numa_nodes);
     }
+    coverage::generate::allele_base_from_deltas(coverage);
+    if (prg_info.strand_count_sites != 0)
+        coverage::generate::fold_strand_symmetric(coverage, prg_info.strand_count_sites);
     coverage::dump::all(coverage, parameters);
+
+    quasimap_stats.extended_seeds_count = seed_cache.count_seeds();
+    if (parameters.persist_extended_seeds)
+        extended_seed_cache::dump(seed_cache, prg_info, parameters);
     return quasimap_stats;
 }
 
@@ -83,83 +220,356 @@ std::vector<Pattern> get_reads_buffer(SeqRead::SeqIterator &reads_it, SeqRead &r
 }
 
 
-void handle_reads_buffer(QuasimapReadsStats &quasimap_stats,
-                         Coverage &coverage,
-                         const std::vector<Pattern> &reads_buffer,
-                         const Parameters &parameters,
-                         const KmerIndex &kmer_index,
-                         const PRG_Info &prg_info) {
-    uint64_t last_count_reported = 0;
+std::vector<uint64_t> gram::sort_reads_by_suffix(const std::vector<Pattern> &reads) {
+    std::vector<uint64_t> order;
+    order.reserve(reads.size());
+    for (uint64_t i = 0; i < reads.size(); ++i) {
+        if (not reads[i].empty())
+            order.push_back(i);
+    }
+
+    // reversed reads in lexicographic order: a seed kmer, then its following bases
+    std::sort(order.begin(), order.end(), [&reads](const uint64_t &lhs, const uint64_t &rhs) {
+        return std::lexicographical_compare(reads[lhs].rbegin(), reads[lhs].rend(),
+                                            reads[rhs].rbegin(), reads[rhs].rend());
+    });
+    return order;
+}
+
+
+uint64_t gram::count_common_suffix_bases(const Pattern &lhs, const Pattern &rhs) {
+    auto mismatch = std::mismatch(lhs.rbegin(), lhs.rend(), rhs.rbegin(), rhs.rend());
+    return (uint64_t) std::distance(lhs.rbegin(), mismatch.first);
+}
+
 
+void handle_sorted_reads_buffer(QuasimapReadsStats &quasimap_stats,
+                                Coverage &coverage,
+                                const std::vector<Pattern> &reads_buffer,
+                                const Parameters &parameters,
+                                const KmerIndex &kmer_index,
+                                const PRG_Info &prg_info) {
+    // every read before this buffer was counted twice (forward and reverse)
+    uint64_t first_read_index = quasimap_stats.all_reads_count / 2;
+    quasimap_stats.all_reads_count += 2 * reads_buffer.size();
+
+    // oriented read 2i is read i, 2i + 1 its reverse complement; a strand symmetric
+    // index holds both strands, so the reverse complement is left empty and not searched
+    bool strand_symmetric = prg_info.strand_count_sites != 0;
+    std::vector<Pattern> oriented_reads;
+    oriented_reads.reserve(2 * reads_buffer.size());
+    for (const auto &read: reads_buffer) {
+        if (read.empty())
+            quasimap_stats.skipped_reads_count += 2;
+        oriented_reads.emplace_back(read);
+        if (strand_symmetric)
+            oriented_reads.emplace_back();
+        else
+            oriented_reads.emplace_back(reverse_compliment_read(read));
+    }
+
+    // seedless, rejected and site free reads are left out of the search order, as empty
+    // reads are; a read reaching no site is only searched for whether it maps
+    const auto &kmer_size = parameters.kmers_size;
+    const auto search_budget = get_search_budget(parameters);
     #pragma omp parallel for
-    for (int i = 0; i < reads_buffer.size(); ++i) {
+    for (uint64_t i = 0; i < oriented_reads.size(); ++i) {
+        auto &read = oriented_reads[i];
+        if (read.empty())
+            continue;
 
-        auto thread_id = omp_get_thread_num();
-        if (thread_id == 0) {
-            uint64_t diff = quasimap_stats.all_reads_count - last_count_reported;
-            if (diff >= 10000) {
-                std::cout << quasimap_stats.all_reads_count << std::endl;
-                last_count_reported = quasimap_stats.all_reads_count;
+        PackedKmer kmer = 0;
+        bool seeded = read.size() >= kmer_size;
+        if (seeded) {
+            kmer = pack_read_kmer(read, kmer_size);
+            const auto kmer_index_it = kmer_index.find(kmer);
+            seeded = kmer_index_it != kmer_index.end() and not kmer_index_it->second.empty();
+        }
+        if (not seeded) {
+            #pragma omp atomic
+            ++quasimap_stats.seedless_strands_count;
+            read.clear();
+            continue;
+        }
+
+        if (not sampled_kmers_present(prg_info.kmer_presence, read)) {
+            #pragma omp atomic
+            ++quasimap_stats.presence_rejected_count;
+            read.clear();
+            continue;
+        }
+
+        if (read_reaches_no_site(read, kmer, kmer_size, kmer_index, prg_info)) {
+            #pragma omp atomic
+            ++quasimap_stats.invariant_reads_count;
+            SearchBudgetLimit exceeded_limit = SearchBudgetLimit::none;
+            auto search_states = search_invariant_read_backwards(read, kmer, kmer_size, kmer_index, prg_info,
+                                                                 search_budget, exceeded_limit);
+            record_search_budget_limit(quasimap_stats, exceeded_limit);
+            if (not search_states.empty()) {
+                #pragma omp atomic
+                ++quasimap_stats.mapped_reads_count;
             }
+            read.clear();
         }
+    }
+
+    // reads sharing a seed kmer are searched in order by one thread
+    const auto order = sort_reads_by_suffix(oriented_reads);
+    std::vector<uint64_t> group_starts;
+    for (uint64_t i = 0; i < order.size(); ++i) {
+        bool kmer_shared = i > 0 and count_common_suffix_bases(oriented_reads[order[i - 1]],
+                                                               oriented_reads[order[i]]) >= kmer_size;
+        if (not kmer_shared)
+            group_starts.push_back(i);
+    }
+    group_starts.push_back(order.size());
+
+    #pragma omp parallel for schedule(dynamic)
+    for (uint64_t group = 0; group < group_starts.size() - 1; ++group) {
+        SuffixSearchStack search_stack;
+        for (uint64_t i = group_starts[group]; i < group_starts[group + 1]; ++i) {
+            const auto &read = oriented_reads[order[i]];
+            uint64_t count_shared_bases = 0;
+            if (i != group_starts[group])
+                count_shared_bases = count_common_suffix_bases(oriented_reads[order[i - 1]], read);
+
+            SearchBudgetLimit exceeded_limit = SearchBudgetLimit::none;
+            auto search_states = search_shared_suffix_backwards(read, count_shared_bases, kmer_size,
+                                                                kmer_index, prg_info, search_budget,
+                                                                search_stack, exceeded_limit);
+            record_search_budget_limit(quasimap_stats, exceeded_limit);
+            if (search_states.empty())
+                continue;
+
+            #pragma omp atomic
+            ++quasimap_stats.mapped_reads_count;
+            auto random_seed = read_random_seed(parameters.seed, 2 * first_read_index + order[i]);
+            coverage::record::search_states(coverage,
+                                            search_states,
+                                            read.size(),
+                                            prg_info,
+                                            random_seed);
+        }
+    }
+    std::cout << quasimap_stats.all_reads_count << std::endl;
+}
 
-        #pragma omp atomic
-        quasimap_stats.all_reads_count += 2;
 
-        auto read = reads_buffer[i];
+void handle_reads_chunk(QuasimapReadsStats &quasimap_stats,
+                        Coverage &coverage,
+                        ReadSearchCache &read_cache,
+                        ExtendedSeedCache &seed_cache,
+                        const ReadsChunk &chunk,
+                        const Parameters &parameters,
+                        const KmerIndex &kmer_index,
+                        const PRG_Info &prg_info) {
+    // a strand symmetric index holds both strands, so only the forward strand is searched
+    bool strand_symmetric = prg_info.strand_count_sites != 0;
+    const auto &reads_buffer = *chunk.reads_buffer;
+
+    for (uint64_t i = chunk.first_buffer_index; i < chunk.last_buffer_index; ++i) {
+        const auto &read = reads_buffer[i];
         if (read.empty()) {
             #pragma omp atomic
             quasimap_stats.skipped_reads_count += 2;
             continue;
         }
-        quasimap_forward_reverse(quasimap_stats,
-                                 coverage,
-                                 read,
-                                 parameters,
-                                 kmer_index,
-                                 prg_info);
+
+        // only seeded strands are searched
+        auto seeded_strands = find_seeded_strands(read, parameters.kmers_size, kmer_index);
+        uint64_t count_seedless_strands = 2 - seeded_strands.forward - seeded_strands.reverse;
+        if (strand_symmetric) {
+            seeded_strands.reverse = false;
+            count_seedless_strands = 1 - seeded_strands.forward;
+        }
+        if (count_seedless_strands != 0) {
+            #pragma omp atomic
+            quasimap_stats.seedless_strands_count += count_seedless_strands;
+        }
+
+        for (const bool reverse: {false, true}) {
+            bool seeded = reverse ? seeded_strands.reverse : seeded_strands.forward;
+            if (not seeded)
+                continue;
+
+            Pattern reverse_read;
+            const Pattern *strand_read = &read;
+            if (reverse) {
+                reverse_read = reverse_compliment_read(read);
+                strand_read = &reverse_read;
+            }
+
+            // forward strand of read i is read number 2i, its reverse complement 2i + 1
+            auto read_number = 2 * (chunk.first_read_index + i) + reverse;
+            auto random_seed = read_random_seed(parameters.seed, read_number);
+            bool read_mapped_exactly = quasimap_read(quasimap_stats, read_cache, seed_cache, *strand_read, coverage,
+                                                     kmer_index, prg_info, parameters, random_seed);
+            if (read_mapped_exactly) {
+                #pragma omp atomic
+                ++quasimap_stats.mapped_reads_count;
+            }
+        }
+    }
+}
+
+
+void handle_sorted_read_file(QuasimapReadsStats &quasimap_stats,
+                             Coverage &coverage,
+                             SeqRead &reads,
+                             const Parameters &parameters,
+                             const KmerIndex &kmer_index,
+                             const PRG_Info &prg_info) {
+    uint64_t max_set_size = 5000;
+    auto reads_it = reads.begin();
+    while (reads_it != reads.end()) {
+        auto reads_buffer = get_reads_buffer(reads_it, reads, max_set_size);
+        handle_sorted_reads_buffer(quasimap_stats,
+                                   coverage,
+                                   reads_buffer,
+                                   parameters,
+                                   kmer_index,
+                                   prg_info);
     }
 }
 
 
 void gram::handle_read_file(QuasimapReadsStats &quasimap_stats,
                             Coverage &coverage,
+                            ReadSearchCache &read_cache,
+                            ExtendedSeedCache &seed_cache,
                             const std::string &reads_fpath,
                             const Parameters &parameters,
                             const KmerIndex &kmer_index,
-                            const PRG_Info &prg_info) {
-    uint64_t max_set_size = 5000;
+                            const PRG_Info &prg_info,
+                            const NumaNodes &numa_nodes) {
     SeqRead reads(reads_fpath.c_str());
-    auto reads_it = reads.begin();
-    while (reads_it != reads.end()) {
-        auto reads_buffer = get_reads_buffer(reads_it, reads, max_set_size);
-        handle_reads_buffer(quasimap_stats,
-                            coverage,
-                            reads_buffer,
-                            parameters,
-                            kmer_index,
-                            prg_info);
+    if (parameters.sort_reads_batch) {
+        handle_sorted_read_file(quasimap_stats, coverage, reads, parameters, kmer_index, prg_info);
+        return;
     }
-}
 
+    // thread 0 also reads buffers, whenever few chunks are queued; no thread waits for a
+    // buffer to be finished before the next one is read
+    uint64_t max_set_size = 5000;
+    const uint64_t min_count_queued_chunks = 2 * omp_get_max_threads();
+    ReadsChunkScheduler scheduler(omp_get_max_threads());
+    auto reads_it = reads.begin();
+
+    #pragma omp parallel
+    {
+        const uint64_t thread_index = omp_get_thread_num();
+        bool reader_thread = thread_index == 0;
+
+        const KmerIndex *thread_kmer_index = &kmer_index;
+        const PRG_Info *thread_prg_info = &prg_info;
+        if (not numa_nodes.empty()) {
+            const auto &numa_node = numa_nodes[thread_index % numa_nodes.size()];
+            numa::pin_thread(numa_node.cpus);
+            thread_kmer_index = numa_node.kmer_index;
+            thread_prg_info = numa_node.prg_info;
+        }
+        double busy_seconds = 0;
+        double idle_seconds = 0;
+        TlbMissCounter tlb_miss_counter;
+
+        while (true) {
+            bool read_buffer = reader_thread
+                               and not scheduler.closed()
+                               and scheduler.count_queued_chunks() < min_count_queued_chunks;
+            if (read_buffer) {
+                auto start = omp_get_wtime();
+                auto reads_buffer = std::make_shared<const ReadsBuffer>(get_reads_buffer(reads_it, reads,
+                                                                                         max_set_size));
+                // every read before this buffer was counted twice (forward and reverse)
+                uint64_t first_read_index = quasimap_stats.all_reads_count / 2;
+                quasimap_stats.all_reads_count += 2 * reads_buffer->size();
+                scheduler.push_buffer(reads_buffer, first_read_index);
+                if (reads_it == reads.end())
+                    scheduler.close();
+                std::cout << quasimap_stats.all_reads_count << std::endl;
+                busy_seconds += omp_get_wtime() - start;
+                continue;
+            }
+
+            auto start = omp_get_wtime();
+            ReadsChunk chunk = {};
+            if (scheduler.pop(thread_index, chunk)) {
+                handle_reads_chunk(quasimap_stats, coverage, read_cache, seed_cache, chunk,
+                                   parameters, *thread_kmer_index, *thread_prg_info);
+                busy_seconds += omp_get_wtime() - start;
+                continue;
+            }
 
-void gram::quasimap_forward_reverse(QuasimapReadsStats &quasimap_reads_stats,
-                                    Coverage &coverage,
-                                    const Pattern &read,
-                                    const Parameters &parameters,
-                                    const KmerIndex &kmer_index,
-                                    const PRG_Info &prg_info) {
-    bool read_mapped_exactly = quasimap_read(read, coverage, kmer_index, prg_info, parameters);
-    if (read_mapped_exactly) {
+            // closed is read before the queue is found empty, so no pushed chunk is missed
+            if (scheduler.closed() and scheduler.count_queued_chunks() == 0)
+                break;
+            // the reader thread reads the next buffer instead of waiting for one
+            if (not reader_thread)
+                scheduler.wait_for_chunks();
+            idle_seconds += omp_get_wtime() - start;
+        }
+
+        #pragma omp atomic
+        quasimap_stats.read_threads_busy_seconds += busy_seconds;
+        #pragma omp atomic
+        quasimap_stats.read_threads_idle_seconds += idle_seconds;
+        auto count_tlb_misses = tlb_miss_counter.count_misses();
         #pragma omp atomic
-        ++quasimap_reads_stats.mapped_reads_count;
+        quasimap_stats.dtlb_load_misses_count += count_tlb_misses;
     }
+}
 
-    auto reverse_read = reverse_compliment_read(read);
-    read_mapped_exactly = quasimap_read(reverse_read, coverage, kmer_index, prg_info, parameters);
-    if (read_mapped_exactly) {
-        #pragma omp atomic
-        ++quasimap_reads_stats.mapped_reads_count;
+
+SeededStrands gram::find_seeded_strands(const Pattern &read,
+                                       const uint32_t &kmer_size,
+                                       const KmerIndex &kmer_index) {
+    SeededStrands seeded_strands = {};
+    if (read.empty() or read.size() < kmer_size)
+        return seeded_strands;
+
+    auto kmer_seeded = [&kmer_index](const PackedKmer &kmer) {
+        const auto kmer_index_it = kmer_index.find(kmer);
+        return kmer_index_it != kmer_index.end() and not kmer_index_it->second.empty();
+    };
+
+    // the reverse strand's seed is the reverse complement of the read's first bases,
+    // a packed base's complement is its two bits inverted
+    PackedKmer reverse_kmer = 0;
+    for (uint32_t i = kmer_size; i > 0; --i)
+        reverse_kmer = (reverse_kmer << 2) | (3 - ((read[i - 1] - 1) & 3));
+    seeded_strands.forward = kmer_seeded(pack_read_kmer(read, kmer_size));
+    seeded_strands.reverse = kmer_seeded(reverse_kmer);
+    return seeded_strands;
+}
+
+
+SearchBudget gram::get_search_budget(const Parameters &parameters) {
+    SearchBudget search_budget = {};
+    search_budget.max_search_states = parameters.max_search_states;
+    search_budget.max_sa_interval_width = parameters.max_sa_interval_width;
+    search_budget.max_marker_crossings = parameters.max_marker_crossings;
+    return search_budget;
+}
+
+
+void gram::record_search_budget_limit(QuasimapReadsStats &quasimap_reads_stats,
+                                      const SearchBudgetLimit &exceeded_limit) {
+    switch (exceeded_limit) {
+        case SearchBudgetLimit::search_states:
+            #pragma omp atomic
+            ++quasimap_reads_stats.search_states_limit_count;
+            break;
+        case SearchBudgetLimit::sa_interval_width:
+            #pragma omp atomic
+            ++quasimap_reads_stats.sa_interval_width_limit_count;
+            break;
+        case SearchBudgetLimit::marker_crossings:
+            #pragma omp atomic
+            ++quasimap_reads_stats.marker_crossings_limit_count;
+            break;
+        case SearchBudgetLimit::none:
+            break;
     }
 }
 
@@ -169,9 +579,69 @@ bool gram::quasimap_read(const Pattern &read,
                          const KmerIndex &kmer_index,
                          const PRG_Info &prg_info,
                          const Parameters &parameters,
-                         const uint32_t &random_seed) {
-    auto kmer = get_kmer_from_read(parameters.kmers_size, read);
-    auto search_states = search_read_backwards(read, kmer, kmer_index, prg_info);
+                         const uint64_t &random_seed) {
+    QuasimapReadsStats quasimap_reads_stats = {};
+    ReadSearchCache read_cache(0);
+    ExtendedSeedCache seed_cache(0);
+    return quasimap_read(quasimap_reads_stats, read_cache, seed_cache, read, coverage,
+                         kmer_index, prg_info, parameters, random_seed);
+}
+
+
+bool gram::quasimap_read(QuasimapReadsStats &quasimap_reads_stats,
+                         ReadSearchCache &read_cache,
+                         ExtendedSeedCache &seed_cache,
+                         const Pattern &read,
+                         Coverage &coverage,
+                         const KmerIndex &kmer_index,
+                         const PRG_Info &prg_info,
+                         const Parameters &parameters,
+                         const uint64_t &random_seed) {
+    if (not sampled_kmers_present(prg_info.kmer_presence, read)) {
+        #pragma omp atomic
+        ++quasimap_reads_stats.presence_rejected_count;
+        return false;
+    }
+
+    // a read shorter than a kmer has no seed
+    const auto &kmer_size = parameters.kmers_size;
+    if (read.size() < kmer_size)
+        return false;
+
+    // a read whose seed kmer only occurs too far from any variant site adds no coverage,
+    // only whether it maps is searched for
+    auto kmer = pack_read_kmer(read, kmer_size);
+    if (read_reaches_no_site(read, kmer, kmer_size, kmer_index, prg_info)) {
+        #pragma omp atomic
+        ++quasimap_reads_stats.invariant_reads_count;
+        SearchBudgetLimit exceeded_limit = SearchBudgetLimit::none;
+        auto search_states = search_invariant_read_backwards(read, kmer, kmer_size, kmer_index, prg_info,
+                                                             get_search_budget(parameters), exceeded_limit);
+        record_search_budget_limit(quasimap_reads_stats, exceeded_limit);
+        return not search_states.empty();
+    }
+
+    CachedReadSearch read_search = {};
+    bool cache_hit = read_cache.find(read, read_search);
+    if (read_cache.enabled()) {
+        if (cache_hit) {
+            #pragma omp atomic
+            ++quasimap_reads_stats.read_cache_hits_count;
+        } else {
+            #pragma omp atomic
+            ++quasimap_reads_stats.read_cache_misses_count;
+        }
+    }
+
+    if (not cache_hit) {
+        auto search_budget = get_search_budget(parameters);
+        read_search.search_states = search_read_backwards(read, kmer, kmer_size, kmer_index, prg_info,
+                                                          search_budget, seed_cache, read_search.exceeded_limit);
+        read_cache.insert(read, read_search);
+    }
+    record_search_budget_limit(quasimap_reads_stats, read_search.exceeded_limit);
+    const auto &search_states = read_search.search_states;
+
     auto read_mapped_exactly = not search_states.empty();
     if (not read_mapped_exactly)
         return read_mapped_exactly;
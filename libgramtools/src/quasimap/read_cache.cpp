@@ -0,0 +1,53 @@
+#include "quasimap/read_cache.hpp"
+
+
+using namespace gram;
+
+
+ReadSearchCache::ReadSearchCache(const uint64_t &max_count_reads)
+        : max_shard_count_reads((max_count_reads + count_shards - 1) / count_shards),
+          shards(max_count_reads == 0 ? 0 : count_shards) {}
+
+
+ReadSearchCache::Shard &ReadSearchCache::get_shard(const Pattern &read) {
+    auto read_hash = sequence_hash<Pattern>()(read);
+    return shards[read_hash % count_shards];
+}
+
+
+bool ReadSearchCache::find(const Pattern &read, CachedReadSearch &cached_read_search) {
+    if (not enabled())
+        return false;
+
+    auto &shard = get_shard(read);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto found = shard.entry_its.find(read);
+    if (found == shard.entry_its.end())
+        return false;
+
+    auto entry_it = found->second;
+    shard.entries.splice(shard.entries.begin(), shard.entries, entry_it);
+    cached_read_search = entry_it->second;
+    return true;
+}
+
+
+void ReadSearchCache::insert(const Pattern &read, const CachedReadSearch &cached_read_search) {
+    if (not enabled())
+        return;
+
+    auto &shard = get_shard(read);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    bool read_cached = shard.entry_its.find(read) != shard.entry_its.end();
+    if (read_cached)
+        return;
+
+    shard.entries.emplace_front(std::make_pair(read, cached_read_search));
+    shard.entry_its[read] = shard.entries.begin();
+
+    if (shard.entries.size() <= max_shard_count_reads)
+        return;
+    const auto &evicted_read = shard.entries.back().first;
+    shard.entry_its.erase(evicted_read);
+    shard.entries.pop_back();
+}
@@ -0,0 +1,76 @@
+#include <algorithm>
+
+#include "quasimap/read_scheduler.hpp"
+
+
+using namespace gram;
+
+
+ReadsChunkScheduler::ReadsChunkScheduler(const uint64_t &count_threads)
+        : queues(std::max<uint64_t>(count_threads, 1)),
+          count_queued(0),
+          reads_closed(false) {}
+
+
+void ReadsChunkScheduler::push_buffer(const std::shared_ptr<const ReadsBuffer> &reads_buffer,
+                                      const uint64_t &first_read_index) {
+    for (uint64_t first = 0; first < reads_buffer->size(); first += chunk_size) {
+        ReadsChunk chunk = {};
+        chunk.reads_buffer = reads_buffer;
+        chunk.first_buffer_index = first;
+        chunk.last_buffer_index = std::min<uint64_t>(first + chunk_size, reads_buffer->size());
+        chunk.first_read_index = first_read_index;
+
+        auto &queue = queues[next_queue_index];
+        next_queue_index = (next_queue_index + 1) % queues.size();
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.chunks.emplace_back(std::move(chunk));
+        ++count_queued;
+    }
+
+    // taken between the count update and the notification, so no waiter misses it
+    { std::lock_guard<std::mutex> lock(wait_mutex); }
+    chunks_queued.notify_all();
+}
+
+
+void ReadsChunkScheduler::close() {
+    {
+        std::lock_guard<std::mutex> lock(wait_mutex);
+        reads_closed = true;
+    }
+    chunks_queued.notify_all();
+}
+
+
+void ReadsChunkScheduler::wait_for_chunks() {
+    std::unique_lock<std::mutex> lock(wait_mutex);
+    chunks_queued.wait(lock, [this] { return count_queued > 0 or reads_closed; });
+}
+
+
+bool ReadsChunkScheduler::pop(const uint64_t &thread_index, ReadsChunk &chunk) {
+    const uint64_t own_queue_index = thread_index % queues.size();
+    {
+        auto &queue = queues[own_queue_index];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (not queue.chunks.empty()) {
+            chunk = std::move(queue.chunks.front());
+            queue.chunks.pop_front();
+            --count_queued;
+            return true;
+        }
+    }
+
+    for (uint64_t i = 1; i < queues.size(); ++i) {
+        auto &queue = queues[(own_queue_index + i) % queues.size()];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.chunks.empty())
+            continue;
+        chunk = std::move(queue.chunks.back());
+        queue.chunks.pop_back();
+        --count_queued;
+        return true;
+    }
+    return false;
+}
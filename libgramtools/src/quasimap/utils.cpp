@@ -8,6 +8,10 @@ using namespace gram;
 
 
 uint64_t gram::get_number_of_variant_sites(const PRG_Info &prg_info) {
+    // the strand separator is the largest alphabet character, but not a site's marker
+    if (prg_info.strand_count_sites != 0)
+        return 2 * prg_info.strand_count_sites;
+
     auto min_boundary_marker = 5;
     uint64_t number_of_variant_sites;
     if (prg_info.max_alphabet_num <= 4) {
@@ -1,3 +1,5 @@
+#include <algorithm>
+
 #include <sdsl/suffix_arrays.hpp>
 #include "search/search.hpp"
 
@@ -5,86 +7,50 @@
 using namespace gram;
 
 
-class SearchStateCache {
-public:
-    SearchState search_state = {};
-    bool empty = true;
-
-    void set(const SearchState &search_state) {
-        this->search_state = search_state;
-        this->empty = false;
-    }
-
-    void flush(SearchStates &search_states) {
-        if (this->empty)
-            return;
-        search_states.emplace_back(this->search_state);
-        this->empty = true;
-    }
-
-    void update_sa_interval_max(const SA_Index &new_sa_interval_max) {
-        assert(not this->empty);
-        assert(this->search_state.sa_interval.second + 1 == new_sa_interval_max);
-        this->search_state.sa_interval.second = new_sa_interval_max;
-    }
-};
-
-
 SearchStates gram::handle_allele_encapsulated_state(const SearchState &search_state,
                                                     const PRG_Info &prg_info) {
     bool has_path = not search_state.variant_site_path.empty();
     assert(not has_path);
 
     SearchStates new_search_states = {};
-    SearchStateCache cache;
+    const auto &sa_allele_runs = prg_info.sa_allele_runs;
+    const auto last_run_index = count_runs(sa_allele_runs) - 1;
 
-    for (uint64_t sa_index = search_state.sa_interval.first;
-         sa_index <= search_state.sa_interval.second;
-         ++sa_index) {
+    // split the SA interval by allele run, without locating any SA index
+    auto sa_index = search_state.sa_interval.first;
+    auto run_index = prg_info.sa_allele_runs_rank(sa_index + 1) - 1;
+    while (sa_index <= search_state.sa_interval.second) {
+        uint64_t run_last_sa_index = sa_allele_runs.run_starts_mask.size() - 1;
+        if (run_index < last_run_index)
+            run_last_sa_index = prg_info.sa_allele_runs_select(run_index + 2) - 1;
+        SA_Index last_sa_index = std::min<uint64_t>(run_last_sa_index, search_state.sa_interval.second);
 
-        auto prg_index = prg_info.fm_index[sa_index];
-        auto site_marker = prg_info.sites_mask[prg_index];
-        auto allele_id = prg_info.allele_mask[prg_index];
+        Marker site_marker = sa_allele_runs.site_markers[run_index];
+        AlleleId allele_id = sa_allele_runs.allele_ids[run_index];
 
         bool within_site = site_marker != 0;
         if (not within_site) {
-            cache.flush(new_search_states);
-            cache.set(SearchState{
-                    SA_Interval{sa_index, sa_index},
-                    VariantSitePath{},
-                    SearchVariantSiteState::outside_variant_site
-            });
-            cache.flush(new_search_states);
+            for (; sa_index <= last_sa_index; ++sa_index)
+                new_search_states.emplace_back(SearchState{
+                        SA_Interval{sa_index, sa_index},
+                        VariantSitePath{},
+                        SearchVariantSiteState::outside_variant_site
+                });
+            ++run_index;
             continue;
         }
 
         // completely encapsulated within allele
-        if (cache.empty) {
-            cache.set(SearchState{
-                    SA_Interval{sa_index, sa_index},
-                    VariantSitePath{
-                            VariantSite{site_marker, allele_id}
-                    },
-                    SearchVariantSiteState::within_variant_site
-            });
-            continue;
-        }
-
-        VariantSitePath current_path = {VariantSite{site_marker, allele_id}};
-        bool cache_has_same_path = current_path == cache.search_state.variant_site_path;
-        if (cache_has_same_path) {
-            cache.update_sa_interval_max(sa_index);
-            continue;
-        } else {
-            cache.flush(new_search_states);
-            cache.set(SearchState{
-                    SA_Interval{sa_index, sa_index},
-                    current_path,
-                    SearchVariantSiteState::within_variant_site
-            });
-        }
+        new_search_states.emplace_back(SearchState{
+                SA_Interval{sa_index, last_sa_index},
+                VariantSitePath{
+                        VariantSite{site_marker, allele_id}
+                },
+                SearchVariantSiteState::within_variant_site
+        });
+        sa_index = last_sa_index + 1;
+        ++run_index;
     }
-    cache.flush(new_search_states);
     return new_search_states;
 }
 
@@ -113,34 +79,313 @@ SearchStates gram::search_read_backwards(const Pattern &read,
                                          const Pattern &kmer,
                                          const KmerIndex &kmer_index,
                                          const PRG_Info &prg_info) {
-    bool kmer_in_index = kmer_index.find(kmer) != kmer_index.end();
+    SearchBudget unlimited_budget = {};
+    SearchBudgetLimit exceeded_limit = SearchBudgetLimit::none;
+    return search_read_backwards(read, kmer, kmer_index, prg_info, unlimited_budget, exceeded_limit);
+}
+
+
+uint64_t gram::count_left_markers(const SearchStates &search_states,
+                                  const PRG_Info &prg_info) {
+    uint64_t count_markers = 0;
+    for (const auto &search_state: search_states) {
+        const auto &sa_interval = search_state.sa_interval;
+        count_markers += prg_info.bwt_markers_rank(sa_interval.second + 1)
+                         - prg_info.bwt_markers_rank(sa_interval.first);
+    }
+    return count_markers;
+}
+
+
+SearchBudgetLimit gram::check_search_budget(const SearchStates &search_states,
+                                            const uint64_t &marker_crossings,
+                                            const SearchBudget &search_budget) {
+    if (search_budget.max_marker_crossings != 0
+        and marker_crossings > search_budget.max_marker_crossings)
+        return SearchBudgetLimit::marker_crossings;
+
+    if (search_budget.max_search_states != 0
+        and search_states.size() > search_budget.max_search_states)
+        return SearchBudgetLimit::search_states;
+    return SearchBudgetLimit::none;
+}
+
+
+SearchBudgetLimit gram::check_final_search_budget(const SearchStates &search_states,
+                                                  const uint64_t &marker_crossings,
+                                                  const SearchBudget &search_budget) {
+    auto exceeded_limit = check_search_budget(search_states, marker_crossings, search_budget);
+    if (exceeded_limit != SearchBudgetLimit::none or search_budget.max_sa_interval_width == 0)
+        return exceeded_limit;
+    for (const auto &search_state: search_states) {
+        auto sa_interval_width = search_state.sa_interval.second - search_state.sa_interval.first + 1;
+        if (sa_interval_width > search_budget.max_sa_interval_width)
+            return SearchBudgetLimit::sa_interval_width;
+    }
+    return SearchBudgetLimit::none;
+}
+
+
+SearchStates gram::search_read_backwards(const Pattern &read,
+                                         const Pattern &kmer,
+                                         const KmerIndex &kmer_index,
+                                         const PRG_Info &prg_info,
+                                         const SearchBudget &search_budget,
+                                         SearchBudgetLimit &exceeded_limit) {
+    ExtendedSeedCache disabled_seed_cache(0);
+    return search_read_backwards(read, kmer, kmer_index, prg_info,
+                                 search_budget, disabled_seed_cache, exceeded_limit);
+}
+
+
+SearchBudgetLimit gram::check_extended_seed_budget(const ExtendedSeed &extended_seed,
+                                                   const SearchBudget &search_budget) {
+    if (search_budget.max_marker_crossings != 0
+        and extended_seed.marker_crossings > search_budget.max_marker_crossings)
+        return SearchBudgetLimit::marker_crossings;
+
+    if (search_budget.max_search_states != 0
+        and extended_seed.max_count_search_states > search_budget.max_search_states)
+        return SearchBudgetLimit::search_states;
+    return SearchBudgetLimit::none;
+}
+
+
+SearchStates gram::search_read_backwards(const Pattern &read,
+                                         const Pattern &kmer,
+                                         const KmerIndex &kmer_index,
+                                         const PRG_Info &prg_info,
+                                         const SearchBudget &search_budget,
+                                         ExtendedSeedCache &seed_cache,
+                                         SearchBudgetLimit &exceeded_limit) {
+    return search_read_backwards(read, pack_kmer(kmer), (uint32_t) kmer.size(), kmer_index, prg_info,
+                                 search_budget, seed_cache, exceeded_limit);
+}
+
+
+SearchStates gram::search_read_backwards(const Pattern &read,
+                                         const PackedKmer &kmer,
+                                         const uint32_t &kmer_size,
+                                         const KmerIndex &kmer_index,
+                                         const PRG_Info &prg_info,
+                                         const SearchBudget &search_budget,
+                                         ExtendedSeedCache &seed_cache,
+                                         SearchBudgetLimit &exceeded_limit) {
+    exceeded_limit = SearchBudgetLimit::none;
+    const auto kmer_index_it = kmer_index.find(kmer);
+    bool kmer_in_index = kmer_index_it != kmer_index.end();
     if (not kmer_in_index)
         return SearchStates{};
 
-    auto kmer_index_search_states = kmer_index.at(kmer);
+    const auto &kmer_index_search_states = kmer_index_it->second;
     if (kmer_index_search_states.empty())
         return kmer_index_search_states;
 
     auto read_begin = read.rbegin();
-    std::advance(read_begin, kmer.size());
+    std::advance(read_begin, kmer_size);
 
     SearchStates new_search_states = kmer_index_search_states;
+    bool marker_budget = search_budget.max_marker_crossings != 0;
+    uint64_t marker_crossings = 0;
+
+    // resume from the longest cached suffix the budget allows; the seed's figures
+    // stand in for the checks the skipped bases would have made
+    ExtendedSeed extended_seed = {};
+    auto seed_lookup = seed_cache.lookup(read, kmer_size, extended_seed);
+    bool seed_usable = seed_lookup.count_extension_bases != 0
+                       and check_extended_seed_budget(extended_seed, search_budget) == SearchBudgetLimit::none;
+    uint64_t count_extension_bases = 0;
+    if (seed_usable) {
+        new_search_states = extended_seed.search_states;
+        marker_crossings = extended_seed.marker_crossings;
+        count_extension_bases = seed_lookup.count_extension_bases;
+        std::advance(read_begin, count_extension_bases);
+    } else {
+        extended_seed = {};
+    }
+    bool recording_seeds = seed_lookup.kmer_hot;
 
     for (auto it = read_begin; it != read.rend(); ++it) {
+        // markers are counted before they fan out into allele search states
+        if (marker_budget or recording_seeds)
+            marker_crossings += count_left_markers(new_search_states, prg_info);
+        exceeded_limit = check_search_budget(new_search_states, marker_crossings, search_budget);
+        if (exceeded_limit != SearchBudgetLimit::none)
+            return SearchStates{};
+
+        recording_seeds = recording_seeds
+                          and count_extension_bases < ExtendedSeedCache::max_extension_bases;
+        if (recording_seeds) {
+            extended_seed.marker_crossings = marker_crossings;
+            extended_seed.max_count_search_states = std::max<uint64_t>(extended_seed.max_count_search_states,
+                                                                       new_search_states.size());
+        }
+
         const Base &pattern_char = *it;
         new_search_states = process_read_char_search_states(pattern_char,
                                                             new_search_states,
                                                             prg_info);
+        ++count_extension_bases;
         auto read_not_mapped = new_search_states.empty();
         if (read_not_mapped)
             break;
+
+        if (recording_seeds and count_extension_bases % ExtendedSeedCache::extension_step == 0) {
+            extended_seed.search_states = new_search_states;
+            seed_cache.record(read, kmer_size, count_extension_bases, extended_seed);
+        }
     }
 
+    exceeded_limit = check_final_search_budget(new_search_states, marker_crossings, search_budget);
+    if (exceeded_limit != SearchBudgetLimit::none)
+        return SearchStates{};
+
     new_search_states = handle_allele_encapsulated_states(new_search_states, prg_info);
     return new_search_states;
 }
 
 
+bool gram::read_reaches_no_site(const Pattern &read,
+                                const Pattern &kmer,
+                                const KmerIndex &kmer_index,
+                                const PRG_Info &prg_info) {
+    return read_reaches_no_site(read, pack_kmer(kmer), (uint32_t) kmer.size(), kmer_index, prg_info);
+}
+
+
+bool gram::read_reaches_no_site(const Pattern &read,
+                                const PackedKmer &kmer,
+                                const uint32_t &kmer_size,
+                                const KmerIndex &kmer_index,
+                                const PRG_Info &prg_info) {
+    bool reach_generated = prg_info.invariant_reach.kmer_size == kmer_size;
+    if (not reach_generated or read.size() < kmer_size)
+        return false;
+
+    const auto kmer_index_it = kmer_index.find(kmer);
+    if (kmer_index_it == kmer_index.end() or kmer_index_it->second.empty())
+        return false;
+
+    const uint64_t count_left_bases = read.size() - kmer_size;
+    for (const auto &search_state: kmer_index_it->second) {
+        if (not search_state.variant_site_path.empty())
+            return false;
+        if (not sa_interval_invariant(prg_info.invariant_reach,
+                                      prg_info.invariant_reach_rmq,
+                                      search_state.sa_interval,
+                                      count_left_bases))
+            return false;
+    }
+    return true;
+}
+
+
+SearchStates gram::search_invariant_read_backwards(const Pattern &read,
+                                                   const Pattern &kmer,
+                                                   const KmerIndex &kmer_index,
+                                                   const PRG_Info &prg_info,
+                                                   const SearchBudget &search_budget,
+                                                   SearchBudgetLimit &exceeded_limit) {
+    return search_invariant_read_backwards(read, pack_kmer(kmer), (uint32_t) kmer.size(), kmer_index, prg_info,
+                                           search_budget, exceeded_limit);
+}
+
+
+SearchStates gram::search_invariant_read_backwards(const Pattern &read,
+                                                   const PackedKmer &kmer,
+                                                   const uint32_t &kmer_size,
+                                                   const KmerIndex &kmer_index,
+                                                   const PRG_Info &prg_info,
+                                                   const SearchBudget &search_budget,
+                                                   SearchBudgetLimit &exceeded_limit) {
+    exceeded_limit = SearchBudgetLimit::none;
+    const auto kmer_index_it = kmer_index.find(kmer);
+    if (kmer_index_it == kmer_index.end())
+        return SearchStates{};
+
+    // no marker lies left of these suffixes within the read's length: no marker handling,
+    // no marker crossings, and no allele encapsulation to resolve
+    SearchStates new_search_states = kmer_index_it->second;
+    auto read_begin = read.rbegin();
+    std::advance(read_begin, kmer_size);
+    for (auto it = read_begin; it != read.rend(); ++it) {
+        exceeded_limit = check_search_budget(new_search_states, 0, search_budget);
+        if (exceeded_limit != SearchBudgetLimit::none)
+            return SearchStates{};
+
+        new_search_states = search_base_backwards(*it, new_search_states, prg_info);
+        if (new_search_states.empty())
+            return new_search_states;
+    }
+
+    exceeded_limit = check_final_search_budget(new_search_states, 0, search_budget);
+    if (exceeded_limit != SearchBudgetLimit::none)
+        return SearchStates{};
+    return new_search_states;
+}
+
+
+SearchStates gram::search_shared_suffix_backwards(const Pattern &read,
+                                                  const uint64_t &count_shared_bases,
+                                                  const uint32_t &kmer_size,
+                                                  const KmerIndex &kmer_index,
+                                                  const PRG_Info &prg_info,
+                                                  const SearchBudget &search_budget,
+                                                  SuffixSearchStack &search_stack,
+                                                  SearchBudgetLimit &exceeded_limit) {
+    exceeded_limit = SearchBudgetLimit::none;
+    if (read.size() < kmer_size) {
+        search_stack.clear();
+        return SearchStates{};
+    }
+
+    // levels of the previous read's search which this read's suffix shares
+    uint64_t count_shared_levels = 0;
+    if (count_shared_bases >= kmer_size)
+        count_shared_levels = count_shared_bases - kmer_size + 1;
+    if (search_stack.size() > count_shared_levels)
+        search_stack.resize(count_shared_levels);
+
+    if (search_stack.empty()) {
+        SuffixSearchLevel kmer_level = {};
+        const auto kmer_index_it = kmer_index.find(pack_read_kmer(read, kmer_size));
+        if (kmer_index_it != kmer_index.end())
+            kmer_level.search_states = kmer_index_it->second;
+        search_stack.emplace_back(kmer_level);
+    }
+
+    bool marker_budget = search_budget.max_marker_crossings != 0;
+    while (true) {
+        const auto level = search_stack.size() - 1;
+        const auto &level_search_states = search_stack.back().search_states;
+        bool read_searched = kmer_size + level == read.size();
+        if (level_search_states.empty() or read_searched)
+            break;
+
+        // markers are counted before they fan out into allele search states
+        uint64_t marker_crossings = search_stack.back().marker_crossings;
+        if (marker_budget)
+            marker_crossings += count_left_markers(level_search_states, prg_info);
+        exceeded_limit = check_search_budget(level_search_states, marker_crossings, search_budget);
+        if (exceeded_limit != SearchBudgetLimit::none)
+            return SearchStates{};
+
+        const Base &pattern_char = read[read.size() - kmer_size - level - 1];
+        auto next_search_states = process_read_char_search_states(pattern_char,
+                                                                  level_search_states,
+                                                                  prg_info);
+        search_stack.emplace_back(SuffixSearchLevel{std::move(next_search_states), marker_crossings});
+    }
+
+    const auto &last_level = search_stack.back();
+    exceeded_limit = check_final_search_budget(last_level.search_states, last_level.marker_crossings,
+                                               search_budget);
+    if (exceeded_limit != SearchBudgetLimit::none)
+        return SearchStates{};
+    return handle_allele_encapsulated_states(last_level.search_states, prg_info);
+}
+
+
 SearchState search_fm_index_base_backwards(const Base &pattern_char,
                                            const uint64_t char_first_sa_index,
                                            const SearchState &search_state,
@@ -440,27 +685,17 @@ MarkersSearchResults gram::left_markers_search(const SearchState &search_state,
     MarkersSearchResults markers_search_results;
 
     const auto &sa_interval = search_state.sa_interval;
-    auto max_sa_index = sa_interval.second;
-    auto sa_index = sa_interval.first;
-
-    auto num_markers_before = prg_info.bwt_markers_rank(sa_index);
-    uint64_t marker_count_offset = num_markers_before + 1;
-    if (marker_count_offset > prg_info.markers_mask_count_set_bits)
+    auto first_marker_rank = prg_info.bwt_markers_rank(sa_interval.first);
+    auto end_marker_rank = prg_info.bwt_markers_rank(sa_interval.second + 1);
+    if (first_marker_rank == end_marker_rank)
         return markers_search_results;
 
-    auto bwt_marker_index = prg_info.bwt_markers_select(marker_count_offset);
-
-    while (bwt_marker_index <= max_sa_index) {
-        auto marker = prg_info.fm_index.bwt[bwt_marker_index];
-        auto search_result = std::make_pair(bwt_marker_index, marker);
-        markers_search_results.emplace_back(search_result);
-
-        ++marker_count_offset;
-        if (marker_count_offset > prg_info.markers_mask_count_set_bits)
-            return markers_search_results;
-        bwt_marker_index = prg_info.bwt_markers_select(marker_count_offset);
+    markers_search_results.reserve(end_marker_rank - first_marker_rank);
+    for (auto marker_rank = first_marker_rank; marker_rank < end_marker_rank; ++marker_rank) {
+        uint64_t bwt_marker_index = prg_info.bwt_markers.indexes[marker_rank];
+        Marker marker = prg_info.bwt_markers.symbols[marker_rank];
+        markers_search_results.emplace_back(std::make_pair(bwt_marker_index, marker));
     }
-
     return markers_search_results;
 }
 
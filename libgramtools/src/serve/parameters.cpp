@@ -0,0 +1,64 @@
+#include <algorithm>
+
+#include <boost/program_options/variables_map.hpp>
+#include <boost/program_options/parsers.hpp>
+#include <boost/variant/variant.hpp>
+
+#include "common/parameters.hpp"
+#include "quasimap/parameters.hpp"
+#include "serve/parameters.hpp"
+
+
+using namespace gram;
+
+
+Parameters commands::serve::parse_parameters(po::variables_map &vm, const po::parsed_options &parsed) {
+    po::options_description serve_description("serve options");
+    serve_description.add_options()
+                             ("gram", po::value<std::string>(),
+                              "gramtools directory")
+                             ("kmer-size", po::value<uint32_t>(),
+                              "kmer size used in constructing the kmer index")
+                             ("socket", po::value<std::string>(),
+                              "Unix domain socket file path on which quasimap jobs are accepted")
+                             ("max-threads", po::value<uint32_t>()->default_value(1),
+                              "maximum number of threads used, shared between running jobs")
+                             ("max-jobs", po::value<uint32_t>()->default_value(1),
+                              "maximum number of quasimap jobs run at once")
+                             ("seed", po::value<uint64_t>()->default_value(0),
+                              "seed for choosing between multiple mappings, same seed gives same coverage")
+                             ("max-search-states", po::value<uint64_t>()->default_value(0),
+                              "abandon reads with more live search states (0: no limit)")
+                             ("max-sa-interval-width", po::value<uint64_t>()->default_value(0),
+                              "abandon reads ending with a wider search state SA interval (0: no limit)")
+                             ("max-marker-crossings", po::value<uint64_t>()->default_value(0),
+                              "abandon reads crossing more variant site markers (0: no limit)")
+                             ("read-cache-size", po::value<uint64_t>()->default_value(0),
+                              "number of distinct reads whose search results each job caches (0: no cache)")
+                             ("sort-reads-batch", po::bool_switch()->default_value(false),
+                              "search reads sorted by suffix, sharing search steps between reads, in batches instead of "
+                              "scheduled chunks (not with --read-cache-size)");
+
+    std::vector<std::string> opts = po::collect_unrecognized(parsed.options,
+                                                             po::include_positional);
+    opts.erase(opts.begin());
+    po::store(po::command_line_parser(opts).options(serve_description).run(), vm);
+
+    Parameters parameters = {};
+    commands::quasimap::set_gram_directory(parameters, vm["gram"].as<std::string>());
+
+    parameters.kmers_size = vm["kmer-size"].as<uint32_t>();
+    parameters.socket_fpath = vm["socket"].as<std::string>();
+    parameters.maximum_threads = vm["max-threads"].as<uint32_t>();
+    parameters.max_jobs = std::max<uint32_t>(1, vm["max-jobs"].as<uint32_t>());
+    parameters.seed = vm["seed"].as<uint64_t>();
+    parameters.max_search_states = vm["max-search-states"].as<uint64_t>();
+    parameters.max_sa_interval_width = vm["max-sa-interval-width"].as<uint64_t>();
+    parameters.max_marker_crossings = vm["max-marker-crossings"].as<uint64_t>();
+    parameters.read_cache_size = vm["read-cache-size"].as<uint64_t>();
+    parameters.sort_reads_batch = vm["sort-reads-batch"].as<bool>();
+    parameters.numa_mode = "none";
+    parameters.huge_pages_mode = "none";
+    commands::quasimap::check_conflicting_options(parameters);
+    return parameters;
+}
@@ -0,0 +1,379 @@
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <boost/filesystem.hpp>
+#include <omp.h>
+
+#include "common/timer_report.hpp"
+#include "prg/prg.hpp"
+#include "kmer_index/load.hpp"
+
+#include "quasimap/quasimap.hpp"
+#include "quasimap/parameters.hpp"
+#include "serve/serve.hpp"
+
+
+namespace fs = boost::filesystem;
+using namespace gram;
+
+
+ServeJob gram::parse_serve_request(const std::string &request) {
+    std::vector<std::string> fields;
+    std::string::size_type start = 0;
+    while (true) {
+        auto end = request.find('\t', start);
+        fields.emplace_back(request.substr(start, end - start));
+        if (end == std::string::npos)
+            break;
+        start = end + 1;
+    }
+    if (not fields.back().empty() and fields.back().back() == '\n')
+        fields.back().pop_back();
+
+    ServeJob job = {};
+    if (fields.size() == 1 and fields[0] == "shutdown") {
+        job.shutdown = true;
+        job.valid = true;
+        return job;
+    }
+    if (fields.size() < 3 or fields[0] != "quasimap")
+        return job;
+
+    for (const auto &field: fields) {
+        if (field.empty())
+            return job;
+    }
+    job.run_dirpath = fields[1];
+    job.reads_fpaths.assign(fields.begin() + 2, fields.end());
+    job.valid = true;
+    return job;
+}
+
+
+void ServeJobQueue::push(QueuedServeJob queued_job) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        queued_jobs.emplace_back(std::move(queued_job));
+    }
+    job_queued.notify_one();
+}
+
+
+bool ServeJobQueue::pop(QueuedServeJob &queued_job) {
+    std::unique_lock<std::mutex> lock(mutex);
+    job_queued.wait(lock, [this] { return closed or not queued_jobs.empty(); });
+    if (queued_jobs.empty())
+        return false;
+    queued_job = std::move(queued_jobs.front());
+    queued_jobs.pop_front();
+    return true;
+}
+
+
+void ServeJobQueue::close() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        closed = true;
+    }
+    job_queued.notify_all();
+}
+
+
+uint64_t ServeJobQueue::size() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return queued_jobs.size();
+}
+
+
+uint32_t ServeThreads::acquire(const uint64_t &count_waiting_jobs) {
+    std::unique_lock<std::mutex> lock(mutex);
+    thread_released.wait(lock, [this] { return count_free > 0; });
+    auto count_threads = std::max<uint32_t>(1, count_free / std::max<uint64_t>(1, count_waiting_jobs));
+    count_free -= count_threads;
+    return count_threads;
+}
+
+
+void ServeThreads::release(const uint32_t &count_threads) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        count_free += count_threads;
+    }
+    thread_released.notify_all();
+}
+
+
+static constexpr time_t request_timeout_seconds = 5;
+
+
+static void send_reply(const int &client_fd, const std::string &reply) {
+    uint64_t count_sent = 0;
+    while (count_sent < reply.size()) {
+        auto count = send(client_fd, reply.data() + count_sent, reply.size() - count_sent, MSG_NOSIGNAL);
+        if (count < 0 and errno == EINTR)
+            continue;
+        // the client went away, the job's outputs are on disk regardless
+        if (count <= 0)
+            return;
+        count_sent += count;
+    }
+}
+
+
+static std::string receive_request(const int &client_fd) {
+    // a client which connects and sends nothing must not hold its reader thread forever
+    timeval timeout = {};
+    timeout.tv_sec = request_timeout_seconds;
+    setsockopt(client_fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    constexpr uint64_t max_request_size = 1 << 16;
+    std::string request;
+    char buffer[4096];
+    while (request.size() < max_request_size
+           and request.find('\n') == std::string::npos) {
+        auto count = recv(client_fd, buffer, sizeof(buffer), 0);
+        if (count < 0 and errno == EINTR)
+            continue;
+        if (count <= 0)
+            break;
+        request.append(buffer, count);
+    }
+    // timed out or closed before the request line ended
+    auto end = request.find('\n');
+    if (end == std::string::npos)
+        return "";
+    return request.substr(0, end);
+}
+
+
+static std::string check_job_paths(const ServeJob &job) {
+    if (not fs::is_directory(job.run_dirpath))
+        return "run directory not found: " + job.run_dirpath;
+    for (const auto &reads_fpath: job.reads_fpaths) {
+        if (not fs::is_regular_file(reads_fpath))
+            return "reads file not found: " + reads_fpath;
+    }
+    return "";
+}
+
+
+static void run_job(const QueuedServeJob &queued_job,
+                    const Parameters &server_parameters,
+                    const KmerIndex &kmer_index,
+                    const PRG_Info &prg_info) {
+    const auto &job = queued_job.job;
+    auto error = check_job_paths(job);
+    if (not error.empty()) {
+        send_reply(queued_job.client_fd, "error: " + error + "\n");
+        return;
+    }
+
+    auto parameters = server_parameters;
+    parameters.reads_fpaths = job.reads_fpaths;
+    commands::quasimap::set_run_directory(parameters, job.run_dirpath);
+
+    std::cout << "Running quasimap job: " << job.run_dirpath << std::endl;
+    std::ostringstream reply;
+    try {
+        auto quasimap_stats = quasimap_reads(parameters, kmer_index, prg_info);
+        commands::quasimap::report_stats(reply, quasimap_stats, parameters);
+        reply << "ok" << std::endl;
+    } catch (const std::exception &e) {
+        reply.str("");
+        reply << "error: " << e.what() << std::endl;
+    }
+    std::cout << "Finished quasimap job: " << job.run_dirpath << std::endl;
+    send_reply(queued_job.client_fd, reply.str());
+}
+
+
+// a socket file left by a server which did not shut down cleanly refuses connections
+static bool is_stale_socket(const sockaddr_un &address) {
+    struct stat file_status = {};
+    if (lstat(address.sun_path, &file_status) != 0 or not S_ISSOCK(file_status.st_mode))
+        return false;
+
+    int probe_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (probe_fd < 0)
+        return false;
+    bool refused = connect(probe_fd, (const sockaddr *) &address, sizeof(address)) != 0
+                   and errno == ECONNREFUSED;
+    close(probe_fd);
+    return refused;
+}
+
+
+static int listen_on_socket(const std::string &socket_fpath) {
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    if (socket_fpath.size() >= sizeof(address.sun_path)) {
+        std::cout << "Socket path too long: " << socket_fpath << "\nExiting 1" << std::endl;
+        std::exit(1);
+    }
+    std::strcpy(address.sun_path, socket_fpath.c_str());
+
+    struct stat file_status = {};
+    if (lstat(socket_fpath.c_str(), &file_status) == 0) {
+        if (not is_stale_socket(address)) {
+            std::cout << "Socket path exists and is not a stale socket: " << socket_fpath
+                      << "\nExiting 1" << std::endl;
+            std::exit(1);
+        }
+        unlink(socket_fpath.c_str());
+    }
+    // owner only before listening, connections are refused until then
+    int socket_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    bool listening = socket_fd >= 0
+                     and bind(socket_fd, (sockaddr *) &address, sizeof(address)) == 0
+                     and chmod(socket_fpath.c_str(), S_IRUSR | S_IWUSR) == 0
+                     and listen(socket_fd, SOMAXCONN) == 0;
+    if (not listening) {
+        std::cout << "Cannot listen on socket " << socket_fpath << ": " << std::strerror(errno)
+                  << "\nExiting 1" << std::endl;
+        std::exit(1);
+    }
+    return socket_fd;
+}
+
+
+// jobs write into any directory the server can, so only the server's own user may submit them
+static bool is_server_user(const int &client_fd) {
+    ucred credentials = {};
+    socklen_t credentials_size = sizeof(credentials);
+    if (getsockopt(client_fd, SOL_SOCKET, SO_PEERCRED, &credentials, &credentials_size) != 0)
+        return false;
+    return credentials.uid == getuid();
+}
+
+
+// request reading threads still running, the server waits for them before closing the job queue
+class RequestReaders {
+public:
+    void started() {
+        std::lock_guard<std::mutex> lock(mutex);
+        ++count_running;
+    }
+
+    void finished() {
+        std::lock_guard<std::mutex> lock(mutex);
+        --count_running;
+        all_finished.notify_all();
+    }
+
+    void wait() {
+        std::unique_lock<std::mutex> lock(mutex);
+        all_finished.wait(lock, [this] { return count_running == 0; });
+    }
+
+private:
+    std::mutex mutex;
+    std::condition_variable all_finished;
+    uint64_t count_running = 0;
+};
+
+
+// runs off the accept loop, so a slow client holds up only its own connection
+static void read_request(const int client_fd,
+                         const int socket_fd,
+                         ServeJobQueue &job_queue,
+                         std::atomic<bool> &shutdown_requested) {
+    auto job = parse_serve_request(receive_request(client_fd));
+    if (not job.valid) {
+        send_reply(client_fd, "error: malformed request\n");
+        close(client_fd);
+        return;
+    }
+    if (job.shutdown) {
+        send_reply(client_fd, "ok\n");
+        close(client_fd);
+        shutdown_requested = true;
+        // wakes the accept loop
+        ::shutdown(socket_fd, SHUT_RDWR);
+        return;
+    }
+    job_queue.push(QueuedServeJob{client_fd, job});
+}
+
+
+void commands::serve::run(const Parameters &parameters) {
+    std::cout << "Executing serve command" << std::endl;
+    auto timer = TimerReport();
+
+    timer.start("Load data");
+    std::cout << "Loading PRG data" << std::endl;
+    const auto prg_info = load_prg_info(parameters);
+    std::cout << "Loading kmer index data" << std::endl;
+    const auto kmer_index = kmer_index::load(parameters);
+    timer.stop();
+
+    timer.start("Serve");
+    int socket_fd = listen_on_socket(parameters.socket_fpath);
+    std::cout << "Accepting quasimap jobs on " << parameters.socket_fpath << std::endl;
+
+    ServeJobQueue job_queue;
+    ServeThreads serve_threads(std::max<uint32_t>(1, parameters.maximum_threads));
+    std::vector<std::thread> job_runners;
+    for (uint32_t i = 0; i < parameters.max_jobs; ++i) {
+        job_runners.emplace_back([&] {
+            QueuedServeJob queued_job;
+            while (job_queue.pop(queued_job)) {
+                auto job_threads = serve_threads.acquire(job_queue.size() + 1);
+                omp_set_num_threads(job_threads);
+                run_job(queued_job, parameters, kmer_index, prg_info);
+                serve_threads.release(job_threads);
+                close(queued_job.client_fd);
+            }
+        });
+    }
+
+    std::atomic<bool> shutdown_requested(false);
+    RequestReaders request_readers;
+    while (true) {
+        int client_fd = accept(socket_fd, nullptr, nullptr);
+        if (shutdown_requested) {
+            if (client_fd >= 0)
+                close(client_fd);
+            break;
+        }
+        if (client_fd < 0) {
+            if (errno == EINTR or errno == ECONNABORTED)
+                continue;
+            std::cout << "Cannot accept connection: " << std::strerror(errno) << std::endl;
+            break;
+        }
+        if (not is_server_user(client_fd)) {
+            send_reply(client_fd, "error: permission denied\n");
+            close(client_fd);
+            continue;
+        }
+
+        request_readers.started();
+        std::thread([&, client_fd] {
+            read_request(client_fd, socket_fd, job_queue, shutdown_requested);
+            request_readers.finished();
+        }).detach();
+    }
+
+    // queued jobs still run before the server exits
+    std::cout << "Shutting down, finishing queued jobs" << std::endl;
+    request_readers.wait();
+    job_queue.close();
+    for (auto &job_runner: job_runners)
+        job_runner.join();
+    close(socket_fd);
+    unlink(parameters.socket_fpath.c_str());
+    timer.stop();
+
+    timer.report();
+}
@@ -0,0 +1,80 @@
+#include <fstream>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "common/huge_pages.hpp"
+
+
+using namespace gram;
+
+
+bool transparent_pages_supported() {
+    std::ifstream enabled("/sys/kernel/mm/transparent_hugepage/enabled");
+    return enabled.good();
+}
+
+
+TEST(AdviseTransparentPages, LargeAllocationAfterSnapshot_AlignedRangeAdvised) {
+    auto mappings_before = huge_pages::anonymous_mappings();
+    std::vector<uint8_t> allocation(8 * huge_pages::huge_page_size, 1);
+    auto start = reinterpret_cast<uint64_t>(allocation.data());
+    auto end = start + allocation.size();
+    uint64_t aligned_start = (start + huge_pages::huge_page_size - 1)
+                             / huge_pages::huge_page_size * huge_pages::huge_page_size;
+    uint64_t aligned_end = end / huge_pages::huge_page_size * huge_pages::huge_page_size;
+
+    auto result = huge_pages::advise_transparent_pages(mappings_before);
+    if (transparent_pages_supported()) {
+        EXPECT_GE(result, aligned_end - aligned_start);
+    } else {
+        EXPECT_EQ(result, (uint64_t) 0);
+    }
+}
+
+
+TEST(AdviseTransparentPages, LargeAllocationBeforeSnapshot_NotAdvised) {
+    std::vector<uint8_t> allocation(8 * huge_pages::huge_page_size, 1);
+    auto mappings_before = huge_pages::anonymous_mappings();
+
+    auto result = huge_pages::advise_transparent_pages(mappings_before);
+    EXPECT_LT(result, 7 * huge_pages::huge_page_size);
+}
+
+
+TEST(SubtractRanges, OverlappingRanges_UncoveredPartsRemain) {
+    huge_pages::MemoryRanges ranges = {{0, 10}, {20, 30}, {35, 40}, {60, 70}};
+    auto result = huge_pages::subtract_ranges({5, 50}, ranges);
+    huge_pages::MemoryRanges expected = {{10, 20}, {30, 35}, {40, 50}};
+    EXPECT_EQ(result, expected);
+}
+
+
+TEST(SubtractRanges, RangeCovered_NothingRemains) {
+    huge_pages::MemoryRanges ranges = {{0, 10}, {10, 30}};
+    auto result = huge_pages::subtract_ranges({5, 25}, ranges);
+    EXPECT_TRUE(result.empty());
+}
+
+
+TEST(TlbMissCounter, LargeBufferTouched_MissesNeverDecrease) {
+    TlbMissCounter tlb_miss_counter;
+    auto count_misses_before = tlb_miss_counter.count_misses();
+
+    // one read per 4 KB page, over far more pages than any data TLB holds
+    const uint64_t page_size = 4096;
+    std::vector<uint8_t> buffer(256 * huge_pages::huge_page_size, 1);
+    volatile uint64_t sum = 0;
+    for (uint64_t i = 0; i < buffer.size(); i += page_size)
+        sum = sum + buffer[i];
+
+    auto count_misses_after = tlb_miss_counter.count_misses();
+    if (not tlb_miss_counter.available()) {
+        EXPECT_EQ(count_misses_after, (uint64_t) 0);
+        return;
+    }
+    // some PMUs (virtual machines among them) open the event but never count it
+    EXPECT_GE(count_misses_after, count_misses_before);
+    if (count_misses_after != 0)
+        EXPECT_GT(count_misses_after, count_misses_before);
+}
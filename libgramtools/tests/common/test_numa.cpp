@@ -0,0 +1,64 @@
+#include "gtest/gtest.h"
+
+#include "common/numa.hpp"
+
+
+using namespace gram;
+
+
+TEST(ParseCpuList, RangesAndSingleCpus_AllCpusListed) {
+    auto result = numa::parse_cpu_list("0-3,8,10-11");
+    numa::CPUs expected = {0, 1, 2, 3, 8, 10, 11};
+    EXPECT_EQ(result, expected);
+}
+
+
+TEST(ParseCpuList, EmptyList_NoCpus) {
+    auto result = numa::parse_cpu_list("");
+    EXPECT_TRUE(result.empty());
+}
+
+
+TEST(RunOnNodes, TasksPinnedToNodeCpus_CallingThreadAffinityUnchanged) {
+    auto calling_thread_cpus = numa::thread_cpus();
+    if (calling_thread_cpus.empty())
+        return;
+    std::vector<numa::CPUs> nodes_cpus = {
+            calling_thread_cpus,
+            numa::CPUs {calling_thread_cpus.front()},
+            numa::CPUs {calling_thread_cpus.back()},
+    };
+
+    std::vector<numa::CPUs> tasks_cpus(nodes_cpus.size());
+    numa::run_on_nodes(nodes_cpus, 1, [&tasks_cpus](const uint64_t &node) {
+        tasks_cpus[node] = numa::thread_cpus();
+    });
+
+    std::vector<numa::CPUs> expected = {
+            numa::CPUs {},
+            numa::CPUs {calling_thread_cpus.front()},
+            numa::CPUs {calling_thread_cpus.back()},
+    };
+    EXPECT_EQ(tasks_cpus, expected);
+    EXPECT_EQ(numa::thread_cpus(), calling_thread_cpus);
+}
+
+
+TEST(MemoryPolicy, CurrentPolicyApplied_PolicyUnchanged) {
+    auto memory_policy = numa::current_policy();
+    if (not numa::apply_policy(memory_policy))
+        return;
+    auto result = numa::current_policy();
+    EXPECT_EQ(result.mode, memory_policy.mode);
+    EXPECT_EQ(result.nodes_mask, memory_policy.nodes_mask);
+}
+
+
+TEST(MemoryPolicy, InterleavedThenDefault_DefaultPolicyRestored) {
+    if (not numa::interleave_allocations(numa::node_ids()))
+        return;
+    EXPECT_NE(numa::current_policy().mode, numa::MemoryPolicy{}.mode);
+
+    numa::default_allocations();
+    EXPECT_EQ(numa::current_policy().mode, numa::MemoryPolicy{}.mode);
+}
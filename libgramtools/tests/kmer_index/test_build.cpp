@@ -53,7 +53,7 @@ TEST(IndexKmers, KmerCrossesSecondAllele_CorrectVariantSitePath) {
     Patterns kmers = {kmer};
 
     auto kmer_index = index_kmers(kmers, kmer_size, prg_info);
-    auto search_states = kmer_index[kmer];
+    auto search_states = kmer_index[pack_kmer(kmer)];
     auto search_state = search_states.front();
     auto result = search_state.variant_site_path;
 
@@ -73,7 +73,7 @@ TEST(IndexKmers, KmerDoesNotCrossSite_CorrectSaInterval) {
     Patterns kmers = {kmer};
 
     auto kmer_index = index_kmers(kmers, kmer_size, prg_info);
-    auto search_states = kmer_index[kmer];
+    auto search_states = kmer_index[pack_kmer(kmer)];
     auto search_state = search_states.front();
     auto result = search_state.sa_interval;
 
@@ -91,7 +91,7 @@ TEST(IndexKmers, KmerDoesNotCrossSite_CorrectVariantSitePath) {
     Patterns kmers = {kmer};
 
     auto kmer_index = index_kmers(kmers, kmer_size, prg_info);
-    auto search_states = kmer_index[kmer];
+    auto search_states = kmer_index[pack_kmer(kmer)];
     auto search_state = search_states.front();
     auto result = search_state.variant_site_path;
 
@@ -109,7 +109,7 @@ TEST(IndexKmers, KmerCrossesFirstAllele_VariantRegionRecordedInSites) {
     Patterns kmers = {kmer};
 
     auto kmer_index = index_kmers(kmers, kmer_size, prg_info);
-    auto search_states = kmer_index[kmer];
+    auto search_states = kmer_index[pack_kmer(kmer)];
     auto search_state = search_states.front();
     auto result = search_state.variant_site_path;
 
@@ -136,7 +136,7 @@ TEST(IndexKmers, BothKmersOverlapVariantSiteAlleles_CorrectSearchResults) {
     auto result = index_kmers(kmers, kmer_size, prg_info);
 
     KmerIndex expected = {
-            {first_full_kmer,
+            {pack_kmer(first_full_kmer),
                     SearchStates {
                             SearchState {
                                     SA_Interval {3, 3},
@@ -147,7 +147,7 @@ TEST(IndexKmers, BothKmersOverlapVariantSiteAlleles_CorrectSearchResults) {
                             }
                     }
             },
-            {second_full_kmer,
+            {pack_kmer(second_full_kmer),
                     SearchStates {
                             SearchState {
                                     SA_Interval {3, 3},
@@ -179,7 +179,7 @@ TEST(IndexKmers, KmerNotFoundInPrg_KmerAbsentFromKmerIndex) {
     auto result = index_kmers(kmers, kmer_size, prg_info);
 
     KmerIndex expected = {
-            {second_full_kmer,
+            {pack_kmer(second_full_kmer),
                     SearchStates {
                             SearchState {
                                     SA_Interval {3, 3},
@@ -210,7 +210,7 @@ TEST(IndexKmers, OneKmersOverlapsVariantSiteAllele_CorrectSearchResults) {
 
     auto kmer_index = index_kmers(kmers, kmer_size, prg_info);
 
-    auto first_search_states = kmer_index[first_full_kmer];
+    auto first_search_states = kmer_index[pack_kmer(first_full_kmer)];
     auto first_search_state = first_search_states.front();
     auto first_result = first_search_state.variant_site_path;
     VariantSitePath first_expected = {
@@ -218,7 +218,7 @@ TEST(IndexKmers, OneKmersOverlapsVariantSiteAllele_CorrectSearchResults) {
     };
     EXPECT_EQ(first_result, first_expected);
 
-    auto second_search_states = kmer_index[second_full_kmer];
+    auto second_search_states = kmer_index[pack_kmer(second_full_kmer)];
     EXPECT_TRUE(second_search_states.empty());
 }
 
@@ -239,7 +239,7 @@ TEST(IndexKmers, ThreeKmersOverlapSiteThreeAllele_CorrectSearchResults) {
 
     auto kmer_index = index_kmers(kmers, kmer_size, prg_info);
 
-    auto search_states = kmer_index[first_full_kmer];
+    auto search_states = kmer_index[pack_kmer(first_full_kmer)];
     auto search_state = search_states.front();
     auto result = search_state.variant_site_path;
     VariantSitePath expected = {
@@ -247,7 +247,7 @@ TEST(IndexKmers, ThreeKmersOverlapSiteThreeAllele_CorrectSearchResults) {
     };
     EXPECT_EQ(result, expected);
 
-    search_states = kmer_index[second_full_kmer];
+    search_states = kmer_index[pack_kmer(second_full_kmer)];
     search_state = search_states.front();
     result = search_state.variant_site_path;
     expected = {
@@ -255,7 +255,7 @@ TEST(IndexKmers, ThreeKmersOverlapSiteThreeAllele_CorrectSearchResults) {
     };
     EXPECT_EQ(result, expected);
 
-    search_states = kmer_index[third_full_kmer];
+    search_states = kmer_index[pack_kmer(third_full_kmer)];
     search_state = search_states.front();
     result = search_state.variant_site_path;
     expected = {
@@ -281,7 +281,7 @@ TEST(IndexKmers, ThreeKmersOneMissMatch_CorrectSearchResults) {
 
     auto kmer_index = index_kmers(kmers, kmer_size, prg_info);
 
-    auto search_states = kmer_index[first_full_kmer];
+    auto search_states = kmer_index[pack_kmer(first_full_kmer)];
     auto search_state = search_states.front();
     auto result = search_state.variant_site_path;
     VariantSitePath expected = {
@@ -289,7 +289,7 @@ TEST(IndexKmers, ThreeKmersOneMissMatch_CorrectSearchResults) {
     };
     EXPECT_EQ(result, expected);
 
-    search_states = kmer_index[second_full_kmer];
+    search_states = kmer_index[pack_kmer(second_full_kmer)];
     search_state = search_states.front();
     result = search_state.variant_site_path;
     expected = {
@@ -297,7 +297,7 @@ TEST(IndexKmers, ThreeKmersOneMissMatch_CorrectSearchResults) {
     };
     EXPECT_EQ(result, expected);
 
-    search_states = kmer_index[third_full_kmer];
+    search_states = kmer_index[pack_kmer(third_full_kmer)];
     EXPECT_TRUE(search_states.empty());
 }
 
@@ -314,7 +314,7 @@ TEST(IndexKmers, OneKmerStartsAtAllele_SiteFound) {
 
     auto kmer_index = index_kmers(kmers, kmer_size, prg_info);
 
-    auto search_states = kmer_index[first_full_kmer];
+    auto search_states = kmer_index[pack_kmer(first_full_kmer)];
     auto search_state = search_states.front();
     auto result = search_state.variant_site_path;
     VariantSitePath expected = {
@@ -336,10 +336,10 @@ TEST(IndexKmers, KmerFromAlleleCenter_KmerEntryFoundNoVariantSitePath) {
 
     auto kmer_index = index_kmers(kmers, kmer_size, prg_info);
 
-    auto found = kmer_index.find(first_full_kmer) != kmer_index.end();
+    auto found = kmer_index.find(pack_kmer(first_full_kmer)) != kmer_index.end();
     EXPECT_TRUE(found);
 
-    auto search_states = kmer_index[first_full_kmer];
+    auto search_states = kmer_index[pack_kmer(first_full_kmer)];
     auto search_state = search_states.front();
     auto result = search_state.variant_site_path;
     VariantSitePath expected = {};
@@ -361,7 +361,7 @@ TEST(IndexKmers, TwoKmersStartAtAllele_SitesFound) {
 
     auto kmer_index = index_kmers(kmers, kmer_size, prg_info);
 
-    auto search_states = kmer_index[first_full_kmer];
+    auto search_states = kmer_index[pack_kmer(first_full_kmer)];
     auto search_state = search_states.front();
     auto result = search_state.variant_site_path;
     VariantSitePath expected = {
@@ -369,7 +369,7 @@ TEST(IndexKmers, TwoKmersStartAtAllele_SitesFound) {
     };
     EXPECT_EQ(result, expected);
 
-    search_states = kmer_index[second_full_kmer];
+    search_states = kmer_index[pack_kmer(second_full_kmer)];
     search_state = search_states.front();
     result = search_state.variant_site_path;
     expected = {
@@ -391,7 +391,7 @@ TEST(IndexKmers, KmerEndingInAllele_SingleSiteFound) {
 
     auto kmer_index = index_kmers(kmers, kmer_size, prg_info);
 
-    auto search_states = kmer_index[first_full_kmer];
+    auto search_states = kmer_index[pack_kmer(first_full_kmer)];
     auto search_state = search_states.front();
     auto result = search_state.variant_site_path;
     VariantSitePath expected = {
@@ -415,7 +415,7 @@ TEST(IndexKmers, TwoKmersEndingInAlleles_TwoSingleSitesFound) {
 
     auto kmer_index = index_kmers(kmers, kmer_size, prg_info);
 
-    auto search_states = kmer_index[first_full_kmer];
+    auto search_states = kmer_index[pack_kmer(first_full_kmer)];
     auto search_state = search_states.front();
     auto result = search_state.variant_site_path;
     VariantSitePath expected = {
@@ -423,7 +423,7 @@ TEST(IndexKmers, TwoKmersEndingInAlleles_TwoSingleSitesFound) {
     };
     EXPECT_EQ(result, expected);
 
-    search_states = kmer_index[second_full_kmer];
+    search_states = kmer_index[pack_kmer(second_full_kmer)];
     search_state = search_states.front();
     result = search_state.variant_site_path;
     expected = {
@@ -445,7 +445,7 @@ TEST(IndexKmers, KmerStartingInSiteAndEndInAnotherSite_CorrectVariantSitePath) {
 
     auto kmer_index = index_kmers(kmers, kmer_size, prg_info);
 
-    auto search_states = kmer_index[first_full_kmer];
+    auto search_states = kmer_index[pack_kmer(first_full_kmer)];
     auto search_state = search_states.front();
     auto result = search_state.variant_site_path;
     VariantSitePath expected = {
@@ -521,7 +521,7 @@ TEST(IndexKmers, GivenPrgWithLongNonVariantTail_KmerEndingAtTailExtracted) {
                                   parameters.kmers_size,
                                   prg_info);
     Pattern target_kmer = {4, 3, 3, 1, 1, 2, 3, 3, 2, 4, 2, 3, 2, 3, 3};
-    auto found = kmer_index.find(target_kmer) != kmer_index.end();
+    auto found = kmer_index.find(pack_kmer(target_kmer)) != kmer_index.end();
     EXPECT_TRUE(found);
 }
 
@@ -541,7 +541,7 @@ TEST(IndexKmers, GivenPrgWithLongNonVariantTail_KmerStartingAtLeftMostAlleleChar
                                   parameters.kmers_size,
                                   prg_info);
     Pattern target_kmer = {1, 4, 2, 2, 2, 2, 3, 1, 2, 3, 1, 4, 4, 2, 2};
-    auto found = kmer_index.find(target_kmer) != kmer_index.end();
+    auto found = kmer_index.find(pack_kmer(target_kmer)) != kmer_index.end();
     EXPECT_TRUE(found);
 }
 
@@ -561,7 +561,7 @@ TEST(IndexKmers, GivenPrgWithLongNonVariantTail_KmerImmediatelyAfterSiteExtracte
                                   parameters.kmers_size,
                                   prg_info);
     Pattern target_kmer = {4, 2, 2, 2, 2, 3, 1, 2, 3, 1, 4, 4, 2, 2, 2};
-    auto found = kmer_index.find(target_kmer) != kmer_index.end();
+    auto found = kmer_index.find(pack_kmer(target_kmer)) != kmer_index.end();
     EXPECT_TRUE(found);
 }
 
@@ -582,7 +582,7 @@ TEST(IndexKmers, KmerStartsOneBaseBeyondRangeEdge_KmerNotExtracted) {
                                   parameters.kmers_size,
                                   prg_info);
     Pattern target_kmer = {3, 1, 2, 3, 1, 4, 4, 2, 2, 2, 2, 3, 1, 2, 3};
-    auto found = kmer_index.find(target_kmer) != kmer_index.end();
+    auto found = kmer_index.find(pack_kmer(target_kmer)) != kmer_index.end();
     EXPECT_FALSE(found);
 }
 
@@ -603,7 +603,7 @@ TEST(IndexKmers, KmerStartsAtRangeEdge_KmerExtracted) {
                                   parameters.kmers_size,
                                   prg_info);
     Pattern target_kmer = {3, 1, 2, 3, 1, 4, 4, 2, 2, 2, 2, 3, 1, 2, 3};
-    auto found = kmer_index.find(target_kmer) != kmer_index.end();
+    auto found = kmer_index.find(pack_kmer(target_kmer)) != kmer_index.end();
     EXPECT_TRUE(found);
 }
 
@@ -623,7 +623,7 @@ TEST(IndexKmers, KmerWithinMaxReadSizeRegionNoSiteOverlap_KmerFound) {
                                   parameters.kmers_size,
                                   prg_info);
     Pattern target_kmer = {1, 2, 1, 3, 1, 2, 3, 1, 4, 4, 2, 4, 2, 2, 4, 3, 1, 2};
-    auto found = kmer_index.find(target_kmer) != kmer_index.end();
+    auto found = kmer_index.find(pack_kmer(target_kmer)) != kmer_index.end();
     EXPECT_TRUE(found);
 }
 
@@ -643,7 +643,7 @@ TEST(IndexKmers, KmerEndJustOutsideMaxReadSize_KmerNotFoundInIndex) {
                                   parameters.kmers_size,
                                   prg_info);
     Pattern target_kmer = {1, 2, 1, 3, 1, 2, 3, 1, 4, 4, 2, 4, 2, 2, 4, 3, 1, 2};
-    auto found = kmer_index.find(target_kmer) != kmer_index.end();
+    auto found = kmer_index.find(pack_kmer(target_kmer)) != kmer_index.end();
     EXPECT_FALSE(found);
 }
 
@@ -663,7 +663,7 @@ TEST(IndexKmers, TwoSitesAndKmerWithinMaxReadSizeRegionNoSiteOverlap_KmerFound)
                                   parameters.kmers_size,
                                   prg_info);
     Pattern target_kmer = {2, 3, 1, 4, 4};
-    auto found = kmer_index.find(target_kmer) != kmer_index.end();
+    auto found = kmer_index.find(pack_kmer(target_kmer)) != kmer_index.end();
     EXPECT_TRUE(found);
 }
 
@@ -683,7 +683,7 @@ TEST(IndexKmers, TwoSitesAndKmerOutsideMaxReadSizeRegionNoSiteOverlap_KmerNotFou
                                   parameters.kmers_size,
                                   prg_info);
     Pattern target_kmer = {2, 3, 1, 4, 4, 2, 4, 2, 2, 4, 3, 1};
-    auto found = kmer_index.find(target_kmer) != kmer_index.end();
+    auto found = kmer_index.find(pack_kmer(target_kmer)) != kmer_index.end();
     EXPECT_FALSE(found);
 }
 
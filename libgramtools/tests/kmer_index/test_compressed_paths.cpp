@@ -0,0 +1,148 @@
+#include "gtest/gtest.h"
+
+#include "kmer_index/compressed_paths.hpp"
+
+
+using namespace gram;
+
+
+TEST(CompressPaths, GivenTwoKmersWithPaths_CorrectPathElementRanges) {
+    sdsl::int_vector<> paths = {5, 1, 7, 2, 9, 1, 5, 3};
+    std::vector<uint64_t> kmer_paths_offsets = {0, 6, 8};
+    auto compressed_paths = compress_paths(paths, kmer_paths_offsets);
+
+    std::vector<std::pair<uint64_t, uint64_t>> result = {
+            kmer_path_elements_range(0, compressed_paths),
+            kmer_path_elements_range(1, compressed_paths),
+    };
+    std::vector<std::pair<uint64_t, uint64_t>> expected = {
+            {0, 3},
+            {3, 4},
+    };
+    EXPECT_EQ(result, expected);
+}
+
+
+TEST(CompressPaths, GivenKmersWithoutPaths_EmptyDecompressedPaths) {
+    sdsl::int_vector<> paths = {5, 1};
+    std::vector<uint64_t> kmer_paths_offsets = {0, 0, 2, 2};
+    auto compressed_paths = compress_paths(paths, kmer_paths_offsets);
+
+    std::vector<std::vector<VariantSite>> result = {
+            decompress_kmer_paths(0, compressed_paths),
+            decompress_kmer_paths(1, compressed_paths),
+            decompress_kmer_paths(2, compressed_paths),
+    };
+    std::vector<std::vector<VariantSite>> expected = {
+            {},
+            {{5, 1}},
+            {},
+    };
+    EXPECT_EQ(result, expected);
+}
+
+
+TEST(CompressPaths, GivenDecreasingMarkers_CorrectDecompressedPaths) {
+    sdsl::int_vector<> paths = {11, 2, 5, 1, 9, 4, 9, 3};
+    std::vector<uint64_t> kmer_paths_offsets = {0, 8};
+    auto compressed_paths = compress_paths(paths, kmer_paths_offsets);
+
+    auto result = decompress_kmer_paths(0, compressed_paths);
+    std::vector<VariantSite> expected = {{11, 2}, {5, 1}, {9, 4}, {9, 3}};
+    EXPECT_EQ(result, expected);
+}
+
+
+TEST(CompressPaths, GivenRandomAccessToLastKmer_NeighbourPathsNotReturned) {
+    sdsl::int_vector<> paths = {5, 1, 7, 1, 7, 2, 9, 2};
+    std::vector<uint64_t> kmer_paths_offsets = {0, 2, 4, 8};
+    auto compressed_paths = compress_paths(paths, kmer_paths_offsets);
+
+    auto result = decompress_kmer_paths(2, compressed_paths);
+    std::vector<VariantSite> expected = {{7, 2}, {9, 2}};
+    EXPECT_EQ(result, expected);
+}
+
+
+TEST(CompressPaths, GivenSmallAlleleIds_AlleleIdsBitCompressed) {
+    sdsl::int_vector<> paths = {5, 1, 7, 3, 1001, 2};
+    std::vector<uint64_t> kmer_paths_offsets = {0, 6};
+    auto compressed_paths = compress_paths(paths, kmer_paths_offsets);
+
+    auto result = compressed_paths.allele_ids.width();
+    uint8_t expected = 2;
+    EXPECT_EQ(result, expected);
+}
+
+
+TEST(CompressPaths, GivenStoredCompressedPaths_LoadedPathsMatch) {
+    sdsl::int_vector<> paths = {5, 1, 7, 2, 9, 1, 5, 3};
+    std::vector<uint64_t> kmer_paths_offsets = {0, 4, 8};
+    auto compressed_paths = compress_paths(paths, kmer_paths_offsets);
+    sdsl::store_to_file(compressed_paths, "@compressed_paths");
+
+    CompressedPaths loaded_paths;
+    sdsl::load_from_file(loaded_paths, "@compressed_paths");
+
+    std::vector<std::vector<VariantSite>> result = {
+            decompress_kmer_paths(0, loaded_paths),
+            decompress_kmer_paths(1, loaded_paths),
+    };
+    std::vector<std::vector<VariantSite>> expected = {
+            {{5, 1}, {7, 2}},
+            {{9, 1}, {5, 3}},
+    };
+    EXPECT_EQ(result, expected);
+}
+
+
+TEST(CompressPaths, GivenKmersWithIdenticalPaths_PathListStoredOnce) {
+    sdsl::int_vector<> paths = {5, 1, 7, 2, 9, 1, 5, 1, 7, 2};
+    std::vector<uint64_t> kmer_paths_offsets = {0, 4, 6, 10};
+    auto compressed_paths = compress_paths(paths, kmer_paths_offsets);
+
+    std::vector<uint64_t> result = {
+            count_distinct_path_lists(compressed_paths),
+            compressed_paths.marker_deltas.size(),
+    };
+    std::vector<uint64_t> expected = {2, 3};
+    EXPECT_EQ(result, expected);
+}
+
+
+TEST(CompressPaths, GivenKmersWithIdenticalPaths_SharedPathElementRange) {
+    sdsl::int_vector<> paths = {5, 1, 7, 2, 9, 1, 5, 1, 7, 2};
+    std::vector<uint64_t> kmer_paths_offsets = {0, 4, 6, 10};
+    auto compressed_paths = compress_paths(paths, kmer_paths_offsets);
+
+    std::vector<std::pair<uint64_t, uint64_t>> result = {
+            kmer_path_elements_range(0, compressed_paths),
+            kmer_path_elements_range(1, compressed_paths),
+            kmer_path_elements_range(2, compressed_paths),
+    };
+    std::vector<std::pair<uint64_t, uint64_t>> expected = {
+            {0, 2},
+            {2, 3},
+            {0, 2},
+    };
+    EXPECT_EQ(result, expected);
+}
+
+
+TEST(CompressPaths, GivenSamePathElementsSplitDifferently_DistinctPathLists) {
+    sdsl::int_vector<> paths = {5, 1, 7, 2, 5, 1, 7, 2};
+    std::vector<uint64_t> kmer_paths_offsets = {0, 4, 6, 8};
+    auto compressed_paths = compress_paths(paths, kmer_paths_offsets);
+
+    std::vector<std::vector<VariantSite>> result = {
+            decompress_kmer_paths(0, compressed_paths),
+            decompress_kmer_paths(1, compressed_paths),
+            decompress_kmer_paths(2, compressed_paths),
+    };
+    std::vector<std::vector<VariantSite>> expected = {
+            {{5, 1}, {7, 2}},
+            {{5, 1}},
+            {{7, 2}},
+    };
+    EXPECT_EQ(result, expected);
+}
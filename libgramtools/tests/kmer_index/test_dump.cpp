@@ -5,6 +5,7 @@
 #include "../test_utils.hpp"
 #include "kmer_index/build.hpp"
 #include "kmer_index/dump.hpp"
+#include "kmer_index/load.hpp"
 
 
 using namespace gram;
@@ -16,11 +17,12 @@ TEST(DumpKmers, GivenTwoKmers_CorrectAllKmersStructure) {
     parameters.kmers_fpath = "@kmers_fpath";
 
     KmerIndex kmer_index = {
-            {{1, 2, 3, 4}, SearchStates {}},
-            {{2, 4, 3, 4}, SearchStates {}},
+            {pack_kmer({1, 2, 3, 4}), SearchStates {}},
+            {pack_kmer({2, 4, 3, 4}), SearchStates {}},
     };
 
-    sdsl::int_vector<3> all_kmers = dump_kmers(kmer_index, parameters);
+    auto serialized = serialize_kmer_index(kmer_index, parameters);
+    const auto &all_kmers = serialized.kmers;
     bool result = all_kmers == sdsl::int_vector<3> {1, 2, 3, 4, 2, 4, 3, 4}
                   or all_kmers == sdsl::int_vector<3> {2, 4, 3, 4, 1, 2, 3, 4};
     EXPECT_TRUE(result);
@@ -31,10 +33,12 @@ TEST(DumpSaIntervals, GivenTwoSearchStates_CorrectSaIntervals) {
     Parameters parameters = {};
     parameters.kmers_size = 4;
     parameters.kmers_fpath = "@kmers_fpath";
+    parameters.kmers_stats_fpath = "@kmers_stats_fpath";
     parameters.sa_intervals_fpath = "@sa_intervals_fpath";
+    parameters.paths_fpath = "@paths_fpath";
 
     KmerIndex kmer_index = {
-            {{1, 2, 3, 4},
+            {pack_kmer({1, 2, 3, 4}),
                     SearchStates {
                             SearchState {
                                     SA_Interval {6, 6},
@@ -54,9 +58,7 @@ TEST(DumpSaIntervals, GivenTwoSearchStates_CorrectSaIntervals) {
             }
     };
 
-    sdsl::int_vector<3> all_kmers = dump_kmers(kmer_index, parameters);
-    auto stats = calculate_stats(kmer_index);
-    dump_sa_intervals(stats, all_kmers, kmer_index, parameters);
+    kmer_index::dump(kmer_index, parameters);
 
     sdsl::int_vector<> result;
     sdsl::load_from_file(result, parameters.sa_intervals_fpath);
@@ -71,10 +73,12 @@ TEST(DumpPaths, GivenTwoPathsWithMultipleElements_CorrectSerializedPaths) {
     Parameters parameters = {};
     parameters.kmers_size = 4;
     parameters.kmers_fpath = "@kmers_fpath";
+    parameters.kmers_stats_fpath = "@kmers_stats_fpath";
+    parameters.sa_intervals_fpath = "@sa_intervals_fpath";
     parameters.paths_fpath = "@paths_fpath";
 
     KmerIndex kmer_index = {
-            {{1, 2, 3, 4},
+            {pack_kmer({1, 2, 3, 4}),
                     SearchStates {
                             SearchState {
                                     SA_Interval {6, 6},
@@ -95,15 +99,13 @@ TEST(DumpPaths, GivenTwoPathsWithMultipleElements_CorrectSerializedPaths) {
             }
     };
 
-    sdsl::int_vector<3> all_kmers = dump_kmers(kmer_index, parameters);
-    auto stats = calculate_stats(kmer_index);
-    dump_paths(stats, all_kmers, kmer_index, parameters);
+    kmer_index::dump(kmer_index, parameters);
 
-    sdsl::int_vector<> result;
-    sdsl::load_from_file(result, parameters.paths_fpath);
+    CompressedPaths paths;
+    sdsl::load_from_file(paths, parameters.paths_fpath);
 
-    sdsl::int_vector<> expected = {5, 1, 5, 2, 7, 3};
-    sdsl::util::bit_compress(expected);
+    auto result = decompress_kmer_paths(0, paths);
+    std::vector<VariantSite> expected = {{5, 1}, {5, 2}, {7, 3}};
     EXPECT_EQ(result, expected);
 }
 
@@ -111,12 +113,14 @@ TEST(DumpPaths, GivenTwoPathsWithMultipleElements_CorrectSerializedPaths) {
 TEST(DumpKmerEntryStats, GivenTwoKmersMultipleSearchStates_CorrectKmerEntryStats) {
     Parameters parameters = {};
     parameters.kmers_size = 4;
-    parameters.kmers_stats_fpath = "@kmers_stats_fpath";
     parameters.kmers_fpath = "@kmers_fpath";
+    parameters.kmers_stats_fpath = "@kmers_stats_fpath";
+    parameters.sa_intervals_fpath = "@sa_intervals_fpath";
+    parameters.paths_fpath = "@paths_fpath";
 
     Pattern kmer = {1, 2, 3, 4};
     KmerIndex kmer_index = {
-            {{1, 2, 3, 4},
+            {pack_kmer({1, 2, 3, 4}),
                     SearchStates {
                             SearchState {
                                     SA_Interval {6, 6},
@@ -141,7 +145,7 @@ TEST(DumpKmerEntryStats, GivenTwoKmersMultipleSearchStates_CorrectKmerEntryStats
                             }
                     }
             },
-            {{2, 4, 3, 4},
+            {pack_kmer({2, 4, 3, 4}),
                     SearchStates {
                             SearchState {
                                     SA_Interval {9, 10},
@@ -160,9 +164,7 @@ TEST(DumpKmerEntryStats, GivenTwoKmersMultipleSearchStates_CorrectKmerEntryStats
             }
     };
 
-    sdsl::int_vector<3> all_kmers = dump_kmers(kmer_index, parameters);
-    auto stats = calculate_stats(kmer_index);
-    dump_kmers_stats(stats, all_kmers, kmer_index, parameters);
+    kmer_index::dump(kmer_index, parameters);
 
     sdsl::int_vector<> stats_kmer_entry;
     sdsl::load_from_file(stats_kmer_entry, parameters.kmers_stats_fpath);
@@ -176,3 +178,34 @@ TEST(DumpKmerEntryStats, GivenTwoKmersMultipleSearchStates_CorrectKmerEntryStats
     bool result = stats_kmer_entry == expected_1 or stats_kmer_entry == expected_2;
     EXPECT_TRUE(result);
 }
+
+
+TEST(DumpKmerIndex, GivenManyKmersSpanningSerializationBlocks_LoadedKmerIndexMatches) {
+    Parameters parameters = {};
+    parameters.kmers_size = 5;
+    parameters.kmers_fpath = "@kmers_fpath";
+    parameters.kmers_stats_fpath = "@kmers_stats_fpath";
+    parameters.sa_intervals_fpath = "@sa_intervals_fpath";
+    parameters.paths_fpath = "@paths_fpath";
+
+    KmerIndex kmer_index = {};
+    for (uint64_t i = 0; i < 300; ++i) {
+        Pattern kmer = {};
+        for (uint64_t j = 0, value = i; j < parameters.kmers_size; ++j, value /= 4)
+            kmer.push_back((Base) (value % 4 + 1));
+
+        SearchStates search_states = {};
+        for (uint64_t j = 0; j < i % 3; ++j) {
+            SearchState search_state = {};
+            search_state.sa_interval = SA_Interval {i, i + j};
+            for (uint64_t k = 0; k < (i + j) % 4; ++k)
+                search_state.variant_site_path.emplace_back(VariantSite {5 + 2 * k, j + 1});
+            search_states.emplace_back(search_state);
+        }
+        kmer_index[pack_kmer(kmer)] = search_states;
+    }
+
+    kmer_index::dump(kmer_index, parameters);
+    auto result = kmer_index::load(parameters);
+    EXPECT_EQ(result, kmer_index);
+}
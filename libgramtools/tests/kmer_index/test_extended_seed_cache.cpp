@@ -0,0 +1,149 @@
+#include "gtest/gtest.h"
+
+#include "common/utils.hpp"
+#include "kmer_index/extended_seed_cache.hpp"
+
+
+using namespace gram;
+
+
+ExtendedSeed make_extended_seed() {
+    ExtendedSeed extended_seed = {};
+    SearchState search_state = {};
+    search_state.sa_interval = SA_Interval {3, 4};
+    search_state.variant_site_path = VariantSitePath {VariantSite {5, 2}};
+    search_state.variant_site_state = SearchVariantSiteState::outside_variant_site;
+    extended_seed.search_states = SearchStates {search_state};
+    extended_seed.marker_crossings = 1;
+    extended_seed.max_count_search_states = 2;
+    return extended_seed;
+}
+
+
+void warm_extended_seed(ExtendedSeedCache &seed_cache, const Pattern &read, const uint64_t &kmer_size,
+                        const ExtendedSeed &extended_seed) {
+    ExtendedSeed found_seed = {};
+    for (uint64_t i = 0; i < ExtendedSeedCache::hot_kmer_min_count_lookups; ++i)
+        seed_cache.lookup(read, kmer_size, found_seed);
+    for (uint64_t i = 0; i < ExtendedSeedCache::seed_min_count_lookups; ++i)
+        seed_cache.record(read, kmer_size, ExtendedSeedCache::extension_step, extended_seed);
+}
+
+
+TEST(ExtendedSeedCache, ZeroSize_KmerNeverHot) {
+    ExtendedSeedCache seed_cache(0);
+    auto read = encode_dna_bases("acgtacgt");
+    ExtendedSeed extended_seed = {};
+    for (uint64_t i = 0; i < ExtendedSeedCache::hot_kmer_min_count_lookups; ++i) {
+        auto seed_lookup = seed_cache.lookup(read, 3, extended_seed);
+        EXPECT_FALSE(seed_lookup.kmer_hot);
+    }
+}
+
+
+TEST(ExtendedSeedCache, KmerLookedUpOften_KmerHotWithoutSeed) {
+    ExtendedSeedCache seed_cache(64);
+    auto read = encode_dna_bases("acgtacgt");
+    ExtendedSeed extended_seed = {};
+    ExtendedSeedLookup seed_lookup = {};
+    for (uint64_t i = 0; i < ExtendedSeedCache::hot_kmer_min_count_lookups; ++i)
+        seed_lookup = seed_cache.lookup(read, 3, extended_seed);
+    EXPECT_TRUE(seed_lookup.kmer_hot);
+    EXPECT_EQ(seed_lookup.count_extension_bases, 0);
+}
+
+
+TEST(ExtendedSeedCache, FrequentSuffix_SeedFound) {
+    ExtendedSeedCache seed_cache(64);
+    auto read = encode_dna_bases("ggacgtacgt");
+    auto extended_seed = make_extended_seed();
+    warm_extended_seed(seed_cache, read, 3, extended_seed);
+
+    ExtendedSeed result = {};
+    auto seed_lookup = seed_cache.lookup(read, 3, result);
+    EXPECT_EQ(seed_lookup.count_extension_bases, ExtendedSeedCache::extension_step);
+    EXPECT_EQ(result.search_states, extended_seed.search_states);
+    EXPECT_EQ(result.marker_crossings, extended_seed.marker_crossings);
+    EXPECT_EQ(seed_cache.count_seeds(), 1);
+}
+
+
+TEST(ExtendedSeedCache, ReadWithOtherSuffix_SeedNotFound) {
+    ExtendedSeedCache seed_cache(64);
+    warm_extended_seed(seed_cache, encode_dna_bases("ggacgtacgt"), 3, make_extended_seed());
+
+    ExtendedSeed result = {};
+    auto seed_lookup = seed_cache.lookup(encode_dna_bases("ggaggtacgt"), 3, result);
+    EXPECT_TRUE(seed_lookup.kmer_hot);
+    EXPECT_EQ(seed_lookup.count_extension_bases, 0);
+}
+
+
+TEST(ExtendedSeedCache, SerializedAndDeserialized_SeedFoundWithoutWarming) {
+    ExtendedSeedCache seed_cache(64);
+    auto read = encode_dna_bases("ggacgtacgt");
+    auto extended_seed = make_extended_seed();
+    warm_extended_seed(seed_cache, read, 3, extended_seed);
+    auto serialized = seed_cache.serialize(3, 100, 7);
+
+    ExtendedSeedCache loaded_seed_cache(64);
+    loaded_seed_cache.deserialize(serialized, 3, 100, 7);
+    ExtendedSeed result = {};
+    auto seed_lookup = loaded_seed_cache.lookup(read, 3, result);
+    EXPECT_EQ(seed_lookup.count_extension_bases, ExtendedSeedCache::extension_step);
+    EXPECT_EQ(result.search_states, extended_seed.search_states);
+    EXPECT_EQ(result.max_count_search_states, extended_seed.max_count_search_states);
+}
+
+
+TEST(ExtendedSeedCache, DeserializedForOtherPrg_NoSeeds) {
+    ExtendedSeedCache seed_cache(64);
+    warm_extended_seed(seed_cache, encode_dna_bases("ggacgtacgt"), 3, make_extended_seed());
+    auto serialized = seed_cache.serialize(3, 100, 7);
+
+    ExtendedSeedCache loaded_seed_cache(64);
+    loaded_seed_cache.deserialize(serialized, 3, 101, 7);
+    EXPECT_EQ(loaded_seed_cache.count_seeds(), 0);
+}
+
+
+TEST(ExtendedSeedCache, DeserializedForOtherPrgOfSameSize_NoSeeds) {
+    ExtendedSeedCache seed_cache(64);
+    warm_extended_seed(seed_cache, encode_dna_bases("ggacgtacgt"), 3, make_extended_seed());
+    auto serialized = seed_cache.serialize(3, 100, 7);
+
+    ExtendedSeedCache loaded_seed_cache(64);
+    loaded_seed_cache.deserialize(serialized, 3, 100, 8);
+    EXPECT_EQ(loaded_seed_cache.count_seeds(), 0);
+}
+
+
+TEST(ExtendedSeedCache, TruncatedRecord_SeedsBeforeKept) {
+    ExtendedSeedCache seed_cache(64);
+    warm_extended_seed(seed_cache, encode_dna_bases("ggacgtacgt"), 3, make_extended_seed());
+    auto serialized = seed_cache.serialize(3, 100, 7);
+
+    // a complete record followed by the first half of a copy of it
+    const uint64_t header_size = 3;
+    const uint64_t record_size = serialized.size() - header_size;
+    sdsl::int_vector<> truncated(serialized.size() + record_size / 2, 0, serialized.width());
+    for (uint64_t i = 0; i < serialized.size(); ++i)
+        truncated[i] = serialized[i];
+    for (uint64_t i = 0; i < record_size / 2; ++i)
+        truncated[serialized.size() + i] = serialized[header_size + i];
+
+    ExtendedSeedCache loaded_seed_cache(64);
+    loaded_seed_cache.deserialize(truncated, 3, 100, 7);
+    EXPECT_EQ(loaded_seed_cache.count_seeds(), 1);
+}
+
+
+TEST(ExtendedSeedCache, TruncatedHeader_NoSeeds) {
+    sdsl::int_vector<> truncated(2, 0, 64);
+    truncated[0] = 3;
+    truncated[1] = 100;
+
+    ExtendedSeedCache loaded_seed_cache(64);
+    loaded_seed_cache.deserialize(truncated, 3, 100, 7);
+    EXPECT_EQ(loaded_seed_cache.count_seeds(), 0);
+}
@@ -50,26 +50,36 @@ TEST(DeserializeNextStats, GivenTwoSearchStateWithMultiplePaths_CorrectlyIndexed
 }
 
 
-TEST(ParseSaIntervals, GivenOneKmerThreeSaIntervals_CorrectSearchStates) {
-    KmerIndex kmer_index = {};
+TEST(CalculateOffsets, GivenTwoKmersWithMultiplePaths_CorrectOffsets) {
+    sdsl::int_vector<> kmers_stats = {2, 1, 2, 3, 0, 1, 4, 1, 0};
+    uint64_t count_kmers = 3;
+    auto result = calculate_offsets(count_kmers, kmers_stats);
+    std::vector<IndexedKmerOffsets> expected = {
+            {0, 0},
+            {3, 4},
+            {7, 10},
+    };
+    EXPECT_EQ(result, expected);
+}
+
+
+TEST(ParseKmerIndex, GivenOneKmerThreeSaIntervals_CorrectSearchStates) {
     sdsl::int_vector<3> all_kmers = {1, 2, 3, 4};
     sdsl::int_vector<> kmers_stats = {3, 0, 0, 0};
+    sdsl::int_vector<> sa_intervals = {42, 43, 52, 53, 62, 63};
+    sdsl::util::bit_compress(sa_intervals);
+    auto paths = compress_paths(sdsl::int_vector<> {}, {0, 0});
 
     Parameters parameters = {};
-    parameters.sa_intervals_fpath = "@sa_intervals_fpath";
     parameters.kmers_size = 4;
 
-    sdsl::int_vector<> sa_intervals = {42, 43, 52, 53, 62, 63};
-    sdsl::util::bit_compress(sa_intervals);
-    sdsl::store_to_file(sa_intervals, parameters.sa_intervals_fpath);
-
-    parse_sa_intervals(kmer_index,
-                       all_kmers,
-                       kmers_stats,
-                       parameters);
-    const auto &result = kmer_index;
+    auto result = parse_kmer_index(all_kmers,
+                                   kmers_stats,
+                                   sa_intervals,
+                                   paths,
+                                   parameters);
     KmerIndex expected = {
-            {{1, 2, 3, 4},
+            {pack_kmer({1, 2, 3, 4}),
                     SearchStates {
                             SearchState {
                                     SA_Interval {42, 43},
@@ -87,27 +97,23 @@ TEST(ParseSaIntervals, GivenOneKmerThreeSaIntervals_CorrectSearchStates) {
 }
 
 
-TEST(ParsePaths, GivenTwoPathsDifferentLengths_CorrectKmerIndex) {
-    KmerIndex kmer_index = {};
+TEST(ParseKmerIndex, GivenTwoPathsDifferentLengths_CorrectKmerIndex) {
     sdsl::int_vector<3> all_kmers = {1, 2, 3, 4};
     sdsl::int_vector<> kmers_stats = {2, 1, 2};
+    sdsl::int_vector<> sa_intervals = {0, 0, 0, 0};
+    auto paths = compress_paths(sdsl::int_vector<> {42, 43, 52, 53, 62, 63}, {0, 6});
 
     Parameters parameters = {};
-    parameters.paths_fpath = "@paths_fpath";
     parameters.kmers_size = 4;
 
-    sdsl::int_vector<> paths = {42, 43, 52, 53, 62, 63};
-    sdsl::util::bit_compress(paths);
-    sdsl::store_to_file(paths, parameters.paths_fpath);
-
-    parse_paths(kmer_index,
-                all_kmers,
-                kmers_stats,
-                parameters);
-    const auto &result = kmer_index;
+    auto result = parse_kmer_index(all_kmers,
+                                   kmers_stats,
+                                   sa_intervals,
+                                   paths,
+                                   parameters);
 
     KmerIndex expected = {
-            {{1, 2, 3, 4},
+            {pack_kmer({1, 2, 3, 4}),
                     SearchStates {
                             SearchState {
                                     SA_Interval {},
@@ -148,14 +154,13 @@ TEST(ParseKmerIndex, GivenSingleKmerWithTwoSearchStates_CorrectKmerIndex) {
     sdsl::store_to_file(sa_intervals, parameters.sa_intervals_fpath);
 
     parameters.paths_fpath = "@paths_fpath";
-    sdsl::int_vector<> paths = {42, 43, 52, 53, 62, 63};
-    sdsl::util::bit_compress(paths);
+    auto paths = compress_paths(sdsl::int_vector<> {42, 43, 52, 53, 62, 63}, {0, 6});
     sdsl::store_to_file(paths, parameters.paths_fpath);
 
     auto result = kmer_index::load(parameters);
 
     KmerIndex expected = {
-            {{1, 2, 3, 4},
+            {pack_kmer({1, 2, 3, 4}),
                     SearchStates {
                             SearchState {
                                     SA_Interval {1, 1},
@@ -196,14 +201,13 @@ TEST(ParseKmerIndex, GivenTwoKmersWithMultipleSearchStates_CorrectKmerIndex) {
     sdsl::store_to_file(sa_intervals, parameters.sa_intervals_fpath);
 
     parameters.paths_fpath = "@paths_fpath";
-    sdsl::int_vector<> paths = {42, 43, 42, 43, 52, 53, 62, 63};
-    sdsl::util::bit_compress(paths);
+    auto paths = compress_paths(sdsl::int_vector<> {42, 43, 42, 43, 52, 53, 62, 63}, {0, 2, 8});
     sdsl::store_to_file(paths, parameters.paths_fpath);
 
     auto result = kmer_index::load(parameters);
 
     KmerIndex expected = {
-            {{2, 2, 2, 2},
+            {pack_kmer({2, 2, 2, 2}),
                     SearchStates {
                             SearchState {
                                     SA_Interval {1, 1},
@@ -213,7 +217,7 @@ TEST(ParseKmerIndex, GivenTwoKmersWithMultipleSearchStates_CorrectKmerIndex) {
                             }
                     }
             },
-            {{4, 4, 4, 4},
+            {pack_kmer({4, 4, 4, 4}),
                     SearchStates {
                             SearchState {
                                     SA_Interval {1, 1},
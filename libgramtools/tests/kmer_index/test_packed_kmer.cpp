@@ -0,0 +1,69 @@
+#include "gtest/gtest.h"
+
+#include "kmer_index/kmer_index_types.hpp"
+
+
+using namespace gram;
+
+
+TEST(PackKmer, GivenKmer_BasesPackedTwoBitsEachFirstBaseMostSignificant) {
+    Pattern kmer = {1, 2, 3, 4};
+    auto result = pack_kmer(kmer);
+    PackedKmer expected = 0b00011011;
+    EXPECT_EQ(result, expected);
+}
+
+
+TEST(PackKmer, GivenRuntimeKmerSize_SameResultAsCompileTimeKmerSize) {
+    Pattern kmer = {4, 3, 1, 2, 2, 4, 1, 3, 3};
+    auto result = pack_kmer(kmer.data(), (uint32_t) kmer.size());
+    auto expected = pack_kmer<9>(kmer.data());
+    EXPECT_EQ(result, expected);
+}
+
+
+TEST(PackKmer, GivenMaximumSizeKmerOfTs_AllBitsSet) {
+    Pattern kmer(max_packed_kmer_size, 4);
+    auto result = pack_kmer(kmer);
+    PackedKmer expected = ~(PackedKmer) 0;
+    EXPECT_EQ(result, expected);
+}
+
+
+TEST(PackKmer, GivenEveryPackableKmerSize_SameResultAsLoop) {
+    Pattern bases = {4, 3, 1, 2, 2, 4, 1, 3, 3, 1, 2, 4, 4, 3, 1, 2,
+                     3, 1, 4, 4, 2, 1, 3, 2, 4, 1, 1, 3, 2, 4, 3, 2};
+    for (uint32_t kmer_size = 1; kmer_size <= max_packed_kmer_size; ++kmer_size) {
+        auto result = pack_kmer(bases.data(), kmer_size);
+        PackedKmer expected = 0;
+        for (uint32_t i = 0; i < kmer_size; ++i)
+            expected = (expected << 2) | (bases[i] - 1);
+        EXPECT_EQ(result, expected) << "kmer size " << kmer_size;
+    }
+}
+
+
+TEST(PackReadKmer, GivenRead_LastKmerSizeBasesPacked) {
+    Pattern read = {4, 4, 1, 2, 3, 4};
+    auto result = pack_read_kmer(read, 4);
+    auto expected = pack_kmer(Pattern{1, 2, 3, 4});
+    EXPECT_EQ(result, expected);
+}
+
+
+TEST(UnpackKmer, GivenPackedKmer_OriginalKmerReturned) {
+    Pattern kmer = {1, 1, 4, 2, 3, 1};
+    auto result = unpack_kmer(pack_kmer(kmer), (uint32_t) kmer.size());
+    EXPECT_EQ(result, kmer);
+}
+
+
+TEST(KmerIndex, GivenPackedKmerKey_LookupFromReadFindsKmer) {
+    KmerIndex kmer_index;
+    kmer_index[pack_kmer(Pattern{2, 3, 3})] = SearchStates{SearchState{SA_Interval{1, 2}}};
+
+    Pattern read = {1, 4, 2, 3, 3};
+    auto result = kmer_index.at(pack_read_kmer(read, 3)).front().sa_interval;
+    SA_Interval expected = {1, 2};
+    EXPECT_EQ(result, expected);
+}
@@ -0,0 +1,61 @@
+#include "gtest/gtest.h"
+
+#include "../test_utils.hpp"
+#include "prg/prg.hpp"
+#include "prg/invariant_reach.hpp"
+
+
+using namespace gram;
+
+
+uint64_t prg_index_reach(const InvariantReach &invariant_reach,
+                         const PRG_Info &prg_info,
+                         const uint64_t &prg_index) {
+    for (uint64_t sa_index = 0; sa_index < prg_info.fm_index.size(); ++sa_index) {
+        if (prg_info.fm_index[sa_index] == prg_index)
+            return invariant_reach.sa_reach[sa_index];
+    }
+    return 0;
+}
+
+
+TEST(GenerateInvariantReach, GivenSingleSite_NonVariantKmersReachLeftBases) {
+    auto prg_info = generate_prg_info("acgt5g6c5tgca");
+    auto invariant_reach = generate_invariant_reach(prg_info.fm_index, prg_info.encoded_prg,
+                                                    prg_info.sites_mask, 2);
+
+    std::vector<uint64_t> result;
+    for (uint64_t prg_index = 0; prg_index < prg_info.encoded_prg.size(); ++prg_index)
+        result.push_back(prg_index_reach(invariant_reach, prg_info, prg_index));
+    std::vector<uint64_t> expected = {1, 2, 3, 0, 0, 0, 0, 0, 0, 1, 2, 3, 0};
+    EXPECT_EQ(result, expected);
+}
+
+
+TEST(GenerateInvariantReach, SentinelSuffix_NoReach) {
+    auto prg_info = generate_prg_info("acgt5g6c5tgca");
+    auto invariant_reach = generate_invariant_reach(prg_info.fm_index, prg_info.encoded_prg,
+                                                    prg_info.sites_mask, 2);
+    EXPECT_EQ(invariant_reach.sa_reach[0], (uint64_t) 0);
+}
+
+
+TEST(SaIntervalInvariant, GivenCountLeftBases_TrueOnlyWithinReach) {
+    auto prg_info = generate_prg_info("acgt5g6c5tgca");
+    auto invariant_reach = generate_invariant_reach(prg_info.fm_index, prg_info.encoded_prg,
+                                                    prg_info.sites_mask, 2);
+    InvariantReachRMQ invariant_reach_rmq(&invariant_reach.sa_reach);
+
+    // suffixes starting with 'c' include "c5tgca", within an allele
+    SA_Interval c_sa_interval = {prg_info.fm_index.C[prg_info.fm_index.char2comp[2]],
+                                 prg_info.fm_index.C[prg_info.fm_index.char2comp[3]] - 1};
+    EXPECT_FALSE(sa_interval_invariant(invariant_reach, invariant_reach_rmq, c_sa_interval, 0));
+
+    for (uint64_t sa_index = 0; sa_index < prg_info.fm_index.size(); ++sa_index) {
+        if (prg_info.fm_index[sa_index] != 2)
+            continue;
+        SA_Interval sa_interval = {sa_index, sa_index};
+        EXPECT_TRUE(sa_interval_invariant(invariant_reach, invariant_reach_rmq, sa_interval, 2));
+        EXPECT_FALSE(sa_interval_invariant(invariant_reach, invariant_reach_rmq, sa_interval, 3));
+    }
+}
@@ -0,0 +1,56 @@
+#include "gtest/gtest.h"
+
+#include "../test_utils.hpp"
+#include "prg/prg.hpp"
+#include "prg/kmer_presence.hpp"
+
+
+using namespace gram;
+
+
+TEST(GenerateKmerPresence, GivenSingleSite_KmersThroughEachAllelePresent) {
+    auto encoded_prg = encode_prg("ac5g6t5ca");
+    auto kmer_presence = generate_kmer_presence(encoded_prg, 3);
+
+    for (const auto &kmer: {"acg", "cgc", "gca", "act", "ctc", "tca"})
+        EXPECT_TRUE(sampled_kmers_present(kmer_presence, encode_dna_bases(kmer))) << kmer;
+}
+
+
+TEST(GenerateKmerPresence, GivenSingleSite_KmersAcrossAllelesAbsent) {
+    auto encoded_prg = encode_prg("ac5g6t5ca");
+    auto kmer_presence = generate_kmer_presence(encoded_prg, 3);
+
+    for (const auto &kmer: {"cgt", "gtc", "acc", "acgt", "aca"})
+        EXPECT_FALSE(sampled_kmers_present(kmer_presence, encode_dna_bases(kmer))) << kmer;
+}
+
+
+TEST(GenerateKmerPresence, GivenTwoSites_KmersAcrossBothSitesPresent) {
+    auto encoded_prg = encode_prg("a5g6t5c7a8c7g");
+    auto kmer_presence = generate_kmer_presence(encoded_prg, 3);
+
+    for (const auto &kmer: {"agc", "atc", "gca", "tcc", "cag", "ccg"})
+        EXPECT_TRUE(sampled_kmers_present(kmer_presence, encode_dna_bases(kmer))) << kmer;
+    EXPECT_FALSE(sampled_kmers_present(kmer_presence, encode_dna_bases("gtc")));
+}
+
+
+TEST(SampledKmersPresent, ReadShorterThanKmer_Present) {
+    auto encoded_prg = encode_prg("ac5g6t5ca");
+    auto kmer_presence = generate_kmer_presence(encoded_prg, 3);
+    EXPECT_TRUE(sampled_kmers_present(kmer_presence, encode_dna_bases("tt")));
+}
+
+
+TEST(SampledKmersPresent, NoPresenceGenerated_Present) {
+    KmerPresence kmer_presence = {};
+    EXPECT_TRUE(sampled_kmers_present(kmer_presence, encode_dna_bases("tttttt")));
+}
+
+
+TEST(SampledKmersPresent, ReadAlongPath_Present) {
+    auto encoded_prg = encode_prg("ac5g6t5cagt");
+    auto kmer_presence = generate_kmer_presence(encoded_prg, 3);
+    EXPECT_TRUE(sampled_kmers_present(kmer_presence, encode_dna_bases("actcagt")));
+}
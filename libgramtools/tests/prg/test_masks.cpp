@@ -106,4 +106,30 @@ TEST(GenerateAlleleMask, DoubleDigitMarker_CorrectAlleleMask) {
     };
     for (auto i = 0; i < result.size(); ++i)
         EXPECT_EQ(result[i], expected[i]);
-}
\ No newline at end of file
+}
+
+TEST(GenerateBwtMarkers, GivenSingleVariantSite_MarkerIndexesAndSymbolsInBwtOrder) {
+    auto prg_raw = "gcgct5c6g6a5agtcct";
+    auto prg_info = generate_prg_info(prg_raw);
+    auto bwt_markers = generate_bwt_markers(prg_info.fm_index, prg_info.bwt_markers_mask);
+
+    std::vector<std::vector<uint64_t>> result = {
+            std::vector<uint64_t>(bwt_markers.indexes.begin(), bwt_markers.indexes.end()),
+            std::vector<uint64_t>(bwt_markers.symbols.begin(), bwt_markers.symbols.end()),
+    };
+    std::vector<std::vector<uint64_t>> expected = {
+            {1, 2, 7, 11},
+            {5, 6, 5, 6},
+    };
+    EXPECT_EQ(result, expected);
+}
+
+
+TEST(GenerateBwtMarkersMask, FromBwtMarkers_SameMaskAsBwtScan) {
+    auto prg_raw = "gcgct5c6g6a5agtcct";
+    auto prg_info = generate_prg_info(prg_raw);
+    auto bwt_markers = generate_bwt_markers(prg_info.fm_index, prg_info.bwt_markers_mask);
+
+    auto result = generate_bwt_markers_mask(bwt_markers, prg_info.fm_index.bwt.size());
+    EXPECT_EQ(result, prg_info.bwt_markers_mask);
+}
@@ -34,6 +34,20 @@ TEST(GetMaxAlphabetNum, SingleCharPrg_CorrectBaseEncodingAsMaxAlphabet) {
 }
 
 
+TEST(EncodedPrgChecksum, SameSizePrgsDifferingInOneBase_ChecksumsDiffer) {
+    auto lhs = encode_prg("a5g6t5cc");
+    auto rhs = encode_prg("a5g6t5ca");
+    EXPECT_NE(encoded_prg_checksum(lhs), encoded_prg_checksum(rhs));
+}
+
+
+TEST(EncodedPrgChecksum, SamePrg_SameChecksum) {
+    auto lhs = encode_prg("a5g6t5cc");
+    auto rhs = encode_prg("a5g6t5cc");
+    EXPECT_EQ(encoded_prg_checksum(lhs), encoded_prg_checksum(rhs));
+}
+
+
 TEST(GenerateSitesMask, GivenMultiSitePrg_CorrectSitesMask) {
     auto prg_raw = "a5g6t5cc11g12tt11";
     auto prg_info = generate_prg_info(prg_raw);
@@ -0,0 +1,61 @@
+#include "gtest/gtest.h"
+
+#include "../test_utils.hpp"
+#include "prg/sa_allele_runs.hpp"
+
+
+using namespace gram;
+
+
+/*
+PRG: aa5t6cagtagcagt5ta
+i	SA	suffix start
+0	18	sentinel
+1	17	outside
+2	0	outside
+3	9	site 5 allele 2
+4	6	site 5 allele 2
+5	12	site 5 allele 2
+6	1	outside
+7	5	site 5 allele 2
+8	11	site 5 allele 2
+9	10	site 5 allele 2
+10	7	site 5 allele 2
+11	13	site 5 allele 2
+12	16	outside
+13	8	site 5 allele 2
+14	14	site 5 allele 2
+15	3	site 5 allele 1
+16	15	marker
+17	2	marker
+18	4	marker
+*/
+
+TEST(GenerateSaAlleleRuns, GivenSingleSite_CorrectRunStarts) {
+    auto prg_raw = "aa5t6cagtagcagt5ta";
+    auto prg_info = generate_prg_info(prg_raw);
+    const auto &run_starts_mask = prg_info.sa_allele_runs.run_starts_mask;
+
+    std::vector<uint64_t> result;
+    for (uint64_t i = 0; i < run_starts_mask.size(); ++i) {
+        if (run_starts_mask[i])
+            result.push_back(i);
+    }
+    std::vector<uint64_t> expected = {0, 3, 6, 7, 12, 13, 15, 16};
+    EXPECT_EQ(result, expected);
+}
+
+
+TEST(GenerateSaAlleleRuns, GivenSingleSite_CorrectRunAlleles) {
+    auto prg_raw = "aa5t6cagtagcagt5ta";
+    auto prg_info = generate_prg_info(prg_raw);
+    const auto &sa_allele_runs = prg_info.sa_allele_runs;
+
+    std::vector<VariantSite> result;
+    for (uint64_t i = 0; i < count_runs(sa_allele_runs); ++i)
+        result.emplace_back(VariantSite{sa_allele_runs.site_markers[i], sa_allele_runs.allele_ids[i]});
+    std::vector<VariantSite> expected = {
+            {0, 0}, {5, 2}, {0, 0}, {5, 2}, {0, 0}, {5, 2}, {5, 1}, {0, 0}
+    };
+    EXPECT_EQ(result, expected);
+}
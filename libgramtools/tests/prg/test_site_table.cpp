@@ -0,0 +1,77 @@
+#include "gtest/gtest.h"
+
+#include "../test_utils.hpp"
+#include "prg/site_table.hpp"
+
+
+using namespace gram;
+
+
+TEST(GenerateSiteTable, GivenTwoSites_CorrectSitePrgIndexes) {
+    //              0  3 5  8   12
+    auto prg_raw = "ac5t6g5c7a8cc7";
+    auto prg_info = generate_prg_info(prg_raw);
+
+    std::vector<std::pair<uint64_t, uint64_t>> result = {
+            site_prg_indexes(5, prg_info.site_table),
+            site_prg_indexes(7, prg_info.site_table),
+    };
+    std::vector<std::pair<uint64_t, uint64_t>> expected = {
+            {2, 6},
+            {8, 13},
+    };
+    EXPECT_EQ(result, expected);
+}
+
+
+TEST(GenerateSiteTable, GivenMultiCharAlleles_CorrectAlleleStartsAndLengths) {
+    auto prg_raw = "ac5t6g5c7a8cc7";
+    auto prg_info = generate_prg_info(prg_raw);
+    const auto &site_table = prg_info.site_table;
+
+    std::vector<std::pair<uint64_t, uint64_t>> result = {
+            {allele_start_prg_index({5, 1}, site_table), allele_length({5, 1}, site_table)},
+            {allele_start_prg_index({5, 2}, site_table), allele_length({5, 2}, site_table)},
+            {allele_start_prg_index({7, 1}, site_table), allele_length({7, 1}, site_table)},
+            {allele_start_prg_index({7, 2}, site_table), allele_length({7, 2}, site_table)},
+    };
+    std::vector<std::pair<uint64_t, uint64_t>> expected = {
+            {3,  1},
+            {5,  1},
+            {9,  1},
+            {11, 2},
+    };
+    EXPECT_EQ(result, expected);
+}
+
+
+TEST(GenerateSiteTable, GivenSite_BoundaryMarkerSaIndexesLocateToBoundaryPrgIndexes) {
+    auto prg_raw = "gcgct5c6g6a5agtcct";
+    auto prg_info = generate_prg_info(prg_raw);
+    const auto &site_table = prg_info.site_table;
+
+    std::vector<uint64_t> result = {
+            prg_info.fm_index[site_table.start_sa_indexes[0]],
+            prg_info.fm_index[site_table.end_sa_indexes[0]],
+    };
+    std::vector<uint64_t> expected = {5, 11};
+    EXPECT_EQ(result, expected);
+}
+
+
+TEST(LoadSiteTable, GivenStoredSiteTable_LoadedSiteTableMatches) {
+    auto prg_raw = "ac5t6g5c7a8cc7";
+    auto prg_info = generate_prg_info(prg_raw);
+    Parameters parameters = {};
+    parameters.site_table_fpath = "@site_table";
+    sdsl::store_to_file(prg_info.site_table, parameters.site_table_fpath);
+
+    auto site_table = load_site_table(parameters);
+    std::vector<uint64_t> result = {
+            count_sites(site_table),
+            site_prg_indexes(7, site_table).first,
+            allele_length({7, 2}, site_table),
+    };
+    std::vector<uint64_t> expected = {2, 8, 2};
+    EXPECT_EQ(result, expected);
+}
@@ -0,0 +1,108 @@
+#include "gtest/gtest.h"
+
+#include "../test_utils.hpp"
+#include "prg/prg.hpp"
+#include "prg/strand_symmetric.hpp"
+#include "kmer_index/build.hpp"
+#include "kmer_index/kmers.hpp"
+#include "search/search.hpp"
+
+
+using namespace gram;
+
+
+TEST(CountVariantSites, GivenTwoSites_CountTwo) {
+    auto encoded_prg = encode_prg("a5g6t5c7a8c7g");
+    auto result = count_variant_sites(encoded_prg);
+    EXPECT_EQ(result, (uint64_t) 2);
+}
+
+
+TEST(CountVariantSites, GivenNoSites_CountZero) {
+    auto encoded_prg = encode_prg("acgt");
+    auto result = count_variant_sites(encoded_prg);
+    EXPECT_EQ(result, (uint64_t) 0);
+}
+
+
+TEST(StrandSeparator, GivenTwoSites_AlleleMarkerOfFirstUnusedSite) {
+    EXPECT_EQ(strand_separator(2), (uint64_t) 14);
+    EXPECT_EQ(strand_separator(0), (uint64_t) 0);
+}
+
+
+TEST(GenerateStrandSymmetricPrg, GivenSingleSite_ReverseComplementAppendedWithOffsetMarkers) {
+    auto encoded_prg = encode_prg("ac5g6t5ca");
+    auto result = generate_strand_symmetric_prg(encoded_prg);
+    auto expected = encode_prg("ac5g6t5ca10tg7c8a7gt");
+    EXPECT_EQ(result, expected);
+}
+
+
+TEST(GenerateStrandSymmetricPrg, GivenAdjacentSitesAndMultiBaseAlleles_AlleleOrderKept) {
+    auto encoded_prg = encode_prg("5ac6g5t7a8cg7c");
+    auto result = generate_strand_symmetric_prg(encoded_prg);
+    auto expected = encode_prg("5ac6g5t7a8cg7c14g11t12cg11a9gt10c9");
+    EXPECT_EQ(result, expected);
+}
+
+
+TEST(IndexIsStrandSymmetric, IndexOverBothStrands_True) {
+    EXPECT_TRUE(index_is_strand_symmetric(20, 9));
+    EXPECT_FALSE(index_is_strand_symmetric(19, 9));
+    EXPECT_FALSE(index_is_strand_symmetric(10, 9));
+}
+
+
+TEST(StrandSymmetricPrgInfo, GivenSingleSite_SeparatorNeitherSiteNorMarker) {
+    auto prg_info = generate_strand_symmetric_prg_info("ac5g6t5ca");
+
+    EXPECT_EQ(count_sites(prg_info.site_table), (uint64_t) 2);
+    EXPECT_EQ(prg_info.markers_mask_count_set_bits, (uint64_t) 6);
+    EXPECT_EQ(prg_info.prg_markers_rank(prg_info.prg_markers_mask.size()), (uint64_t) 6);
+}
+
+
+TEST(StrandSymmetricSearch, ReadSpansStrandsJunction_NoSearchStates) {
+    // ac5g6t5ca 10 tg7c8a7gt: "ca" ends the first strand, "tg" starts the second
+    auto prg_info = generate_strand_symmetric_prg_info("ac5g6t5ca");
+    auto kmer = encode_dna_bases("tg");
+    Patterns kmers = {kmer};
+    auto kmer_index = index_kmers(kmers, 2, prg_info);
+
+    auto read = encode_dna_bases("catg");
+    auto result = search_read_backwards(read, kmer, kmer_index, prg_info);
+    EXPECT_TRUE(result.empty());
+}
+
+
+TEST(StrandSymmetricSearch, ReadWithinReverseStrand_ReverseSiteInPath) {
+    auto prg_info = generate_strand_symmetric_prg_info("ac5g6t5ca");
+    auto kmer = encode_dna_bases("gt");
+    Patterns kmers = {kmer};
+    auto kmer_index = index_kmers(kmers, 2, prg_info);
+
+    auto read = encode_dna_bases("tgagt");
+    auto result = search_read_backwards(read, kmer, kmer_index, prg_info);
+    ASSERT_EQ(result.size(), (uint64_t) 1);
+    VariantSitePath expected = {VariantSite{7, 2}};
+    EXPECT_EQ(result.front().variant_site_path, expected);
+}
+
+
+TEST(GetAllReverseKmers, StrandSymmetricPrg_NoKmerSpansStrandsJunction) {
+    auto prg_info = generate_strand_symmetric_prg_info("ac5g6t5ca");
+    Parameters parameters = {};
+    parameters.kmers_size = 3;
+    parameters.max_read_size = 10;
+
+    auto result = get_prg_reverse_kmers(parameters, prg_info);
+    ASSERT_FALSE(result.empty());
+    for (const auto &reverse_kmer: result) {
+        for (const auto &base: reverse_kmer)
+            EXPECT_TRUE(base >= 1 and base <= 4);
+    }
+    // "cat" and "atg" only occur across the junction
+    EXPECT_EQ(result.count(Pattern{4, 1, 2}), (uint64_t) 0);
+    EXPECT_EQ(result.count(Pattern{3, 4, 1}), (uint64_t) 0);
+}
@@ -219,6 +219,139 @@ TEST(AlleleBaseCoverage, SaIntervalGreaterThanOne_CorrectCumulativeBaseCoverage)
 }
 
 
+TEST(AlleleBaseCoverage, DeferredDeltasTwoReads_CorrectCumulativeBaseCoverage) {
+    auto prg_raw = "ac5gg6aga5c";
+    auto prg_info = generate_prg_info(prg_raw);
+    auto coverage = coverage::generate::empty_structure(prg_info);
+    coverage::generate::allele_base_deltas(coverage, 1);
+
+    uint64_t read_length = 4;
+    SearchState search_state = {
+            SA_Interval{7, 8},
+            VariantSitePath{
+                    VariantSite{5, 1},
+            },
+    };
+    SearchStates search_states = {search_state};
+    coverage::record::allele_base(coverage, search_states, read_length, prg_info);
+    coverage::record::allele_base(coverage, search_states, read_length, prg_info);
+    coverage::generate::allele_base_from_deltas(coverage);
+
+    auto &result = coverage.allele_base_coverage;
+    SitesAlleleBaseCoverage expected = {
+            {{2, 2}, {0, 0, 0}}
+    };
+    EXPECT_EQ(result, expected);
+}
+
+
+TEST(AlleleBaseCoverage, BufferedDeltasFlushedBeforeRecording_CorrectCumulativeBaseCoverage) {
+    auto prg_raw = "ac5gg6aga5c";
+    auto prg_info = generate_prg_info(prg_raw);
+    auto coverage = coverage::generate::empty_structure(prg_info);
+    coverage::generate::allele_base_deltas(coverage, 1);
+
+    uint64_t read_length = 4;
+    SearchState search_state = {
+            SA_Interval{7, 8},
+            VariantSitePath{
+                    VariantSite{5, 1},
+            },
+    };
+    SearchStates search_states = {search_state};
+    coverage::record::allele_base(coverage, search_states, read_length, prg_info);
+    flush_base_deltas(coverage.allele_base_deltas, coverage.allele_base_delta_buffers[0]);
+    coverage::record::allele_base(coverage, search_states, read_length, prg_info);
+    coverage::generate::allele_base_from_deltas(coverage);
+
+    auto &result = coverage.allele_base_coverage;
+    SitesAlleleBaseCoverage expected = {
+            {{2, 2}, {0, 0, 0}}
+    };
+    EXPECT_EQ(result, expected);
+}
+
+
+TEST(FlushBaseDeltas, RepeatedDeltaIndexes_DeltasSummedAndBufferCleared) {
+    SitesAlleleBaseDeltas allele_base_deltas = {
+            {{0, 0, 0}, {0, 0, 0, 0}}
+    };
+    BaseDeltasBuffer buffer = {{4, 1}, {1, -1}, {4, 1}, {0, 1}, {1, -1}, {6, -1}};
+    flush_base_deltas(allele_base_deltas, buffer);
+
+    SitesAlleleBaseDeltas expected = {
+            {{1, -2, 0}, {0, 2, 0, -1}}
+    };
+    EXPECT_EQ(allele_base_deltas, expected);
+    EXPECT_TRUE(buffer.empty());
+}
+
+
+TEST(AlleleBaseCoverage, DeferredDeltasPastMaxCount_AlleleCountsPromoted) {
+    auto prg_raw = "ac5gg6aga5c";
+    auto prg_info = generate_prg_info(prg_raw);
+    auto coverage = coverage::generate::empty_structure(prg_info);
+    coverage::generate::allele_base_deltas(coverage, 2);
+    auto allele_coverage = coverage.allele_base_coverage[0][1];
+    allele_coverage[0] = max_base_count - 1;
+    allele_coverage[1] = 7;
+
+    uint64_t read_length = 3;
+    SearchState search_state = {
+            SA_Interval{2, 2},
+            VariantSitePath{
+                    VariantSite{5, 2},
+            },
+    };
+    SearchStates search_states = {search_state};
+    coverage::record::allele_base(coverage, search_states, read_length, prg_info);
+    coverage::record::allele_base(coverage, search_states, read_length, prg_info);
+    coverage::generate::allele_base_from_deltas(coverage);
+
+    auto &result = coverage.allele_base_coverage;
+    SitesAlleleBaseCoverage expected = {
+            {{0, 0}, {(WideBaseCount) max_base_count + 1, 9, 2}}
+    };
+    EXPECT_EQ(result, expected);
+}
+
+
+TEST(AlleleBaseCoverage, ReadsRecordedPast16BitCount_NoCountLost) {
+    auto prg_raw = "ac5gg6aga5c";
+    auto prg_info = generate_prg_info(prg_raw);
+    auto coverage = coverage::generate::empty_structure(prg_info);
+
+    uint64_t read_length = 3;
+    SearchState search_state = {
+            SA_Interval{2, 2},
+            VariantSitePath{
+                    VariantSite{5, 2},
+            },
+    };
+    SearchStates search_states = {search_state};
+    const uint64_t count_reads = 70000;
+    for (uint64_t i = 0; i < count_reads; ++i)
+        coverage::record::allele_base(coverage, search_states, read_length, prg_info);
+
+    auto &result = coverage.allele_base_coverage;
+    SitesAlleleBaseCoverage expected = {
+            {{0, 0}, {count_reads, count_reads, count_reads}}
+    };
+    EXPECT_EQ(result, expected);
+}
+
+
+TEST(AlleleBaseCoverage, PromotedAlleleCounts_WideCountsDumped) {
+    SitesAlleleBaseCoverage allele_base_coverage = {
+            {{0, 70000}, {1, 2, 3}},
+            {{65535}}
+    };
+    auto result = dump_allele_base_coverage(allele_base_coverage);
+    std::string expected = "{\"allele_base_counts\":[[[0,70000],[1,2,3]],[[65535]]]}";
+    EXPECT_EQ(result, expected);
+}
+
+
 TEST(AlleleBaseCoverage, ReadStartsBeforeSiteCoversFirstAllele_CorrectBaseCoverage) {
     auto prg_raw = "ac5gg6aga5c";
     auto prg_info = generate_prg_info(prg_raw);
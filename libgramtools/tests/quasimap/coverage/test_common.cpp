@@ -2,6 +2,7 @@
 #include "gtest/gtest.h"
 
 #include "../../test_utils.hpp"
+#include "common/random.hpp"
 #include "quasimap/coverage/common.hpp"
 
 
@@ -139,7 +140,7 @@ TEST(RrandomIntInclusive, RandomCall_MinBoundaryReturned) {
 
 
 TEST(RrandomIntInclusive, RandomCall_MaxBoundaryReturned) {
-    uint64_t random_seed = 56;
+    uint64_t random_seed = 23;
     uint64_t result = random_int_inclusive(1, 10, random_seed);
     uint64_t expected = 10;
     EXPECT_EQ(result, expected);
@@ -306,4 +307,113 @@ TEST(FilterForPathSites, TwoSearchStatesDifferentPaths_CorrectEmptySearchStates)
     auto result = filter_for_path_sites(target_path, search_states);
     SearchStates expected = {};
     EXPECT_EQ(result, expected);
-}
\ No newline at end of file
+}
+
+TEST(SelectSearchStates, TwoSearchStatesSamePathSites_BothSelected) {
+    auto prg_raw = "gct5c6g6t5ac7cc8a7";
+    auto prg_info = generate_prg_info(prg_raw);
+    SearchStates search_states = {
+            SearchState {
+                    SA_Interval {1, 1},
+                    VariantSitePath {
+                            VariantSite {5, 1},
+                            VariantSite {7, 2},
+                    }
+            },
+            SearchState {
+                    SA_Interval {2, 2},
+                    VariantSitePath {
+                            VariantSite {5, 3},
+                            VariantSite {7, 1},
+                    }
+            }
+    };
+    RecordScratch scratch;
+    uint64_t read_length = 1;
+    uint32_t random_seed = 42;
+    select_search_states(scratch, search_states, read_length, prg_info, random_seed);
+
+    const auto &result = scratch.selected_search_states;
+    ASSERT_EQ(result.size(), (uint64_t) 2);
+    EXPECT_EQ(result[0].search_state, &search_states.front());
+    EXPECT_EQ(result[1].search_state, &search_states.back());
+    EXPECT_EQ(result[1].sa_interval, (SA_Interval {2, 2}));
+}
+
+
+TEST(SelectSearchStates, ScratchReusedAcrossReads_OnlyLatestReadSelected) {
+    auto prg_raw = "gct5c6g6t5ac7cc8a7";
+    auto prg_info = generate_prg_info(prg_raw);
+    SearchStates first_search_states = {
+            SearchState {
+                    SA_Interval {1, 1},
+                    VariantSitePath {
+                            VariantSite {5, 1},
+                    }
+            }
+    };
+    SearchStates second_search_states = {
+            SearchState {
+                    SA_Interval {2, 2},
+                    VariantSitePath {
+                            VariantSite {7, 2},
+                    }
+            }
+    };
+    RecordScratch scratch;
+    uint64_t read_length = 1;
+    uint32_t random_seed = 42;
+    select_search_states(scratch, first_search_states, read_length, prg_info, random_seed);
+    select_search_states(scratch, second_search_states, read_length, prg_info, random_seed);
+
+    const auto &result = scratch.selected_search_states;
+    ASSERT_EQ(result.size(), (uint64_t) 1);
+    EXPECT_EQ(result[0].search_state, &second_search_states.front());
+}
+
+
+TEST(ReadRandomSeed, GivenRunSeedAndReadIndex_MatchesRunSeedStreamOutput) {
+    uint64_t run_seed = 7;
+    SplitMix64 generator(run_seed);
+    generator();
+    generator();
+    auto expected = generator();
+
+    uint64_t read_index = 2;
+    auto result = read_random_seed(run_seed, read_index);
+    EXPECT_EQ(result, expected);
+}
+
+
+TEST(UniformIntInclusive, ManyDraws_AllWithinBounds) {
+    SplitMix64 generator(42);
+    for (int i = 0; i < 1000; ++i) {
+        auto result = uniform_int_inclusive(generator, 3, 5);
+        EXPECT_TRUE(result >= 3 and result <= 5);
+    }
+}
+
+
+TEST(FoldStrandSymmetric, ReverseComplementSiteCoverage_AddedToForwardSite) {
+    auto prg_info = generate_prg_info("c5ga6t5cg7tc8a7g");
+    auto coverage = coverage::generate::empty_structure(prg_info);
+    coverage.allele_sum_coverage[0][0] = 2;
+    coverage.allele_sum_coverage[1][0] = 3;
+    coverage.allele_sum_coverage[1][1] = 1;
+    coverage.allele_base_coverage[0][0][0] = 1;
+    coverage.allele_base_coverage[0][0][1] = 2;
+    coverage.allele_base_coverage[1][0][0] = 3;
+    coverage.grouped_allele_counts[0] = {{0, 2}};
+    coverage.grouped_allele_counts[1] = {{0, 3}, {1, 1}};
+
+    coverage::generate::fold_strand_symmetric(coverage, 1);
+
+    AlleleSumCoverage expected_allele_sum = {{5, 1}};
+    EXPECT_EQ(coverage.allele_sum_coverage, expected_allele_sum);
+    SitesAlleleBaseCoverage expected_allele_base = {{{1, 5}, {0}}};
+    EXPECT_EQ(coverage.allele_base_coverage, expected_allele_base);
+    ASSERT_EQ(coverage.grouped_allele_counts.size(), (uint64_t) 1);
+    ASSERT_EQ(coverage.grouped_allele_counts[0].size(), (uint64_t) 2);
+    EXPECT_EQ(coverage.grouped_allele_counts[0].at(0), (uint64_t) 5);
+    EXPECT_EQ(coverage.grouped_allele_counts[0].at(1), (uint64_t) 1);
+}
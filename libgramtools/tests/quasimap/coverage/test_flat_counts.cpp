@@ -0,0 +1,54 @@
+#include "gtest/gtest.h"
+
+#include "quasimap/coverage/flat_counts.hpp"
+
+
+using namespace gram;
+
+
+TEST(FlatCounts, GivenRowSizes_ContiguousZeroedRows) {
+    auto flat_counts = FlatCounts<uint64_t>::with_row_sizes({2, 0, 3});
+
+    std::vector<uint64_t> result = {
+            flat_counts.size(),
+            flat_counts[0].size(),
+            flat_counts[1].size(),
+            flat_counts[2].size(),
+            flat_counts.all_counts().size(),
+    };
+    std::vector<uint64_t> expected = {3, 2, 0, 3, 5};
+    EXPECT_EQ(result, expected);
+}
+
+
+TEST(FlatCounts, GivenRowIncrement_OnlyRowElementChanged) {
+    auto flat_counts = FlatCounts<uint64_t>::with_row_sizes({2, 3});
+    flat_counts[1][0] += 1;
+
+    auto result = flat_counts;
+    FlatCounts<uint64_t> expected = {{0, 0}, {1, 0, 0}};
+    EXPECT_EQ(result, expected);
+}
+
+
+TEST(FlatNestedCounts, GivenInitializerList_CorrectSiteRows) {
+    FlatNestedCounts<uint16_t> flat_counts = {
+            {{1, 2}, {3}},
+            {},
+            {{4, 5, 6}},
+    };
+
+    std::vector<std::vector<uint16_t>> result;
+    for (const auto &site: flat_counts)
+        for (const auto &row: site)
+            result.emplace_back(row.begin(), row.end());
+    std::vector<std::vector<uint16_t>> expected = {{1, 2}, {3}, {4, 5, 6}};
+    EXPECT_EQ(result, expected);
+}
+
+
+TEST(FlatNestedCounts, GivenSitesWithSameRowsSplitDifferently_NotEqual) {
+    FlatNestedCounts<uint16_t> flat_counts = {{{1}, {2}}, {{3}}};
+    FlatNestedCounts<uint16_t> other_flat_counts = {{{1}}, {{2}, {3}}};
+    EXPECT_FALSE(flat_counts == other_flat_counts);
+}
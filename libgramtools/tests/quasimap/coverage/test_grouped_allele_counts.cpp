@@ -42,7 +42,7 @@ TEST(GroupedAlleleCount, GivenTwoSearchStates_CorrectCoverage) {
             },
     };
     coverage::record::grouped_allele_counts(coverage, search_states);
-    auto result = coverage.grouped_allele_counts;
+    auto result = get_grouped_allele_counts(coverage);
     SitesGroupedAlleleCounts expected = {
             GroupedAlleleCounts {{AlleleIds {0, 1}, 1}},
             GroupedAlleleCounts {{AlleleIds {0}, 1}},
@@ -73,7 +73,7 @@ TEST(GroupedAlleleCount, GivenUnorderedSearchStates_CorrectlyOrderedCoverageAlle
             },
     };
     coverage::record::grouped_allele_counts(coverage, search_states);
-    auto result = coverage.grouped_allele_counts;
+    auto result = get_grouped_allele_counts(coverage);
     SitesGroupedAlleleCounts expected = {
             GroupedAlleleCounts {{AlleleIds {0, 2}, 1}},
             GroupedAlleleCounts {{AlleleIds {0, 1}, 1}},
@@ -96,7 +96,7 @@ TEST(GroupedAlleleCount, GivenSingleSearchState_CorrectCoverage) {
             }
     };
     coverage::record::grouped_allele_counts(coverage, search_states);
-    auto result = coverage.grouped_allele_counts;
+    auto result = get_grouped_allele_counts(coverage);
     SitesGroupedAlleleCounts expected = {
             GroupedAlleleCounts {{AlleleIds {2}, 1}},
             GroupedAlleleCounts {},
@@ -147,7 +147,7 @@ TEST(GroupedAlleleCount, MultipleSetsOfSearchStates_CorrectCoverage) {
     coverage::record::grouped_allele_counts(coverage,
                                             second_search_states);
 
-    auto result = coverage.grouped_allele_counts;
+    auto result = get_grouped_allele_counts(coverage);
     SitesGroupedAlleleCounts expected = {
             GroupedAlleleCounts {
                     {AlleleIds {0, 2}, 1},
@@ -202,6 +202,118 @@ TEST(GroupedAlleleCount, GivenSitesGroupedAlleleCounts_CorrectlyAssignHashValues
 }
 
 
+TEST(GroupedAlleleCount, GivenSmallAlleleIds_AlleleGroupHeldInBitset) {
+    AlleleGroup allele_group;
+    insert_allele_id(allele_group, 3);
+    insert_allele_id(allele_group, 0);
+    insert_allele_id(allele_group, 3);
+
+    auto result = get_allele_ids(allele_group);
+    AlleleIds expected = {0, 3};
+    EXPECT_EQ(result, expected);
+    EXPECT_TRUE(allele_group.spilled_ids.empty());
+}
+
+
+TEST(GroupedAlleleCount, GivenLargeAlleleId_AlleleGroupSpillsToSortedIds) {
+    AlleleGroup allele_group;
+    insert_allele_id(allele_group, 70);
+    insert_allele_id(allele_group, 2);
+    insert_allele_id(allele_group, 70);
+
+    auto result = get_allele_ids(allele_group);
+    AlleleIds expected = {2, 70};
+    EXPECT_EQ(result, expected);
+    EXPECT_EQ(allele_group.bitset, (uint64_t) 0);
+}
+
+
+TEST(GroupedAlleleCount, GivenSameAlleleGroupAtTwoSites_SingleInternedGroupId) {
+    auto prg_raw = "gct5c6g6t5ac7cc8a7";
+    auto prg_info = generate_prg_info(prg_raw);
+    auto coverage = coverage::generate::empty_structure(prg_info);
+
+    SearchStates search_states = {
+            SearchState {
+                    SA_Interval {1, 2},
+                    VariantSitePath {
+                            VariantSite {5, 1},
+                            VariantSite {7, 1}
+                    }
+            }
+    };
+    coverage::record::grouped_allele_counts(coverage, search_states);
+    coverage::record::grouped_allele_counts(coverage, search_states);
+
+    auto result = coverage.allele_groups.groups.size();
+    uint64_t expected = 1;
+    EXPECT_EQ(result, expected);
+    EXPECT_EQ(coverage.grouped_allele_counts[0].at(0), (uint64_t) 2);
+    EXPECT_EQ(coverage.grouped_allele_counts[1].at(0), (uint64_t) 2);
+}
+
+
+TEST(GroupedAlleleCount, GivenRecordedCoverage_CorrectInternedJsonString) {
+    auto prg_raw = "gct5c6g6t5ac7cc8a7";
+    auto prg_info = generate_prg_info(prg_raw);
+    auto coverage = coverage::generate::empty_structure(prg_info);
+
+    SearchStates search_states = {
+            SearchState {
+                    SA_Interval {1, 2},
+                    VariantSitePath {
+                            VariantSite {5, 1},
+                            VariantSite {5, 2},
+                            VariantSite {7, 1}
+                    }
+            }
+    };
+    coverage::record::grouped_allele_counts(coverage, search_states);
+
+    auto result = dump_grouped_allele_counts(coverage);
+    std::string expected = R"({"grouped_allele_counts":{"site_counts":[{"1":1},{"0":1}],"allele_groups":{"0":[0],"1":[0,1]}}})";
+    EXPECT_EQ(result, expected);
+}
+
+
+TEST(GroupedAlleleCount, GroupsInternedOutOfOrder_CanonicalIdsInAlleleIdsOrder) {
+    AlleleGroupTable allele_groups;
+    intern_allele_group(allele_groups, AlleleGroup {0b100});
+    intern_allele_group(allele_groups, AlleleGroup {0b11});
+    intern_allele_group(allele_groups, AlleleGroup {0b1});
+
+    auto result = canonical_group_ids(allele_groups);
+    std::vector<AlleleGroupId> expected = {2, 1, 0};
+    EXPECT_EQ(result, expected);
+}
+
+
+TEST(GroupedAlleleCount, ReadsRecordedInEitherOrder_SameGroupIds) {
+    auto prg_raw = "gct5c6g6t5ac7cc8a7";
+    auto prg_info = generate_prg_info(prg_raw);
+
+    SearchStates first_read = {
+            SearchState {SA_Interval {1, 2}, VariantSitePath {VariantSite {5, 3}, VariantSite {7, 2}}}
+    };
+    SearchStates second_read = {
+            SearchState {SA_Interval {1, 2}, VariantSitePath {VariantSite {5, 1}, VariantSite {7, 1}}}
+    };
+
+    auto coverage = coverage::generate::empty_structure(prg_info);
+    coverage::record::grouped_allele_counts(coverage, first_read);
+    coverage::record::grouped_allele_counts(coverage, second_read);
+
+    auto reverse_order_coverage = coverage::generate::empty_structure(prg_info);
+    coverage::record::grouped_allele_counts(reverse_order_coverage, second_read);
+    coverage::record::grouped_allele_counts(reverse_order_coverage, first_read);
+
+    auto result = dump_grouped_allele_counts(coverage);
+    std::string expected = R"({"grouped_allele_counts":{"site_counts":[{"0":1,"2":1},{"0":1,"1":1}],"allele_groups":{"0":[0],"1":[1],"2":[2]}}})";
+    EXPECT_EQ(result, expected);
+    EXPECT_EQ(dump_grouped_allele_counts(reverse_order_coverage), expected);
+}
+
+
 /*
 TEST(GroupedAlleleCount, GivenSingleSite_CorrectJsonString) {
     GroupedAlleleCounts site = {
@@ -0,0 +1,148 @@
+#include <chrono>
+#include <iostream>
+#include "gtest/gtest.h"
+
+#include "../../test_utils.hpp"
+#include "common/random.hpp"
+#include "kmer_index/build.hpp"
+#include "search/search.hpp"
+#include "quasimap/coverage/allele_sum.hpp"
+#include "quasimap/coverage/allele_base.hpp"
+#include "quasimap/coverage/grouped_allele_counts.hpp"
+#include "quasimap/coverage/common.hpp"
+
+
+using namespace gram;
+
+
+/*
+Timing of per read coverage recording, disabled by default. Run with:
+    test_main --gtest_also_run_disabled_tests --gtest_filter='RecordBenchmark.*'
+
+Copying selection is how reads were selected before RecordScratch: a set of path site
+vectors, a filtered copy of the search states and a copied search state for a randomly
+chosen single mapping, with each record function given fresh buffers for every read.
+*/
+
+
+static std::string synthetic_prg(const uint64_t &count_sites) {
+    std::string prg_raw;
+    for (uint64_t i = 0; i < count_sites; ++i) {
+        auto site_marker = std::to_string(5 + 2 * i);
+        auto allele_marker = std::to_string(6 + 2 * i);
+        prg_raw += "acgtac" + site_marker
+                   + "ggt" + allele_marker
+                   + "gct" + allele_marker
+                   + "gat" + site_marker;
+    }
+    prg_raw += "acgtac";
+    return prg_raw;
+}
+
+
+// each read maps once after every site, through a different path
+static std::vector<SearchStates> synthetic_reads_search_states(const std::vector<std::string> &reads,
+                                                              const uint32_t &kmer_size,
+                                                              const PRG_Info &prg_info) {
+    std::vector<SearchStates> reads_search_states;
+    for (const auto &read_raw: reads) {
+        auto read = encode_dna_bases(read_raw);
+        Pattern kmer(read.end() - kmer_size, read.end());
+        auto kmer_index = index_kmers(Patterns {kmer}, kmer_size, prg_info);
+        reads_search_states.emplace_back(search_read_backwards(read, kmer, kmer_index, prg_info));
+    }
+    return reads_search_states;
+}
+
+
+static SearchStates copying_selection(const SearchStates &search_states,
+                                      const uint64_t &read_length,
+                                      const PRG_Info &prg_info,
+                                      const uint64_t &random_seed) {
+    SplitMix64 generator(random_seed);
+    uint64_t nonvariant_count = count_nonvariant_search_states(search_states);
+    auto path_sites = get_unique_path_sites(search_states);
+
+    uint64_t count_total_options = nonvariant_count + path_sites.size();
+    if (count_total_options == 0)
+        return SearchStates {};
+    uint64_t selected_option = uniform_int_inclusive(generator, 1, count_total_options);
+
+    bool selected_no_path = selected_option <= nonvariant_count;
+    if (selected_no_path)
+        return SearchStates {};
+
+    uint64_t paths_sites_offset = selected_option - nonvariant_count - 1;
+    auto it = path_sites.begin();
+    std::advance(it, paths_sites_offset);
+    auto selected_search_states = filter_for_path_sites(*it, search_states);
+    if (selected_search_states.size() > 1)
+        return selected_search_states;
+
+    auto &selected = selected_search_states.front();
+    if (multiple_allele_encapsulated(selected, read_length, prg_info)) {
+        auto sa_index = (SA_Index) uniform_int_inclusive(generator,
+                                                         selected.sa_interval.first,
+                                                         selected.sa_interval.second);
+        selected.sa_interval = SA_Interval {sa_index, sa_index};
+    }
+    return selected_search_states;
+}
+
+
+static void copying_record(Coverage &coverage,
+                           const SearchStates &search_states,
+                           const uint64_t &read_length,
+                           const PRG_Info &prg_info,
+                           const uint64_t &random_seed) {
+    auto selected_search_states = copying_selection(search_states, read_length, prg_info, random_seed);
+    coverage::record::allele_sum(coverage, selected_search_states);
+    coverage::record::grouped_allele_counts(coverage, selected_search_states);
+    coverage::record::allele_base(coverage, selected_search_states, read_length, prg_info);
+}
+
+
+TEST(RecordBenchmark, DISABLED_SyntheticPrgMultimappingReads_ScratchRecordingTimedAgainstCopying) {
+    const uint64_t count_sites = 500;
+    const uint64_t count_recordings = 200000;
+    const uint32_t kmer_size = 5;
+
+    auto prg_info = generate_prg_info(synthetic_prg(count_sites));
+    std::vector<std::string> reads = {
+            "cggtacgtacgct",
+            "tacgatacgtacggt",
+            "gctacgtacgat",
+            "acgtacggtacgtac",
+    };
+    auto reads_search_states = synthetic_reads_search_states(reads, kmer_size, prg_info);
+    for (const auto &search_states: reads_search_states)
+        ASSERT_FALSE(search_states.empty());
+
+    using Clock = std::chrono::steady_clock;
+
+    auto copying_coverage = coverage::generate::empty_structure(prg_info);
+    auto copying_start = Clock::now();
+    for (uint64_t i = 0; i < count_recordings; ++i) {
+        auto read_index = i % reads.size();
+        copying_record(copying_coverage, reads_search_states[read_index],
+                       reads[read_index].size(), prg_info, read_random_seed(42, i));
+    }
+    std::chrono::duration<double> copying_seconds = Clock::now() - copying_start;
+
+    auto scratch_coverage = coverage::generate::empty_structure(prg_info);
+    scratch_coverage.record_scratches = std::vector<RecordScratch>(1);
+    auto scratch_start = Clock::now();
+    for (uint64_t i = 0; i < count_recordings; ++i) {
+        auto read_index = i % reads.size();
+        coverage::record::search_states(scratch_coverage, reads_search_states[read_index],
+                                        reads[read_index].size(), prg_info, read_random_seed(42, i));
+    }
+    std::chrono::duration<double> scratch_seconds = Clock::now() - scratch_start;
+
+    std::cout << "Recorded reads: " << count_recordings << std::endl;
+    std::cout << "Copying selection seconds: " << copying_seconds.count() << std::endl;
+    std::cout << "Scratch recording seconds: " << scratch_seconds.count() << std::endl;
+
+    EXPECT_EQ(scratch_coverage.allele_sum_coverage, copying_coverage.allele_sum_coverage);
+    EXPECT_EQ(scratch_coverage.allele_base_coverage, copying_coverage.allele_base_coverage);
+}
@@ -6,6 +6,7 @@
 #include "kmer_index/build.hpp"
 #include "quasimap/coverage/common.hpp"
 #include "quasimap/quasimap.hpp"
+#include "quasimap/parameters.hpp"
 
 
 using namespace gram;
@@ -224,7 +225,7 @@ TEST(Quasimap, ReadMapsToThreePositions_CorrectAlleleCoverage) {
     auto kmer_index = index_kmers(kmers, parameters.kmers_size, prg_info);
 
     const auto read = encode_dna_bases("tagt");
-    uint32_t random_seed = 42;
+    uint32_t random_seed = 48;
     quasimap_read(read, coverage, kmer_index, prg_info, parameters, random_seed);
 
     const auto &result = coverage.allele_sum_coverage;
@@ -597,7 +598,7 @@ TEST(Quasimap, MappingThreeReadsOneReadMappsTwice_CorrectAlleleCoverage) {
             encode_dna_bases("gcact"),
     };
 
-    uint32_t random_seed = 42;
+    uint32_t random_seed = 48;
     for (const auto &read: reads) {
         quasimap_read(read, coverage, kmer_index,
                       prg_info, parameters, random_seed);
@@ -610,3 +611,87 @@ TEST(Quasimap, MappingThreeReadsOneReadMappsTwice_CorrectAlleleCoverage) {
     };
     EXPECT_EQ(result, expected);
 }
+
+
+TEST(SortReadsBySuffix, GivenReads_OrderedByReversedReadWithoutEmptyReads) {
+    std::vector<Pattern> reads = {
+            encode_dna_bases("tca"),
+            Pattern {},
+            encode_dna_bases("gta"),
+            encode_dna_bases("aac"),
+            encode_dna_bases("ta"),
+    };
+    auto result = sort_reads_by_suffix(reads);
+    std::vector<uint64_t> expected = {0, 4, 2, 3};
+    EXPECT_EQ(result, expected);
+}
+
+
+TEST(CountCommonSuffixBases, GivenReads_CountsSharedTrailingBases) {
+    auto lhs = encode_dna_bases("accgtt");
+    auto rhs = encode_dna_bases("gtt");
+    EXPECT_EQ(count_common_suffix_bases(lhs, rhs), 3);
+    EXPECT_EQ(count_common_suffix_bases(lhs, encode_dna_bases("cctt")), 2);
+}
+
+
+TEST(FindSeededStrands, ForwardKmerIndexed_OnlyForwardStrandSeeded) {
+    auto prg_raw = "gct5c6g6t5ag7t8c7cta";
+    auto prg_info = generate_prg_info(prg_raw);
+    Patterns kmers = {encode_dna_bases("cta")};
+    auto kmer_index = index_kmers(kmers, 3, prg_info);
+
+    auto result = find_seeded_strands(encode_dna_bases("gccta"), 3, kmer_index);
+    EXPECT_TRUE(result.forward);
+    EXPECT_FALSE(result.reverse);
+}
+
+
+TEST(FindSeededStrands, ReverseComplementKmerIndexed_OnlyReverseStrandSeeded) {
+    auto prg_raw = "gct5c6g6t5ag7t8c7cta";
+    auto prg_info = generate_prg_info(prg_raw);
+    Patterns kmers = {encode_dna_bases("cta")};
+    auto kmer_index = index_kmers(kmers, 3, prg_info);
+
+    auto result = find_seeded_strands(encode_dna_bases("taggc"), 3, kmer_index);
+    EXPECT_FALSE(result.forward);
+    EXPECT_TRUE(result.reverse);
+}
+
+
+TEST(FindSeededStrands, ReadShorterThanKmer_NoStrandSeeded) {
+    auto prg_raw = "gct5c6g6t5ag7t8c7cta";
+    auto prg_info = generate_prg_info(prg_raw);
+    Patterns kmers = {encode_dna_bases("cta")};
+    auto kmer_index = index_kmers(kmers, 3, prg_info);
+
+    auto result = find_seeded_strands(encode_dna_bases("ct"), 3, kmer_index);
+    EXPECT_FALSE(result.forward);
+    EXPECT_FALSE(result.reverse);
+}
+
+
+TEST(ConflictingOptions, SortedReadsWithReplicatedIndex_Conflict) {
+    Parameters parameters = {};
+    parameters.sort_reads_batch = true;
+    parameters.numa_mode = "replicate";
+    EXPECT_FALSE(commands::quasimap::conflicting_options(parameters).empty());
+
+    parameters.numa_mode = "interleave";
+    EXPECT_TRUE(commands::quasimap::conflicting_options(parameters).empty());
+}
+
+
+TEST(ConflictingOptions, SortedReadsWithReadCaches_Conflict) {
+    Parameters parameters = {};
+    parameters.sort_reads_batch = true;
+    parameters.numa_mode = "none";
+    EXPECT_TRUE(commands::quasimap::conflicting_options(parameters).empty());
+
+    parameters.read_cache_size = 10;
+    EXPECT_FALSE(commands::quasimap::conflicting_options(parameters).empty());
+
+    parameters.read_cache_size = 0;
+    parameters.max_extended_seeds = 10;
+    EXPECT_FALSE(commands::quasimap::conflicting_options(parameters).empty());
+}
@@ -0,0 +1,67 @@
+#include "gtest/gtest.h"
+
+#include "common/utils.hpp"
+#include "quasimap/read_cache.hpp"
+
+
+using namespace gram;
+
+
+TEST(ReadSearchCache, ZeroSize_CacheDisabledAndNeverHits) {
+    ReadSearchCache read_cache(0);
+    auto read = encode_dna_bases("accgaatt");
+    CachedReadSearch read_search = {};
+    read_search.search_states = SearchStates {SearchState {SA_Interval {1, 2}}};
+    read_cache.insert(read, read_search);
+
+    CachedReadSearch result = {};
+    EXPECT_FALSE(read_cache.enabled());
+    EXPECT_FALSE(read_cache.find(read, result));
+}
+
+
+TEST(ReadSearchCache, InsertedRead_FoundWithSameSearch) {
+    ReadSearchCache read_cache(10);
+    auto read = encode_dna_bases("accgaatt");
+    CachedReadSearch read_search = {};
+    read_search.search_states = SearchStates {SearchState {SA_Interval {1, 2}}};
+    read_search.exceeded_limit = SearchBudgetLimit::sa_interval_width;
+    read_cache.insert(read, read_search);
+
+    CachedReadSearch result = {};
+    EXPECT_TRUE(read_cache.find(read, result));
+    EXPECT_EQ(result.search_states, read_search.search_states);
+    EXPECT_EQ(result.exceeded_limit, read_search.exceeded_limit);
+}
+
+
+TEST(ReadSearchCache, ReadNotInserted_NotFound) {
+    ReadSearchCache read_cache(10);
+    CachedReadSearch read_search = {};
+    read_cache.insert(encode_dna_bases("accgaatt"), read_search);
+
+    CachedReadSearch result = {};
+    EXPECT_FALSE(read_cache.find(encode_dna_bases("accgaatg"), result));
+}
+
+
+TEST(ReadSearchCache, MoreReadsThanSize_OldReadsEvictedLatestKept) {
+    uint64_t max_count_reads = 64;
+    ReadSearchCache read_cache(max_count_reads);
+
+    std::vector<Pattern> reads;
+    for (uint64_t i = 0; i < 4 * max_count_reads; ++i) {
+        Pattern read;
+        for (uint64_t value = i; read.size() < 8; value /= 4)
+            read.push_back(value % 4 + 1);
+        reads.push_back(read);
+        read_cache.insert(read, CachedReadSearch {});
+    }
+
+    uint64_t count_found = 0;
+    CachedReadSearch result = {};
+    for (const auto &read: reads)
+        count_found += read_cache.find(read, result);
+    EXPECT_LE(count_found, max_count_reads);
+    EXPECT_TRUE(read_cache.find(reads.back(), result));
+}
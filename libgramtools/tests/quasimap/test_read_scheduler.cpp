@@ -0,0 +1,87 @@
+#include <thread>
+
+#include "gtest/gtest.h"
+
+#include "common/utils.hpp"
+#include "quasimap/read_scheduler.hpp"
+
+
+using namespace gram;
+
+
+std::shared_ptr<const ReadsBuffer> make_reads_buffer(const uint64_t &count_reads) {
+    return std::make_shared<const ReadsBuffer>(count_reads, encode_dna_bases("acgt"));
+}
+
+
+TEST(ReadsChunkScheduler, BufferPushed_SplitIntoChunksCoveringAllReads) {
+    ReadsChunkScheduler scheduler(1);
+    const uint64_t count_reads = 2 * ReadsChunkScheduler::chunk_size + 1;
+    scheduler.push_buffer(make_reads_buffer(count_reads), 10);
+    EXPECT_EQ(scheduler.count_queued_chunks(), (uint64_t) 3);
+
+    uint64_t next_buffer_index = 0;
+    ReadsChunk chunk = {};
+    while (scheduler.pop(0, chunk)) {
+        EXPECT_EQ(chunk.first_buffer_index, next_buffer_index);
+        EXPECT_EQ(chunk.first_read_index, (uint64_t) 10);
+        next_buffer_index = chunk.last_buffer_index;
+    }
+    EXPECT_EQ(next_buffer_index, count_reads);
+    EXPECT_EQ(scheduler.count_queued_chunks(), (uint64_t) 0);
+}
+
+
+TEST(ReadsChunkScheduler, OwnDequeEmpty_ChunkStolenFromAnotherThread) {
+    ReadsChunkScheduler scheduler(2);
+    // one chunk only: queued on thread 0's deque
+    scheduler.push_buffer(make_reads_buffer(1), 0);
+
+    ReadsChunk chunk = {};
+    EXPECT_TRUE(scheduler.pop(1, chunk));
+    EXPECT_EQ(chunk.last_buffer_index, (uint64_t) 1);
+    EXPECT_FALSE(scheduler.pop(0, chunk));
+}
+
+
+TEST(ReadsChunkScheduler, OwnDequeTakenFromFront_StolenFromBack) {
+    ReadsChunkScheduler scheduler(2);
+    // chunks alternate between deques: thread 0 holds chunks 0 and 2
+    scheduler.push_buffer(make_reads_buffer(4 * ReadsChunkScheduler::chunk_size), 0);
+
+    ReadsChunk chunk = {};
+    ASSERT_TRUE(scheduler.pop(0, chunk));
+    EXPECT_EQ(chunk.first_buffer_index, (uint64_t) 0);
+    ASSERT_TRUE(scheduler.pop(1, chunk));
+    EXPECT_EQ(chunk.first_buffer_index, ReadsChunkScheduler::chunk_size);
+    ASSERT_TRUE(scheduler.pop(1, chunk));
+    EXPECT_EQ(chunk.first_buffer_index, 3 * ReadsChunkScheduler::chunk_size);
+    ASSERT_TRUE(scheduler.pop(1, chunk));
+    EXPECT_EQ(chunk.first_buffer_index, 2 * ReadsChunkScheduler::chunk_size);
+}
+
+
+TEST(ReadsChunkScheduler, Closed_ReportedClosed) {
+    ReadsChunkScheduler scheduler(2);
+    EXPECT_FALSE(scheduler.closed());
+    scheduler.close();
+    EXPECT_TRUE(scheduler.closed());
+}
+
+
+TEST(ReadsChunkScheduler, WaitingThreadBufferPushed_WaitReturnsWithChunkQueued) {
+    ReadsChunkScheduler scheduler(2);
+    std::thread waiter([&] { scheduler.wait_for_chunks(); });
+    scheduler.push_buffer(make_reads_buffer(1), 0);
+    waiter.join();
+    EXPECT_EQ(scheduler.count_queued_chunks(), (uint64_t) 1);
+}
+
+
+TEST(ReadsChunkScheduler, WaitingThreadClosed_WaitReturns) {
+    ReadsChunkScheduler scheduler(2);
+    std::thread waiter([&] { scheduler.wait_for_chunks(); });
+    scheduler.close();
+    waiter.join();
+    EXPECT_TRUE(scheduler.closed());
+}
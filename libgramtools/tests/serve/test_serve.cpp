@@ -0,0 +1,106 @@
+#include <thread>
+
+#include "gtest/gtest.h"
+
+#include "serve/serve.hpp"
+
+
+using namespace gram;
+
+
+TEST(ParseServeRequest, QuasimapRequest_RunDirectoryAndReadsParsed) {
+    auto job = parse_serve_request("quasimap\t/runs/a\t/reads/1.fq\t/reads/2.fq\n");
+    EXPECT_TRUE(job.valid);
+    EXPECT_FALSE(job.shutdown);
+    EXPECT_EQ(job.run_dirpath, "/runs/a");
+    std::vector<std::string> expected = {"/reads/1.fq", "/reads/2.fq"};
+    EXPECT_EQ(job.reads_fpaths, expected);
+}
+
+
+TEST(ParseServeRequest, ShutdownRequest_ShutdownJob) {
+    auto job = parse_serve_request("shutdown");
+    EXPECT_TRUE(job.valid);
+    EXPECT_TRUE(job.shutdown);
+}
+
+
+TEST(ParseServeRequest, QuasimapRequestWithoutReads_Invalid) {
+    auto job = parse_serve_request("quasimap\t/runs/a");
+    EXPECT_FALSE(job.valid);
+}
+
+
+TEST(ParseServeRequest, EmptyField_Invalid) {
+    auto job = parse_serve_request("quasimap\t\t/reads/1.fq");
+    EXPECT_FALSE(job.valid);
+}
+
+
+TEST(ParseServeRequest, UnknownCommand_Invalid) {
+    auto job = parse_serve_request("build\t/runs/a\t/reads/1.fq");
+    EXPECT_FALSE(job.valid);
+}
+
+
+TEST(ServeJobQueue, JobsPushed_PoppedInOrder) {
+    ServeJobQueue job_queue;
+    job_queue.push(QueuedServeJob{3, {}});
+    job_queue.push(QueuedServeJob{4, {}});
+
+    QueuedServeJob queued_job;
+    EXPECT_TRUE(job_queue.pop(queued_job));
+    EXPECT_EQ(queued_job.client_fd, 3);
+    EXPECT_TRUE(job_queue.pop(queued_job));
+    EXPECT_EQ(queued_job.client_fd, 4);
+}
+
+
+TEST(ServeJobQueue, ClosedWithQueuedJob_JobPoppedBeforeFalse) {
+    ServeJobQueue job_queue;
+    job_queue.push(QueuedServeJob{3, {}});
+    job_queue.close();
+
+    QueuedServeJob queued_job;
+    EXPECT_TRUE(job_queue.pop(queued_job));
+    EXPECT_FALSE(job_queue.pop(queued_job));
+}
+
+
+TEST(ServeJobQueue, WaitingRunnerClosed_PopReturnsFalse) {
+    ServeJobQueue job_queue;
+    bool popped = true;
+    std::thread runner([&] {
+        QueuedServeJob queued_job;
+        popped = job_queue.pop(queued_job);
+    });
+    job_queue.close();
+    runner.join();
+    EXPECT_FALSE(popped);
+}
+
+
+TEST(ServeThreads, LoneJobOnIdleServer_AllThreadsAcquired) {
+    ServeThreads serve_threads(8);
+    EXPECT_EQ(serve_threads.acquire(1), (uint32_t) 8);
+}
+
+
+TEST(ServeThreads, TwoWaitingJobs_FreeThreadsSplit) {
+    ServeThreads serve_threads(8);
+    EXPECT_EQ(serve_threads.acquire(2), (uint32_t) 4);
+    EXPECT_EQ(serve_threads.acquire(1), (uint32_t) 4);
+}
+
+
+TEST(ServeThreads, NoFreeThreads_AcquireWaitsForRelease) {
+    ServeThreads serve_threads(2);
+    auto first_job_threads = serve_threads.acquire(1);
+    uint32_t second_job_threads = 0;
+    std::thread second_job([&] {
+        second_job_threads = serve_threads.acquire(1);
+    });
+    serve_threads.release(first_job_threads);
+    second_job.join();
+    EXPECT_EQ(second_job_threads, (uint32_t) 2);
+}
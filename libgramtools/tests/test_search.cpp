@@ -363,6 +363,45 @@ TEST(Search, GivenBoundaryMarkerAndTwoAlleles_GetAlleleMarkerSaInterval) {
 }
 
 
+TEST(HandleAlleleEncapsulatedStates, SaIntervalAcrossAlleleRuns_SplitByRun) {
+    auto prg_raw = "aa5t6cagtagcagt5ta";
+    auto prg_info = generate_prg_info(prg_raw);
+    SearchStates search_states = {
+            SearchState {
+                    SA_Interval {2, 7}
+            }
+    };
+    auto result = handle_allele_encapsulated_states(search_states, prg_info);
+    SearchStates expected = {
+            SearchState {
+                    SA_Interval {2, 2},
+                    VariantSitePath {},
+                    SearchVariantSiteState::outside_variant_site
+            },
+            SearchState {
+                    SA_Interval {3, 5},
+                    VariantSitePath {
+                            VariantSite {5, 2}
+                    },
+                    SearchVariantSiteState::within_variant_site
+            },
+            SearchState {
+                    SA_Interval {6, 6},
+                    VariantSitePath {},
+                    SearchVariantSiteState::outside_variant_site
+            },
+            SearchState {
+                    SA_Interval {7, 7},
+                    VariantSitePath {
+                            VariantSite {5, 2}
+                    },
+                    SearchVariantSiteState::within_variant_site
+            }
+    };
+    EXPECT_EQ(result, expected);
+}
+
+
 /*
 PRG: gcgct5c6g6t5agtcct
 i	F	BWT	text	SA	suffix
@@ -648,6 +687,110 @@ TEST(Search, KmerAbsentFromKmerIndex_NoSearchStatesReturned) {
 }
 
 
+TEST(Search, KmerSaIntervalWiderThanBudgetNarrowedByRead_ReadMapped) {
+    auto prg_raw = "acgacgacgt";
+    auto prg_info = generate_prg_info(prg_raw);
+
+    // the kmer occurs three times, the read twice
+    auto read = encode_dna_bases("gacg");
+    Pattern kmer = encode_dna_bases("acg");
+    Patterns kmers = {kmer};
+    auto kmer_size = 3;
+    auto kmer_index = index_kmers(kmers, kmer_size, prg_info);
+
+    SearchBudget search_budget = {};
+    search_budget.max_sa_interval_width = 2;
+    SearchBudgetLimit exceeded_limit = SearchBudgetLimit::none;
+    auto search_states = search_read_backwards(read, kmer, kmer_index, prg_info,
+                                               search_budget, exceeded_limit);
+    EXPECT_EQ(search_states.size(), 2);
+    EXPECT_EQ(exceeded_limit, SearchBudgetLimit::none);
+}
+
+
+TEST(Search, FinalSaIntervalWiderThanBudget_ReadAbandoned) {
+    auto prg_raw = "acgacgacgt";
+    auto prg_info = generate_prg_info(prg_raw);
+
+    auto read = encode_dna_bases("acg");
+    Pattern kmer = encode_dna_bases("acg");
+    Patterns kmers = {kmer};
+    auto kmer_size = 3;
+    auto kmer_index = index_kmers(kmers, kmer_size, prg_info);
+
+    SearchBudget search_budget = {};
+    search_budget.max_sa_interval_width = 2;
+    SearchBudgetLimit exceeded_limit = SearchBudgetLimit::none;
+    auto search_states = search_read_backwards(read, kmer, kmer_index, prg_info,
+                                               search_budget, exceeded_limit);
+    EXPECT_EQ(search_states.size(), 0);
+    EXPECT_EQ(exceeded_limit, SearchBudgetLimit::sa_interval_width);
+}
+
+
+TEST(CheckSearchBudget, SaIntervalWiderThanBudget_CheckedOnlyOnceSearched) {
+    SearchStates search_states = {
+            SearchState {SA_Interval {1, 3}},
+    };
+    SearchBudget search_budget = {};
+    search_budget.max_sa_interval_width = 2;
+    uint64_t marker_crossings = 0;
+
+    EXPECT_EQ(check_search_budget(search_states, marker_crossings, search_budget),
+              SearchBudgetLimit::none);
+    EXPECT_EQ(check_final_search_budget(search_states, marker_crossings, search_budget),
+              SearchBudgetLimit::sa_interval_width);
+}
+
+
+TEST(Search, KmerSaIntervalWithinBudget_ReadMapped) {
+    auto prg_raw = "acgacgacgt";
+    auto prg_info = generate_prg_info(prg_raw);
+
+    auto read = encode_dna_bases("gacg");
+    Pattern kmer = encode_dna_bases("acg");
+    Patterns kmers = {kmer};
+    auto kmer_size = 3;
+    auto kmer_index = index_kmers(kmers, kmer_size, prg_info);
+
+    SearchBudget search_budget = {};
+    search_budget.max_sa_interval_width = 3;
+    SearchBudgetLimit exceeded_limit = SearchBudgetLimit::none;
+    auto search_states = search_read_backwards(read, kmer, kmer_index, prg_info,
+                                               search_budget, exceeded_limit);
+    EXPECT_EQ(search_states.size(), 2);
+    EXPECT_EQ(exceeded_limit, SearchBudgetLimit::none);
+}
+
+
+TEST(CheckSearchBudget, MoreSearchStatesThanBudget_SearchStatesLimit) {
+    SearchStates search_states = {
+            SearchState {SA_Interval {1, 1}},
+            SearchState {SA_Interval {3, 3}},
+            SearchState {SA_Interval {5, 5}},
+    };
+    SearchBudget search_budget = {};
+    search_budget.max_search_states = 2;
+    uint64_t marker_crossings = 0;
+
+    auto result = check_search_budget(search_states, marker_crossings, search_budget);
+    EXPECT_EQ(result, SearchBudgetLimit::search_states);
+}
+
+
+TEST(CheckSearchBudget, MoreMarkerCrossingsThanBudget_MarkerCrossingsLimit) {
+    SearchStates search_states = {
+            SearchState {SA_Interval {1, 1}},
+    };
+    SearchBudget search_budget = {};
+    search_budget.max_marker_crossings = 4;
+    uint64_t marker_crossings = 5;
+
+    auto result = check_search_budget(search_states, marker_crossings, search_budget);
+    EXPECT_EQ(result, SearchBudgetLimit::marker_crossings);
+}
+
+
 TEST(Search, GivenRead_CorrectResultSaInterval) {
     auto prg_raw = "gcgct5c6g6t5agtcct";
     auto prg_info = generate_prg_info(prg_raw);
@@ -1248,3 +1391,103 @@ TEST(Search, ReadLeadsToPrgEdge_NoSearchStatesFound) {
     auto search_states = search_read_backwards(read, kmer, kmer_index, prg_info);
     ASSERT_TRUE(search_states.empty());
 }
+
+
+TEST(Search, RepeatedReadWithSeedCache_SameSearchStatesAsWithout) {
+    auto prg_raw = "gcgct5c6g6t5agtcct";
+    auto prg_info = generate_prg_info(prg_raw);
+
+    auto read = encode_dna_bases("cgctgagtcct");
+    Pattern kmer = encode_dna_bases("cct");
+    Patterns kmers = {kmer};
+    auto kmer_size = 3;
+    auto kmer_index = index_kmers(kmers, kmer_size, prg_info);
+    auto expected = search_read_backwards(read, kmer, kmer_index, prg_info);
+
+    SearchBudget search_budget = {};
+    ExtendedSeedCache seed_cache(64);
+    for (uint64_t i = 0; i < 100; ++i) {
+        SearchBudgetLimit exceeded_limit = SearchBudgetLimit::none;
+        auto result = search_read_backwards(read, kmer, kmer_index, prg_info,
+                                            search_budget, seed_cache, exceeded_limit);
+        EXPECT_EQ(result, expected);
+    }
+    EXPECT_EQ(seed_cache.count_seeds(), 2);
+}
+
+
+TEST(Search, ReadsSharingSuffixSearchedThroughStack_SameSearchStatesAsAlone) {
+    auto prg_raw = "gcgct5c6g6t5agtcct";
+    auto prg_info = generate_prg_info(prg_raw);
+
+    Pattern kmer = encode_dna_bases("cct");
+    Patterns kmers = {kmer};
+    auto kmer_size = 3;
+    auto kmer_index = index_kmers(kmers, kmer_size, prg_info);
+
+    std::vector<Pattern> reads = {
+            encode_dna_bases("agtcct"),
+            encode_dna_bases("cgctgagtcct"),
+            encode_dna_bases("cgctgagtcct"),
+            encode_dna_bases("cgcttagtcct"),
+            encode_dna_bases("aagtcct"),
+    };
+    // bases shared with the previous read's suffix
+    std::vector<uint64_t> counts_shared_bases = {0, 6, 11, 6, 6};
+    SearchBudget search_budget = {};
+    SuffixSearchStack search_stack;
+    for (uint64_t i = 0; i < reads.size(); ++i) {
+        SearchBudgetLimit exceeded_limit = SearchBudgetLimit::none;
+        auto result = search_shared_suffix_backwards(reads[i], counts_shared_bases[i], kmer_size, kmer_index,
+                                                     prg_info, search_budget, search_stack, exceeded_limit);
+        auto expected = search_read_backwards(reads[i], kmer, kmer_index, prg_info);
+        EXPECT_EQ(result, expected);
+    }
+}
+
+
+TEST(Search, ReadWithinNonVariantRegion_SearchedWithoutReachingSite) {
+    auto prg_raw = "gcgct5c6g6t5agtcct";
+    auto prg_info = generate_prg_info(prg_raw);
+    auto kmer_size = 3;
+    prg_info.invariant_reach = generate_invariant_reach(prg_info.fm_index, prg_info.encoded_prg,
+                                                        prg_info.sites_mask, kmer_size);
+    prg_info.invariant_reach_rmq = InvariantReachRMQ(&prg_info.invariant_reach.sa_reach);
+
+    Pattern kmer = encode_dna_bases("cct");
+    Patterns kmers = {kmer};
+    auto kmer_index = index_kmers(kmers, kmer_size, prg_info);
+
+    auto read = encode_dna_bases("agtcct");
+    EXPECT_TRUE(read_reaches_no_site(read, kmer, kmer_index, prg_info));
+
+    SearchBudgetLimit exceeded_limit = SearchBudgetLimit::none;
+    auto result = search_invariant_read_backwards(read, kmer, kmer_index, prg_info, SearchBudget{}, exceeded_limit);
+    auto expected = search_read_backwards(read, kmer, kmer_index, prg_info);
+    ASSERT_EQ(result.size(), (uint64_t) 1);
+    ASSERT_EQ(expected.size(), (uint64_t) 1);
+    EXPECT_EQ(result.front().sa_interval, expected.front().sa_interval);
+    EXPECT_TRUE(result.front().variant_site_path.empty());
+
+    auto unmapped_read = encode_dna_bases("ggtcct");
+    EXPECT_TRUE(read_reaches_no_site(unmapped_read, kmer, kmer_index, prg_info));
+    result = search_invariant_read_backwards(unmapped_read, kmer, kmer_index, prg_info, SearchBudget{}, exceeded_limit);
+    EXPECT_TRUE(result.empty());
+}
+
+
+TEST(Search, ReadLongEnoughToReachSite_NotSearchedAsNonVariant) {
+    auto prg_raw = "gcgct5c6g6t5agtcct";
+    auto prg_info = generate_prg_info(prg_raw);
+    auto kmer_size = 3;
+    prg_info.invariant_reach = generate_invariant_reach(prg_info.fm_index, prg_info.encoded_prg,
+                                                        prg_info.sites_mask, kmer_size);
+    prg_info.invariant_reach_rmq = InvariantReachRMQ(&prg_info.invariant_reach.sa_reach);
+
+    Pattern kmer = encode_dna_bases("cct");
+    Patterns kmers = {kmer};
+    auto kmer_index = index_kmers(kmers, kmer_size, prg_info);
+
+    auto read = encode_dna_bases("tagtcct");
+    EXPECT_FALSE(read_reaches_no_site(read, kmer, kmer_index, prg_info));
+}
@@ -2,6 +2,7 @@
 
 #include "common/utils.hpp"
 #include "prg/masks.hpp"
+#include "prg/strand_symmetric.hpp"
 #include "kmer_index/build.hpp"
 #include "test_utils.hpp"
 
@@ -9,30 +10,43 @@
 using namespace gram;
 
 
-PRG_Info generate_prg_info(const std::string &prg_raw) {
+PRG_Info generate_prg_info(const sdsl::int_vector<> &encoded_prg,
+                           const uint64_t &strand_count_sites) {
     Parameters parameters = {};
     parameters.encoded_prg_fpath = "@encoded_prg_file_name";
     parameters.fm_index_fpath = "@fm_index";
     parameters.gram_dirpath = "@gram_dir";
 
-    auto encoded_prg = encode_prg(prg_raw);
     sdsl::store_to_file(encoded_prg, parameters.encoded_prg_fpath);
 
     PRG_Info prg_info;
+    prg_info.strand_count_sites = strand_count_sites;
     prg_info.fm_index = generate_fm_index(parameters);
     prg_info.encoded_prg = encoded_prg;
     prg_info.sites_mask = generate_sites_mask(encoded_prg);
     prg_info.allele_mask = generate_allele_mask(encoded_prg);
+    prg_info.site_table = generate_site_table(encoded_prg, prg_info.fm_index);
+
+    prg_info.sa_allele_runs = generate_sa_allele_runs(prg_info.fm_index,
+                                                      prg_info.sites_mask,
+                                                      prg_info.allele_mask);
+    prg_info.sa_allele_runs_rank = sdsl::rank_support_v<1>(&prg_info.sa_allele_runs.run_starts_mask);
+    prg_info.sa_allele_runs_select = sdsl::select_support_mcl<1>(&prg_info.sa_allele_runs.run_starts_mask);
+
+    prg_info.kmer_presence = generate_kmer_presence(encoded_prg, presence_kmer_size);
 
-    prg_info.prg_markers_mask = generate_prg_markers_mask(encoded_prg);
+    prg_info.prg_markers_mask = generate_prg_markers_mask(encoded_prg,
+                                                          strand_separator(strand_count_sites));
     prg_info.prg_markers_rank = sdsl::rank_support_v<1>(&prg_info.prg_markers_mask);
     prg_info.prg_markers_select = sdsl::select_support_mcl<1>(&prg_info.prg_markers_mask);
 
-    prg_info.bwt_markers_mask = generate_bwt_markers_mask(prg_info.fm_index);
+    prg_info.bwt_markers_mask = generate_bwt_markers_mask(prg_info.fm_index,
+                                                          strand_separator(strand_count_sites));
     prg_info.bwt_markers_rank = sdsl::rank_support_v<1>(&prg_info.bwt_markers_mask);
     prg_info.bwt_markers_select = sdsl::select_support_mcl<1>(&prg_info.bwt_markers_mask);
     prg_info.markers_mask_count_set_bits =
             prg_info.bwt_markers_rank(prg_info.bwt_markers_mask.size());
+    prg_info.bwt_markers = generate_bwt_markers(prg_info.fm_index, prg_info.bwt_markers_mask);
 
     generate_dna_bwt_masks(prg_info.fm_index, parameters);
     prg_info.dna_bwt_masks = load_dna_bwt_masks(prg_info.fm_index,
@@ -47,6 +61,19 @@ PRG_Info generate_prg_info(const std::string &prg_raw) {
 }
 
 
+PRG_Info generate_prg_info(const std::string &prg_raw) {
+    auto encoded_prg = encode_prg(prg_raw);
+    return generate_prg_info(encoded_prg, 0);
+}
+
+
+PRG_Info generate_strand_symmetric_prg_info(const std::string &prg_raw) {
+    auto encoded_prg = encode_prg(prg_raw);
+    auto strand_count_sites = count_variant_sites(encoded_prg);
+    return generate_prg_info(generate_strand_symmetric_prg(encoded_prg), strand_count_sites);
+}
+
+
 TEST(ReverseComplimentRead, GivenRead_ReverseComplimnetReadReturned) {
     Pattern read = {1, 2, 1, 3, 4};
     auto result = reverse_compliment_read(read);
@@ -6,4 +6,7 @@
 
 gram::PRG_Info generate_prg_info(const std::string &prg_raw);
 
+// the PRG indexed with its reverse complement, as built with --strand-symmetric
+gram::PRG_Info generate_strand_symmetric_prg_info(const std::string &prg_raw);
+
 #endif //GRAMTOOLS_TEST_UTILS_HPP